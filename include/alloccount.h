@@ -0,0 +1,9 @@
+#pragma once
+
+// Counts global operator new calls in builds compiled with TRON_ALLOC_COUNT
+// (make alloccheck). Other builds report the counter as unavailable.
+namespace AllocationCounter
+{
+  bool isEnabled();
+  long count();
+}
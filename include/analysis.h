@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "replay.h"
+#include "grid.h"
+#include "player.h"
+#include "config.h"
+
+// The board right after one tick of a re-simulated round.
+struct TickView
+{
+  // Ticks played so far, this one included.
+  long tick;
+  int riders;
+  const Player *const *players;
+  const bool *alive;
+  const Grid *grid;
+};
+
+struct RoundOutcome
+{
+  long ticks;
+  int winner;
+  // Whether the round ended on the recorded tick with the recorded winner.
+  bool matches;
+};
+
+// Builds one aggregate over the rounds of an archive. Every analysis thread feeds its own
+// clone and the clones are merged once the archive is done, so visitors never lock and
+// their totals do not depend on the thread count.
+class ReplayVisitor
+{
+public:
+  virtual ~ReplayVisitor() {}
+
+  virtual const char *name() const = 0;
+  virtual std::unique_ptr<ReplayVisitor> clone() const = 0;
+  // Only visitors that say so are called on every tick.
+  virtual bool wantsTicks() const { return false; }
+
+  virtual void beginRound(const ReplayRound &) {}
+  virtual void tick(const ReplayRound &, const TickView &) {}
+  virtual void endRound(const ReplayRound &round, const RoundOutcome &outcome) = 0;
+  // other is always a clone of this visitor.
+  virtual void merge(const ReplayVisitor &other) = 0;
+  virtual bool writeCsv(FILE *out) const = 0;
+};
+
+struct AnalysisReport
+{
+  long rounds = 0;
+  long ticks = 0;
+  // Rounds that re-simulated to a different end than recorded.
+  long mismatched = 0;
+  // Rounds of more riders than the analysis replays.
+  long skipped = 0;
+  double seconds = 0;
+};
+
+// Streams an archive through a fixed ring of round slots: one thread reads rounds into
+// free slots and the workers re-simulate them, so memory stays at a few rounds per
+// thread whatever the archive size.
+class ReplayAnalyzer
+{
+private:
+  int threadCount;
+  std::vector<std::unique_ptr<ReplayVisitor>> visitors;
+  AnalysisReport report;
+
+public:
+  explicit ReplayAnalyzer(int threads = 0);
+
+  void add(std::unique_ptr<ReplayVisitor> visitor) { visitors.push_back(std::move(visitor)); }
+  // False when the archive cannot be opened or holds a torn or corrupt round; after a
+  // damaged round the report still covers the intact rounds before it.
+  bool run(const std::string &path, std::string &error);
+
+  int getThreadCount() const { return threadCount; }
+  int getSlotCount() const { return threadCount * Config::ANALYSIS_SLOTS_PER_THREAD; }
+  const AnalysisReport &getReport() const { return report; }
+  const std::vector<std::unique_ptr<ReplayVisitor>> &getVisitors() const { return visitors; }
+
+  // The built-in visitors: outcomes, length, spawns and tempo.
+  static std::unique_ptr<ReplayVisitor> makeVisitor(const std::string &name);
+  static const char *const VISITOR_NAMES[];
+  static const int VISITOR_COUNT;
+};
+
+int runAnalysis(int argc, char **argv);
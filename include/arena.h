@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "player.h"
+#include "bot.h"
+#include "types.h"
+
+// Owns the Players and Bots of a match. Slots are built once and sized for the arena,
+// so handing them out again after reset() costs no allocation: reset only rewinds the
+// slot counters and bumps the generation.
+class MatchArena
+{
+private:
+  std::vector<Player> players;
+  std::vector<Bot> bots;
+  int playersInUse, botsInUse;
+  uint32_t generation;
+  int width, height;
+
+public:
+  MatchArena(int playerSlots, int botSlots);
+
+  void reserve(int w, int h);
+  void reset();
+
+  Player *acquirePlayer(int x, int y, Direction dir);
+  Bot *acquireBot(int x, int y, Direction dir);
+
+  uint32_t getGeneration() const { return generation; }
+  int getPlayersInUse() const { return playersInUse; }
+  int getBotsInUse() const { return botsInUse; }
+};
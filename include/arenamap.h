@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "config.h"
+
+struct MapSpawn
+{
+  int x, y;
+  Direction dir;
+};
+
+// Walls and spawn points of an arena. Text maps have one character per cell: '#' for
+// a wall, '.' or ' ' for open floor and '^', 'v', '<' or '>' for a spawn facing that
+// way; lines starting with ';' are comments. The outer ring is always wall. The packed
+// form keeps the walls as one bit per cell and is what load() reads fastest.
+class ArenaMap
+{
+private:
+  int width, height;
+  std::vector<uint64_t> walls;
+  std::vector<MapSpawn> spawns;
+  int interiorWalls;
+
+  bool parseText(const std::string &text, std::string &error);
+  bool unpack(const std::string &data, std::string &error);
+  bool checkSpawns(std::string &error) const;
+
+public:
+  ArenaMap();
+
+  void reset(int w, int h);
+  void setWall(int x, int y);
+  void addSpawn(int x, int y, Direction dir);
+
+  bool isWall(int x, int y) const
+  {
+    if (x <= 0 || y <= 0 || x >= width - 1 || y >= height - 1)
+      return true;
+    size_t bit = static_cast<size_t>(y) * width + x;
+    return (walls[bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  bool empty() const { return width == 0; }
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  int getInteriorWalls() const { return interiorWalls; }
+  const std::vector<MapSpawn> &getSpawns() const { return spawns; }
+
+  bool load(const std::string &path, std::string &error);
+  bool save(const std::string &path) const;
+  std::string toText() const;
+};
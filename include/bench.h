@@ -0,0 +1,5 @@
+#pragma once
+
+#include <string>
+
+int runBenchmark(const std::string &name);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include "player.h"
+#include "types.h"
+#include "config.h"
+
+class OpeningBook
+{
+private:
+  std::once_flag loadOnce;
+  const uint64_t *slots;
+  uint64_t capacity;
+  void *mapping;
+  size_t mappingSize;
+
+  OpeningBook();
+  void load();
+
+public:
+  ~OpeningBook();
+  OpeningBook(const OpeningBook &) = delete;
+  OpeningBook &operator=(const OpeningBook &) = delete;
+
+  static OpeningBook &instance();
+
+  bool isAvailable();
+  bool lookup(const Player &self, const Player &opponent, int width, int height, Direction &move);
+
+  static uint64_t positionKey(const Player &self, const Player &opponent, int width, int height, int symmetry);
+  static int canonicalSymmetry(const Player &self, const Player &opponent, int width, int height, uint64_t &key);
+  static Direction transform(Direction dir, int symmetry);
+
+  static bool generate(const std::string &path, const std::vector<std::pair<int, int>> &sizes,
+                       int plies = Config::OPENING_BOOK_MAX_PLY, int depth = Config::OPENING_BOOK_SEARCH_DEPTH);
+};
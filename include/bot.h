@@ -3,23 +3,71 @@
 #include "player.h"
 #include "types.h"
 #include "config.h"
+#include "rng.h"
+#include "evaluator.h"
+#include "endgame.h"
+#include "searchpool.h"
+#include <memory>
 #include <vector>
+#include <chrono>
+
+struct BotBudget
+{
+  long maxNodes;
+  long maxMicros;
+  int noise;
+  // Stage switches for benches that pit a stage against the pipeline without it; the
+  // difficulty levels leave both on and differ only in the numbers above.
+  bool endgame = true;
+  bool search = true;
+};
 
 class Bot
 {
 private:
-  Player *botPlayer;
+  Player botPlayer;
+  BotDifficulty difficulty;
+  BotBudget budget;
+  BotWeights weights;
+  Rng rng;
+
+  BotEvaluator evaluator;
+  CandidateBatch candidates;
+  EndgameSolver endgame;
+  // Built on the first deep-search move, so budgets too small to search never pay for the table.
+  std::unique_ptr<SearchPool> deepSearch;
+  int searchThreads;
+  long nodesUsed;
+  const ArenaMap *map;
 
   Direction calculateBestMove(const Player &opponent, int width, int height);
-  int evaluateMove(Direction dir, const Player &opponent, int width, int height);
-  bool isPositionSafe(int x, int y, const Player &opponent, int width, int height);
-  int floodFill(int startX, int startY, const Player &opponent, int width, int height);
 
 public:
-  Bot(int startX, int startY, Direction startDirection = RIGHT);
-  ~Bot();
+  Bot(int startX, int startY, Direction startDirection = RIGHT, int playerId = Config::PLAYER_2_ID);
 
   void update(const Player &opponent, int width, int height);
-  Player *getPlayer() const;
-  void reset(int newX, int newY);
+  int evaluateMove(Direction dir, const Player &opponent, int width, int height);
+  Player *getPlayer() { return &botPlayer; }
+  const Player *getPlayer() const { return &botPlayer; }
+  void respawn(int x, int y, Direction dir);
+  void reserve(int width, int height);
+  void setMap(const ArenaMap *newMap);
+  void setNetwork(const NnueNetwork *network) { evaluator.setNetwork(network); }
+
+  void setDifficulty(BotDifficulty level);
+  BotDifficulty getDifficulty() const { return difficulty; }
+  const BotBudget &getBudget() const { return budget; }
+  void setBudget(const BotBudget &newBudget) { budget = newBudget; }
+  const BotWeights &getWeights() const { return weights; }
+  void setWeights(const BotWeights &newWeights) { weights = newWeights; }
+  void seedNoise(uint64_t seed) { rng.seed(seed); }
+  uint64_t getNoiseState() const { return rng.getState(); }
+  void setSearchThreads(int threads);
+  int getSearchThreads() const { return searchThreads; }
+  const SearchPool *getSearchPool() const { return deepSearch.get(); }
+  long getNodesUsed() const { return nodesUsed; }
+
+  static BotBudget budgetFor(BotDifficulty level);
+  static const char *difficultyName(BotDifficulty level);
+  static bool difficultyFromName(const char *name, BotDifficulty &level);
 };
\ No newline at end of file
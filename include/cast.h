@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include "replay.h"
+
+struct CastReport
+{
+  long ticks = 0;
+  long frames = 0;
+  long castBytes = 0;
+  long gifBytes = 0;
+  int winner = Config::WINNER_TIE;
+  // Whether re-simulating the moves ended the round on the recorded tick with the recorded winner.
+  bool matches = false;
+};
+
+// Plays a recorded round through the tick engine and the frame renderers with no terminal
+// and no sleeping. Each tick becomes one asciicast v2 event stamped with the round's own
+// tick time, plus one GIF frame when gifPath is set; both files are written as the
+// round plays rather than at the end.
+bool exportCast(const ReplayRound &round, const std::string &castPath, const std::string &gifPath, CastReport &report,
+                std::string &error);
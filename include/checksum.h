@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, the checksum on every record the game appends or saves, so a torn write never
+// parses. Pass the previous result as hash to continue over several buffers.
+const uint32_t CHECKSUM_SEED = 2166136261u;
+
+inline uint32_t hashBytes(const void *data, size_t size, uint32_t hash = CHECKSUM_SEED)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
@@ -24,6 +24,7 @@ namespace Config
   const int COLOR_MENU_TITLE = 14;
 
   const int MENU_BOX_HALF_WIDTH = 12;
+  const int STATS_BOX_HALF_WIDTH = 20;
   const int MENU_BOX_LARGE_HALF_WIDTH = 15;
 
   const int HUD_HORIZONTAL_OFFSET = 3;
@@ -44,5 +45,154 @@ namespace Config
   const int WINNER_PLAYER1 = 1;
   const int WINNER_PLAYER2 = 2;
 
+  const int MATCH_PLAYER_SLOTS = 2;
+  const int MATCH_BOT_SLOTS = 2;
+
   const int DEFAULT_BOT_DIFFICULTY = 1;
+  const int NUM_BOT_DIFFICULTIES = 4;
+
+  const long BOT_EASY_NODES = 40;
+  const long BOT_EASY_MICROS = 200;
+  const int BOT_EASY_NOISE = 400;
+  const long BOT_NORMAL_NODES = 400;
+  const long BOT_NORMAL_MICROS = 2000;
+  const int BOT_NORMAL_NOISE = 0;
+  const long BOT_HARD_NODES = 4000;
+  const long BOT_HARD_MICROS = 10000;
+  const int BOT_HARD_NOISE = 0;
+  const long BOT_INSANE_NODES = 40000;
+  const long BOT_INSANE_MICROS = 30000;
+  const int BOT_INSANE_NOISE = 0;
+  // Every level runs the same stages; a node budget this large can afford the deep
+  // search, smaller ones go straight to the one-ply evaluation.
+  const long BOT_SEARCH_MIN_NODES = 20000;
+  const int BOT_DEADLINE_CHECK_INTERVAL = 32;
+
+  const int WEIGHT_SPACE = 50;
+  const int WEIGHT_WALL_DISTANCE = 15;
+  const int WEIGHT_KEEP_STRAIGHT = 100;
+  const int WEIGHT_KEEP_NEAR = 30;
+  const int WEIGHT_LOOK_AHEAD = 8;
+  const int WEIGHT_EXITS = 20;
+  const int WEIGHT_OPPONENT_DISTANCE = 10;
+  // Off until a trained network beats the heuristic alone (see --bench nnue).
+  const int WEIGHT_NETWORK = 0;
+
+  // Learned evaluation: a patch of cells around each head, centred on the head's
+  // anchor block so the first layer only refreshes when the head leaves its block.
+  const int NNUE_PATCH_RADIUS = 7;
+  const int NNUE_PATCH = 2 * NNUE_PATCH_RADIUS + 1;
+  const int NNUE_PATCH_CELLS = NNUE_PATCH * NNUE_PATCH;
+  const int NNUE_ANCHOR_STEP = 4;
+  const int NNUE_FEATURES = 2 * NNUE_PATCH_CELLS + NNUE_ANCHOR_STEP * NNUE_ANCHOR_STEP;
+  const int NNUE_HIDDEN = 32;
+  const int NNUE_LAYER2 = 32;
+  const int NNUE_LABEL_CELLS = 100;
+  const double NNUE_LABEL_LIMIT = 8.0;
+  const int NNUE_TRAIN_WIDTH = 80;
+  const int NNUE_TRAIN_HEIGHT = 24;
+  const int NNUE_TRAIN_GAMES = 300;
+  const int NNUE_TRAIN_EPOCHS = 8;
+  const int NNUE_SAMPLE_ODDS = 3;
+
+  const int TUNER_DEFAULT_WIDTH = 40;
+  const int TUNER_DEFAULT_HEIGHT = 24;
+  const int TUNER_DEFAULT_GAMES = 100000;
+  const int TUNER_DEFAULT_GAMES_PER_ITERATION = 64;
+  const int TUNER_DEFAULT_GAMES_PER_BATCH = 4;
+  const int TUNER_DEFAULT_CHECKPOINT_EVERY = 10;
+
+  const int HOST_DEFAULT_MATCHES = 1000;
+  const int HOST_DEFAULT_WIDTH = 80;
+  const int HOST_DEFAULT_HEIGHT = 24;
+  const double HOST_DEFAULT_SECONDS = 10.0;
+  const int HOST_WHEEL_SLOTS = 256;
+  const long HOST_WHEEL_RESOLUTION_MICROS = 1000;
+  const int HOST_LATENCY_BUCKETS = 32;
+  const int HOST_REPORT_SLOWEST = 5;
+
+  const unsigned char CELL_EMPTY = 0;
+  const unsigned char CELL_WALL = 1;
+  const unsigned char CELL_SELF = 2;
+  const unsigned char CELL_OPPONENT = 3;
+
+  const int SEARCH_WIN_SCORE = 1000000;
+  // Deep search (budgets from BOT_SEARCH_MIN_NODES): iterative deepening on every thread, one shared table.
+  const int SEARCH_MAX_DEPTH = 64;
+  const int SEARCH_TABLE_ENTRIES = 1 << 18;
+  const int SEARCH_CHECK_INTERVAL = 64;
+  const int SEARCH_MAX_THREADS = 64;
+  // What the menu and --threads start from; 0 uses every core.
+  const int DEFAULT_SEARCH_THREADS = 0;
+  // Bots and games built in code search on one thread, which is also deterministic,
+  // until told otherwise.
+  const int BOT_SEARCH_THREADS = 1;
+  const int ENDGAME_TABLE_SIZE = 4096;
+
+  const char *const OPENING_BOOK_PATH = "tron.book";
+  const char *const OPENING_BOOK_ENV = "TRON_BOOK";
+  const int OPENING_BOOK_MAX_PLY = 8;
+  const int OPENING_BOOK_SEARCH_DEPTH = 3;
+  const int OPENING_BOOK_DEFAULT_WIDTH = 80;
+  const int OPENING_BOOK_DEFAULT_HEIGHT = 24;
+
+  const int MAP_MIN_SIZE = 8;
+  const int MAP_MAX_SIZE = 1024;
+
+  // Fading trails keep this many cells per rider; 0 keeps the whole trail.
+  const int TRAIL_LENGTH_FULL = 0;
+  const int TRAIL_LENGTH_SHORT = 40;
+  const int TRAIL_LENGTH_LONG = 120;
+  const int TRAIL_MIN_LENGTH = 4;
+
+  // Bot battles tick at the game speed times one of these; 0 ticks as fast as the bots
+  // can move. Frames are sampled on their own clock.
+  const int BATTLE_SPEEDS[] = {1, 10, 100, 0};
+  const int NUM_BATTLE_SPEEDS = 4;
+  const int BATTLE_FRAME_MICROS = 33333;
+
+  // Render pacing levels, from drawing every tick in Unicode up to every eighth tick in
+  // ASCII. A level is too costly once frames spend more than the busy share of their
+  // ticks blocked in output or the terminal holds more than the queue limit unsent.
+  const int PACER_TICKS_PER_FRAME[] = {1, 2, 4, 4, 8};
+  const bool PACER_ASCII[] = {false, false, false, true, true};
+  const int NUM_PACER_LEVELS = 5;
+  const double PACER_BUSY_SHARE = 0.5;
+  const double PACER_CALM_SHARE = 0.1;
+  const double PACER_AVERAGE_WEIGHT = 0.25;
+  const long PACER_QUEUE_BYTES = 4096;
+  const int PACER_SETTLE_FRAMES = 3;
+  const int PACER_CALM_FRAMES = 20;
+  // Ticks that fall this far behind are dropped instead of run back to back.
+  const int PACER_CATCH_UP_TICKS = 10;
+
+  // Modes kept in the stats log; bot battles have no player to score.
+  const int NUM_GAME_MODES = 3;
+  const char *const STATS_FILE = ".tron.stats";
+  const char *const STATS_ENV = "TRON_STATS";
+  const int STATS_RECENT_MATCHES = 5;
+  const long STATS_COMPACT_RECORDS = 1024;
+
+  // Replay moves pack two bits per rider into one byte per tick.
+  const int REPLAY_MAX_PLAYERS = 4;
+
+  // Replay export: GIF pixels per cell (terminal cells are about twice as tall as wide)
+  // and how long the final frame stays up.
+  const int GIF_CELL_WIDTH = 4;
+  const int GIF_CELL_HEIGHT = 8;
+  const int CAST_END_HOLD_MICROS = 2000000;
+
+  // Paused matches are saved here unless TRON_SNAPSHOT or --snapshot names another file.
+  const char *const SNAPSHOT_FILE = ".tron.snapshot";
+  const char *const SNAPSHOT_ENV = "TRON_SNAPSHOT";
+
+  // Replay analysis: round slots in flight per thread, and the tick buckets rounds are
+  // grouped in (the last one takes every longer round).
+  const int ANALYSIS_SLOTS_PER_THREAD = 4;
+  const long ANALYSIS_TICK_BUCKET = 50;
+  const int ANALYSIS_TICK_BUCKETS = 40;
+
+  // --profile: tick stages and the hardware counters read at every stage switch.
+  const int NUM_PROFILE_STAGES = 4;
+  const int NUM_PROFILE_COUNTERS = 4;
 }
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include "grid.h"
+#include "regions.h"
+#include "types.h"
+#include "config.h"
+
+// Longest-path search for a rider sealed off in its own region. Depth-first with
+// moves into the bigger side of a choke first and the fewest onward exits next,
+// cut off by a checkerboard parity bound on the reachable cells, and memoised on
+// the set of cells the search has filled. Stops at a node or time budget and
+// then plays the longest path found so far. A path proved longest is kept and
+// followed on later ticks without searching again.
+class EndgameSolver
+{
+private:
+  struct Entry
+  {
+    uint64_t key = 0;
+    uint32_t generation = 0;
+    int length = 0;
+    int move = -1;
+  };
+
+  struct Reach
+  {
+    int counts[2];
+    int bound;
+    bool connected;
+  };
+
+  struct Child
+  {
+    int cell;
+    int degree;
+    Direction dir;
+    Reach reach;
+  };
+
+  int width, height;
+  std::vector<uint8_t> board;
+  std::vector<uint8_t> shade;
+  std::vector<uint64_t> cellKeys, headKeys;
+  std::vector<Entry> table;
+  uint32_t generation;
+  uint64_t hash;
+  std::vector<uint32_t> seen;
+  uint32_t seenStamp;
+  std::vector<int> queue;
+  long nodes, maxNodes;
+  bool stopped;
+  int bestLength;
+  std::vector<int> plan;
+  size_t planNext;
+  int planFrom;
+  std::chrono::steady_clock::time_point deadline;
+
+  int offset(Direction dir) const;
+  bool isChoke(int cell) const;
+  int parityBound(const int counts[2], int from) const;
+  Reach reachAround(int cell);
+  Reach rootReach(int head, const RegionMap &regions);
+  int expand(int head, const Reach &reach, Child children[4]);
+  int longest(int head, const Reach &reach, int alpha);
+  void recordPlan(int head, int first);
+  bool followPlan(int head, Direction &dir);
+
+public:
+  EndgameSolver();
+
+  void reserve(int w, int h);
+  Direction bestMove(const Grid &grid, const RegionMap &regions, int selfX, int selfY, Direction selfDir, long nodeBudget,
+                     std::chrono::steady_clock::time_point until);
+  long getNodes() const { return nodes; }
+  int getLength() const { return bestLength; }
+  bool isExact() const { return !stopped; }
+};
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "player.h"
+#include "bot.h"
+#include "grid.h"
+#include "arenamap.h"
+#include "profiler.h"
+#include "types.h"
+#include "config.h"
+
+enum KeySet
+{
+  KEYS_ARROWS,
+  KEYS_WASD
+};
+
+struct TickResult
+{
+  bool finished;
+  int winner;
+};
+
+// Controllers steer one player each. The engine calls them through their concrete
+// type, so a controller only has to provide these members:
+//   Player *player() const;
+//   bool handleKey(int ch);
+//   void think(const Grid &occupied);
+//   void respawn(int x, int y, Direction dir);
+class HumanController
+{
+private:
+  Player *rider;
+  KeySet keys;
+
+public:
+  HumanController(Player &player, KeySet keySet) : rider(&player), keys(keySet) {}
+
+  Player *player() const { return rider; }
+  bool handleKey(int ch);
+  void think(const Grid &) {}
+  void respawn(int x, int y, Direction dir);
+};
+
+class BotController
+{
+private:
+  Bot *bot;
+  const Player *opponent;
+  int width, height;
+
+public:
+  BotController(Bot &bot, const Player &opponent, int w, int h) : bot(&bot), opponent(&opponent), width(w), height(h) {}
+
+  Player *player() const { return bot->getPlayer(); }
+  Bot *getBot() const { return bot; }
+  bool handleKey(int) { return false; }
+  void think(const Grid &)
+  {
+    TickProfiler::Scope scope(STAGE_BOT);
+    bot->update(*opponent, width, height);
+  }
+  void respawn(int x, int y, Direction dir);
+};
+
+// Shared occupancy and outcome rules. Every trail cell, heads included, blocks;
+// two riders entering the same cell both crash. A cell left by a fading trail is
+// free from the next tick on.
+class TickCore
+{
+protected:
+  Grid occupied;
+  int width, height;
+  long ticks;
+
+  TickCore(int w, int h) : occupied(w, h), width(w), height(h), ticks(0) {}
+
+  void occupy(const Player &player);
+
+  // Moves a rider into its (free) next cell; a fading trail frees its tail cell at once.
+  void advance(Player &player, int x, int y)
+  {
+    player.move();
+    occupied.set(x, y, Config::CELL_WALL);
+    if (player.retiredTail())
+      occupied.set(player.getTrail().getRetiredX(), player.getTrail().getRetiredY(), Config::CELL_EMPTY);
+  }
+  static TickResult outcome(int playerCount, int aliveCount, int survivorId);
+
+public:
+  void setObstacles(const ArenaMap &map) { occupied.setObstacles(map); }
+  // Puts back a saved board mid-round; the riders' trails must already match it.
+  void restore(const uint8_t *cells, long tickCount)
+  {
+    occupied.assign(cells);
+    ticks = tickCount;
+  }
+  const Grid &getGrid() const { return occupied; }
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  long getTicks() const { return ticks; }
+};
+
+// Fixed roster: the player count and every controller type are known at compile
+// time, so the collision loops unroll and controllers are called directly.
+template <typename... Controllers>
+class TickEngine : public TickCore
+{
+public:
+  static constexpr int PLAYER_COUNT = sizeof...(Controllers);
+
+private:
+  std::tuple<Controllers...> controllers;
+  std::array<Player *, PLAYER_COUNT> players;
+  std::array<bool, PLAYER_COUNT> alive;
+
+  template <size_t... I>
+  void bind(std::index_sequence<I...>)
+  {
+    players = {{std::get<I>(controllers).player()...}};
+  }
+
+  template <size_t... I>
+  bool dispatchKey(int ch, std::index_sequence<I...>)
+  {
+    return (std::get<I>(controllers).handleKey(ch) || ...);
+  }
+
+  template <size_t... I>
+  void thinkAll(std::index_sequence<I...>)
+  {
+    ((alive[I] ? std::get<I>(controllers).think(occupied) : void()), ...);
+  }
+
+  template <size_t I>
+  void respawnOne(const std::pair<int, int> *spawns, const Direction *dirs)
+  {
+    std::get<I>(controllers).respawn(spawns[I].first, spawns[I].second, dirs[I]);
+  }
+
+  template <size_t... I>
+  void respawnAll(const std::pair<int, int> *spawns, const Direction *dirs, std::index_sequence<I...>)
+  {
+    (respawnOne<I>(spawns, dirs), ...);
+  }
+
+  template <typename Visitor, size_t... I>
+  void visitAll(Visitor &visit, std::index_sequence<I...>)
+  {
+    (visit(static_cast<int>(I), std::get<I>(controllers)), ...);
+  }
+
+public:
+  TickEngine(int w, int h, Controllers... list) : TickCore(w, h), controllers(list...)
+  {
+    bind(std::index_sequence_for<Controllers...>{});
+    reset();
+  }
+
+  void reset()
+  {
+    occupied.clear();
+    ticks = 0;
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+      alive[i] = true;
+      occupy(*players[i]);
+    }
+  }
+
+  void respawn(const std::pair<int, int> *spawns, const Direction *dirs)
+  {
+    respawnAll(spawns, dirs, std::index_sequence_for<Controllers...>{});
+    reset();
+  }
+
+  bool handleKey(int ch) { return dispatchKey(ch, std::index_sequence_for<Controllers...>{}); }
+
+  // Calls visit(index, controller) for every controller with its concrete type.
+  template <typename Visitor>
+  void visitControllers(Visitor &&visit) { visitAll(visit, std::index_sequence_for<Controllers...>{}); }
+
+  TickResult tick()
+  {
+    thinkAll(std::index_sequence_for<Controllers...>{});
+
+    std::array<int, PLAYER_COUNT> nextX, nextY;
+    std::array<bool, PLAYER_COUNT> crashed;
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+      nextX[i] = players[i]->getNextX();
+      nextY[i] = players[i]->getNextY();
+      crashed[i] = alive[i] && !occupied.isFree(nextX[i], nextY[i]);
+    }
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+      for (int j = i + 1; j < PLAYER_COUNT; j++)
+      {
+        if (alive[i] && alive[j] && nextX[i] == nextX[j] && nextY[i] == nextY[j])
+          crashed[i] = crashed[j] = true;
+      }
+    }
+
+    int aliveCount = 0;
+    int survivorId = Config::WINNER_TIE;
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+      alive[i] = alive[i] && !crashed[i];
+      if (alive[i])
+      {
+        aliveCount++;
+        survivorId = i + 1;
+      }
+    }
+
+    TickResult result = outcome(PLAYER_COUNT, aliveCount, survivorId);
+    if (result.finished)
+      return result;
+
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+      if (alive[i])
+        advance(*players[i], nextX[i], nextY[i]);
+    }
+    ticks++;
+    return result;
+  }
+
+  static constexpr int getPlayerCount() { return PLAYER_COUNT; }
+  const Player *getPlayer(int index) const { return players[index]; }
+  bool isAlive(int index) const { return alive[index]; }
+  void setAlive(int index, bool living) { alive[index] = living; }
+};
+
+// Runtime roster for large games. All players share one controller type; same-cell
+// collisions are found through per-cell claim stamps instead of pairwise checks.
+template <typename Controller>
+class CrowdEngine : public TickCore
+{
+private:
+  std::vector<Controller> controllers;
+  std::vector<char> alive, crashed;
+  std::vector<int> nextX, nextY;
+  std::vector<long> claimTick;
+  std::vector<int> claimOwner;
+
+public:
+  CrowdEngine(int w, int h, const std::vector<Controller> &list)
+      : TickCore(w, h), controllers(list), alive(list.size()), crashed(list.size()), nextX(list.size()), nextY(list.size()),
+        claimTick(static_cast<size_t>(w) * h, -1), claimOwner(static_cast<size_t>(w) * h, -1)
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    occupied.clear();
+    ticks = 0;
+    std::fill(claimTick.begin(), claimTick.end(), -1);
+    for (size_t i = 0; i < controllers.size(); i++)
+    {
+      alive[i] = true;
+      occupy(*controllers[i].player());
+    }
+  }
+
+  void respawn(const std::pair<int, int> *spawns, const Direction *dirs)
+  {
+    for (size_t i = 0; i < controllers.size(); i++)
+      controllers[i].respawn(spawns[i].first, spawns[i].second, dirs[i]);
+    reset();
+  }
+
+  bool handleKey(int ch)
+  {
+    for (auto &controller : controllers)
+    {
+      if (controller.handleKey(ch))
+        return true;
+    }
+    return false;
+  }
+
+  TickResult tick()
+  {
+    const int count = static_cast<int>(controllers.size());
+    for (int i = 0; i < count; i++)
+    {
+      if (alive[i])
+        controllers[i].think(occupied);
+    }
+
+    std::fill(crashed.begin(), crashed.end(), 0);
+    for (int i = 0; i < count; i++)
+    {
+      if (!alive[i])
+        continue;
+
+      const Player *player = controllers[i].player();
+      nextX[i] = player->getNextX();
+      nextY[i] = player->getNextY();
+      if (!occupied.isFree(nextX[i], nextY[i]))
+      {
+        crashed[i] = true;
+        continue;
+      }
+
+      size_t cell = static_cast<size_t>(nextY[i]) * width + nextX[i];
+      if (claimTick[cell] == ticks)
+      {
+        crashed[i] = true;
+        crashed[claimOwner[cell]] = true;
+      }
+      claimTick[cell] = ticks;
+      claimOwner[cell] = i;
+    }
+
+    int aliveCount = 0;
+    int survivorId = Config::WINNER_TIE;
+    for (int i = 0; i < count; i++)
+    {
+      alive[i] = alive[i] && !crashed[i];
+      if (alive[i])
+      {
+        aliveCount++;
+        survivorId = i + 1;
+      }
+    }
+
+    TickResult result = outcome(count, aliveCount, survivorId);
+    if (result.finished)
+      return result;
+
+    for (int i = 0; i < count; i++)
+    {
+      if (alive[i])
+        advance(*controllers[i].player(), nextX[i], nextY[i]);
+    }
+    ticks++;
+    return result;
+  }
+
+  template <typename Visitor>
+  void visitControllers(Visitor &&visit)
+  {
+    for (size_t i = 0; i < controllers.size(); i++)
+      visit(static_cast<int>(i), controllers[i]);
+  }
+
+  int getPlayerCount() const { return static_cast<int>(controllers.size()); }
+  const Player *getPlayer(int index) const { return controllers[index].player(); }
+  bool isAlive(int index) const { return alive[index] != 0; }
+  void setAlive(int index, bool living) { alive[index] = living; }
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include "grid.h"
+#include "arenamap.h"
+#include "regions.h"
+#include "player.h"
+#include "types.h"
+#include "weights.h"
+#include "nnue.h"
+
+struct CandidateBatch
+{
+  std::vector<int> x, y, dir;
+  std::vector<int> space, wallDistance, lookAhead, exits, opponentDistance, learned;
+  std::vector<int> score;
+
+  void clear();
+  void reserve(size_t n);
+  void add(int cx, int cy, Direction d);
+  size_t size() const { return x.size(); }
+};
+
+class BotEvaluator
+{
+private:
+  // Where a trail stood at the last prepare(), to tell growth from a new round.
+  struct TrailMark
+  {
+    long total = 0;
+    long retired = 0;
+    int first = -1;
+    int last = -1;
+  };
+
+  Grid grid;
+  const ArenaMap *map;
+  RegionMap regions;
+  TrailMark selfMark, opponentMark;
+  bool synced;
+  // With fading trails, freeAt holds the bot's move count at which each trail cell
+  // can be entered again; the regions are not kept since cells come free.
+  bool fading;
+  long now;
+  std::vector<long> freeAt;
+  std::vector<uint32_t> visited;
+  uint32_t visitStamp;
+  std::vector<int> queue;
+  std::vector<int> depth;
+  long nodes;
+  bool outOfTime;
+  std::chrono::steady_clock::time_point deadline;
+  // Optional learned term: the first-layer sums for both riders' views follow the
+  // grid cell by cell, so each candidate only applies its own move.
+  const NnueNetwork *network;
+  NnueAccumulator selfAccumulator, opponentAccumulator;
+
+  int floodFill(int startX, int startY, long maxNodes);
+  bool extends(const Trail &trail, const TrailMark &previous) const;
+  void mark(const Trail &trail, TrailMark &target) const;
+  void stamp(const Trail &trail, long from, uint8_t value, long clockOffset, bool fillRegions);
+  void retire(const Trail &trail, const TrailMark &previous);
+
+public:
+  BotEvaluator();
+
+  void reserve(int width, int height);
+  void setMap(const ArenaMap *newMap);
+  void setNetwork(const NnueNetwork *newNetwork);
+  void prepare(const Player &self, const Player &opponent, int width, int height);
+  long evaluate(CandidateBatch &batch, const BotWeights &weights, Direction currentDir, int opponentX, int opponentY,
+                long maxNodesPerCandidate, std::chrono::steady_clock::time_point until);
+
+  bool separated(int selfX, int selfY, int opponentX, int opponentY) const;
+  bool isFree(int x, int y) const { return grid.isFree(x, y); }
+  const Grid &getGrid() const { return grid; }
+  const RegionMap &getRegions() const { return regions; }
+};
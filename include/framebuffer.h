@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstdarg>
+#include "glyphs.h"
+
+class Renderer;
+
+struct Cell
+{
+  char glyph[4];
+  uint8_t length;
+  short color;
+
+  bool operator==(const Cell &other) const;
+  bool operator!=(const Cell &other) const { return !(*this == other); }
+};
+
+const Cell BLANK_CELL = {{' ', 0, 0, 0}, 1, 0};
+// Longest run of cells present() hands a renderer in one call.
+const int MAX_RUN = 256;
+
+class FrameBuffer
+{
+private:
+  int width, height;
+  int capacityWidth, capacityHeight;
+  std::vector<Cell> back;
+  std::vector<Cell> front;
+  bool fullRepaint;
+
+  Cell &at(std::vector<Cell> &cells, int x, int y) { return cells[y * capacityWidth + x]; }
+
+public:
+  FrameBuffer();
+
+  void resize(int w, int h);
+  void clear();
+  void invalidate() { fullRepaint = true; }
+
+  void put(int x, int y, const char *glyph, int length, int color);
+  void put(int x, int y, const Glyph &glyph, int color) { put(x, y, glyph.bytes, glyph.length, color); }
+  void print(int x, int y, int color, const char *format, ...);
+  void vprint(int x, int y, int color, const char *format, va_list args);
+
+  int flush(Renderer &out);
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  int getCapacityWidth() const { return capacityWidth; }
+  int getCapacityHeight() const { return capacityHeight; }
+};
@@ -3,6 +3,16 @@
 #include "player.h"
 #include "bot.h"
 #include "config.h"
+#include "framebuffer.h"
+#include "renderer.h"
+#include "engine.h"
+#include "arena.h"
+#include "arenamap.h"
+#include "replay.h"
+#include "pacer.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include "rng.h"
 #include <ncurses.h>
 #include <chrono>
 #include <locale.h>
@@ -18,9 +28,34 @@ private:
   GameSpeed currentGameSpeed;
   GameMode currentGameMode;
   int currentColorScheme;
+  BotDifficulty botDifficulty;
+  BotWeights botWeights;
+  const NnueNetwork *network;
+  int trailLength;
+  int searchThreads;
+  int battleSpeed;
   bool firstStart;
+  bool recordStats;
 
-  Bot *gameBot;
+  MatchArena arena;
+  ArenaMap map;
+  std::vector<std::pair<int, int>> obstacles;
+  ReplayWriter recorder;
+  Rng spawner;
+
+  // A match loaded with --resume replaces the first round; S while paused saves to snapshotPath.
+  MatchSnapshot resumed;
+  bool resuming;
+  std::string snapshotPath;
+  std::string snapshotError;
+  bool suspended;
+  // Set by init() and cleared by cleanup(), which does nothing for a game never shown.
+  bool initialized;
+
+  FrameBuffer frame;
+  CursesRenderer screen;
+  RenderPacer pacer;
+  int viewX, viewY;
 
   std::chrono::steady_clock::time_point gameStartTime;
   std::chrono::steady_clock::time_point currentTime;
@@ -31,7 +66,32 @@ private:
   std::pair<std::pair<int, int>, std::pair<int, int>> getTwoPlayerSpawnPositions(int width, int height);
   std::pair<int, int> getRandomPositionOnSide(int side, int width, int height);
 
-  Direction getSafeDirection(int side);
+  template <typename Engine>
+  void play(Engine &engine);
+  template <typename Engine>
+  void watch(Engine &engine);
+  template <typename Engine>
+  bool step(Engine &engine, int ch);
+  template <typename Engine>
+  void control(Engine &engine, int ch);
+  template <typename Engine>
+  bool advance(Engine &engine);
+  template <typename Match>
+  void withEngine(Match &&match);
+  template <typename Engine>
+  void respawn(Engine &engine);
+  template <typename Engine>
+  void render(const Engine &engine);
+  template <typename Engine>
+  void beginRecording(const Engine &engine);
+  template <typename Engine>
+  void record(const Engine &engine, const TickResult &result);
+  template <typename Engine>
+  bool resume(Engine &engine);
+  template <typename Engine>
+  void suspend(Engine &engine);
+  void pause(bool paused);
+  int readKey();
 
 public:
   Game(int w, int h);
@@ -39,29 +99,23 @@ public:
 
   void init();
   void run();
-  void update(Player &player);
-  void render(Player &player);
-  void handleInput(Player &player);
-  void handleInputTwoPlayer(Player &player1, Player &player2);
-  void updateTwoPlayer(Player &player1, Player &player2);
-  void renderTwoPlayer(Player &player1, Player &player2);
-  void handleInputVsBot(Player &player, Bot &bot);
-  void updateVsBot(Player &player, Bot &bot);
-  void renderVsBot(Player &player, Bot &bot);
+  long playScripted(const std::vector<int> &keys, int warmupTicks, int ticks);
   void cleanup();
 
-  bool checkWallCollision(int x, int y);
-  bool checkTrailCollision(int x, int y, const Player &player);
-
   void gameOver(int winner = Config::WINNER_TIE);
-  void restart(Player *player1, Player *player2 = nullptr, Bot *bot = nullptr);
   void startGame();
   int winner;
 
   void showWelcomeMessage();
   void renderHUD();
+  void renderGameOver();
+  void renderPaused();
 
   void drawBorders();
+  void drawObstacles();
+  void drawText(int x, int y, int color, const char *format, ...);
+  void layout();
+  void present();
 
   void updateScore();
   int getScore() const;
@@ -69,7 +123,25 @@ public:
   void setGameSpeed(GameSpeed speed);
   void setColorScheme(int scheme);
   void setGameMode(GameMode mode);
+  void setBotDifficulty(BotDifficulty difficulty);
+  void setBotWeights(const BotWeights &weights);
+  void setNetwork(const NnueNetwork *learned);
+  void setTrailLength(int cells);
+  void setSearchThreads(int threads);
+  void setMap(const ArenaMap &arenaMap);
+  // Appends every round played from now on to a replay file.
+  bool setReplayFile(const std::string &path, std::string &error) { return recorder.open(path, error); }
+  // Starts the next game from a saved match, in its mode, speed and arena, paused.
+  bool loadSnapshot(const std::string &path, std::string &error);
+  void setSnapshotFile(const std::string &path) { snapshotPath = path; }
+  const std::string &getSnapshotFile() const { return snapshotPath; }
+  bool wasSuspended() const { return suspended; }
+
+  static Direction getSafeDirection(int side);
+  static int getSideSpan(int side, int width, int height);
+  static std::pair<int, int> getPositionOnSide(int side, int offset, int width, int height);
 
+  const RenderPacer &getPacer() const { return pacer; }
   bool isRunning() const { return running; }
   void stop() { running = false; }
   GameState getState() const { return state; }
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include "types.h"
+
+struct Glyph
+{
+  char bytes[5];
+  uint8_t length;
+};
+
+namespace Glyphs
+{
+  constexpr Glyph make(const char *utf8)
+  {
+    Glyph glyph = {{0, 0, 0, 0, 0}, 0};
+    while (glyph.length < 4 && utf8[glyph.length])
+    {
+      glyph.bytes[glyph.length] = utf8[glyph.length];
+      glyph.length++;
+    }
+    return glyph;
+  }
+
+  constexpr const char *unicodeFor(int from, int to, bool head)
+  {
+    if (head)
+    {
+      return to == UP ? "⇡" : to == DOWN ? "⇣" : to == LEFT ? "⇠" : "⇢";
+    }
+    if (from == to)
+    {
+      return (from == UP || from == DOWN) ? "┆" : "┄";
+    }
+    if ((from == LEFT && to == DOWN) || (from == UP && to == RIGHT))
+      return "┌";
+    if ((from == RIGHT && to == DOWN) || (from == UP && to == LEFT))
+      return "┐";
+    if ((from == LEFT && to == UP) || (from == DOWN && to == RIGHT))
+      return "└";
+    if ((from == RIGHT && to == UP) || (from == DOWN && to == LEFT))
+      return "┘";
+    return "┄";
+  }
+
+  constexpr const char *asciiFor(int from, int to, bool head)
+  {
+    if (head)
+    {
+      return to == UP ? "^" : to == DOWN ? "v" : to == LEFT ? "<" : ">";
+    }
+    if (from == to)
+    {
+      return (from == UP || from == DOWN) ? "|" : "-";
+    }
+    return "+";
+  }
+
+  struct TrailTable
+  {
+    Glyph cells[4][4][2];
+  };
+
+  constexpr TrailTable buildTable(bool unicode)
+  {
+    TrailTable table = {};
+    for (int from = 0; from < 4; from++)
+    {
+      for (int to = 0; to < 4; to++)
+      {
+        for (int head = 0; head < 2; head++)
+        {
+          table.cells[from][to][head] = make(unicode ? unicodeFor(from, to, head) : asciiFor(from, to, head));
+        }
+      }
+    }
+    return table;
+  }
+
+  constexpr TrailTable UNICODE_TRAIL = buildTable(true);
+  constexpr TrailTable ASCII_TRAIL = buildTable(false);
+
+  inline const Glyph &trail(Direction from, Direction to, bool head)
+  {
+    return UNICODE_TRAIL.cells[from][to][head];
+  }
+
+  inline const Glyph &asciiTrail(Direction from, Direction to, bool head)
+  {
+    return ASCII_TRAIL.cells[from][to][head];
+  }
+}
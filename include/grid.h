@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "types.h"
+#include "config.h"
+
+class ArenaMap;
+
+// Occupancy of an arena. clear() restores the static layer: the border plus any map walls.
+class Grid
+{
+private:
+  int width, height;
+  std::vector<uint8_t> cells;
+  std::vector<uint8_t> base;
+
+public:
+  Grid(int w = 0, int h = 0);
+
+  void resize(int w, int h);
+  void clear();
+  void setObstacles(const ArenaMap &map);
+
+  bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+  bool isFree(int x, int y) const { return inBounds(x, y) && cells[y * width + x] == Config::CELL_EMPTY; }
+  uint8_t get(int x, int y) const { return inBounds(x, y) ? cells[y * width + x] : Config::CELL_WALL; }
+  void set(int x, int y, uint8_t value);
+  // Overwrites every cell from a saved copy of getCells().
+  void assign(const uint8_t *values);
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  const std::vector<uint8_t> &getCells() const { return cells; }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "arena.h"
+#include "engine.h"
+#include "rng.h"
+#include "types.h"
+#include "config.h"
+
+struct HostSettings
+{
+  int matches = Config::HOST_DEFAULT_MATCHES;
+  int threads = 0;
+  int width = Config::HOST_DEFAULT_WIDTH;
+  int height = Config::HOST_DEFAULT_HEIGHT;
+  BotDifficulty difficulty = BOT_EASY;
+  double seconds = Config::HOST_DEFAULT_SECONDS;
+  bool unthrottled = false;
+  uint64_t seed = 1;
+};
+
+// Tick latency in microseconds, bucketed by powers of two.
+struct LatencyStats
+{
+  long ticks = 0;
+  long totalMicros = 0;
+  long maxMicros = 0;
+  long buckets[Config::HOST_LATENCY_BUCKETS] = {};
+
+  void record(long micros);
+  void merge(const LatencyStats &other);
+  long percentile(double fraction) const;
+  double mean() const { return ticks ? static_cast<double>(totalMicros) / ticks : 0.0; }
+};
+
+// Single-level hashed timer wheel. Entries are small integers (match indices) kept in
+// intrusive per-slot lists, so scheduling never allocates. Entries fire once their
+// slot has been reached, at most one resolution step late and never early.
+class TimerWheel
+{
+private:
+  std::vector<int> heads;
+  std::vector<int> next;
+  std::vector<long> dueSlot;
+  long resolution;
+  long cursor;
+
+public:
+  TimerWheel(int slots, long resolutionMicros, int capacity);
+
+  void schedule(int entry, long dueMicros);
+  long nextDueMicros() const;
+
+  template <typename Expired>
+  void advance(long nowMicros, Expired &&expired)
+  {
+    long nowSlot = nowMicros / resolution;
+    long slotCount = static_cast<long>(heads.size());
+    long first = std::max(cursor, nowSlot - slotCount + 1);
+    for (long slot = first; slot <= nowSlot; slot++)
+    {
+      int index = static_cast<int>(slot % slotCount);
+      int entry = heads[index];
+      heads[index] = -1;
+      cursor = slot + 1;
+      while (entry >= 0)
+      {
+        int following = next[entry];
+        if (dueSlot[entry] <= nowSlot)
+          expired(entry);
+        else
+        {
+          next[entry] = heads[index];
+          heads[index] = entry;
+        }
+        entry = following;
+      }
+    }
+    cursor = std::max(cursor, nowSlot + 1);
+  }
+};
+
+// One headless bot-vs-bot match. Rounds restart in place when they finish.
+struct HostedMatch
+{
+  MatchArena arena;
+  std::unique_ptr<TickEngine<BotController, BotController>> engine;
+  Rng rng;
+  GameSpeed speed;
+  long dueMicros;
+  long rounds;
+  LatencyStats latency;
+
+  HostedMatch(const HostSettings &settings, GameSpeed matchSpeed, uint64_t seed);
+
+  void startRound(int width, int height);
+};
+
+// Runs many independent matches on a fixed pool of threads. Each thread owns a shard
+// of the matches and one timer wheel, and sleeps only when none of its matches is due.
+class MatchHost
+{
+private:
+  HostSettings settings;
+  int threadCount;
+  std::vector<std::unique_ptr<HostedMatch>> matches;
+  double elapsedSeconds;
+
+  void runShard(int shard);
+
+public:
+  explicit MatchHost(const HostSettings &hostSettings);
+
+  void run();
+
+  int getThreadCount() const { return threadCount; }
+  int getMatchCount() const { return static_cast<int>(matches.size()); }
+  const HostedMatch &getMatch(int index) const { return *matches[index]; }
+  double getElapsedSeconds() const { return elapsedSeconds; }
+  LatencyStats aggregate() const;
+  long totalRounds() const;
+};
+
+int runHost(int argc, char **argv);
@@ -5,6 +5,24 @@
 #include <string>
 #include "types.h"
 #include "config.h"
+#include "framebuffer.h"
+#include "renderer.h"
+
+// One selectable line: the action it applies, then the screen and selection it leads to.
+struct MenuItem
+{
+  const char *label;
+  MenuAction action;
+  int value;
+  MenuState next;
+  int nextSelection;
+};
+
+struct MenuScreen
+{
+  const char *title;
+  std::vector<MenuItem> items;
+};
 
 class Menu
 {
@@ -13,13 +31,17 @@ private:
   int selectedOption;
   int menuWidth, menuHeight;
 
-  std::vector<std::string> mainMenuOptions;
-  std::vector<std::string> gameModeOptions;
-  std::vector<std::string> settingsOptions;
+  std::vector<MenuScreen> screens;
 
   GameSpeed currentGameSpeed;
   int currentColorScheme;
   GameMode currentGameMode;
+  BotDifficulty currentBotDifficulty;
+  int currentTrailLength;
+  int currentSearchThreads;
+
+  FrameBuffer frame;
+  CursesRenderer screen;
 
 public:
   Menu();
@@ -27,28 +49,37 @@ public:
 
   void init();
   void render();
+  void compose(int width, int height);
+  void redraw() { frame.invalidate(); }
   bool handleInput();
+  bool handleKey(int ch);
 
   MenuState getCurrentState() const { return currentState; }
   void setState(MenuState newState);
   int getSelectedOption() const { return selectedOption; }
+  const FrameBuffer &getFrame() const { return frame; }
+  FrameBuffer &getFrame() { return frame; }
 
   GameSpeed getGameSpeed() const { return currentGameSpeed; }
   int getColorScheme() const { return currentColorScheme; }
   GameMode getGameMode() const { return currentGameMode; }
-
-  void showMainMenu();
-  void showGameModeMenu();
-  void showSettingsMenu();
-  void showGameSpeedMenu();
-  void showColorSchemeMenu();
+  BotDifficulty getBotDifficulty() const { return currentBotDifficulty; }
+  void setBotDifficulty(BotDifficulty difficulty) { currentBotDifficulty = difficulty; }
+  int getTrailLength() const { return currentTrailLength; }
+  void setTrailLength(int cells) { currentTrailLength = cells; }
+  int getSearchThreads() const { return currentSearchThreads; }
+  void setSearchThreads(int threads) { currentSearchThreads = threads; }
 
   bool shouldStartGame() const;
   bool shouldQuit() const;
 
 private:
   void initColors();
-  void drawMenuBox(int startY, int startX, int height, int width, const std::string &title);
-  void drawMenuOptions(const std::vector<std::string> &options, int startY, int startX);
+  const MenuItem *selectedItem() const;
+  bool isCurrent(const MenuItem &item) const;
+  void apply(const MenuItem &item);
+  void describe(const MenuItem &item, char *text, int size) const;
+  void drawScreen(const MenuScreen &menu);
+  void drawStats();
   void resetSelection();
 };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "config.h"
+
+// First-layer sums for one rider's view: the blocked cells of the patch around its
+// anchor block, the other rider's head when it is inside the patch and its own head's
+// place in the block. Only the cells that change between looks need to be applied.
+struct NnueAccumulator
+{
+  int16_t values[Config::NNUE_HIDDEN];
+  int centerX = 0, centerY = 0;
+  int headX = -1, headY = -1;
+  int otherX = -1, otherY = -1;
+};
+
+// Float weights the trainer works on; quantize() turns them into a network.
+struct NnueFloatWeights
+{
+  std::vector<float> input, inputBias, hidden, hiddenBias, output;
+  float outputBias = 0;
+
+  NnueFloatWeights();
+};
+
+// A small quantized network: int16 first layer shared by both views, clipped ReLU,
+// int8 hidden layer of NNUE_LAYER2 units, int8 output. evaluate() returns the expected
+// territory lead of the first view's rider, in cells.
+class NnueNetwork
+{
+private:
+  std::vector<int16_t> inputWeights;
+  std::vector<int16_t> inputBias;
+  std::vector<int8_t> hiddenWeights;
+  std::vector<int32_t> hiddenBias;
+  std::vector<int8_t> outputWeights;
+  int32_t outputBias;
+
+  void apply(NnueAccumulator &acc, int feature, int sign) const;
+  static int patchIndex(const NnueAccumulator &acc, int x, int y);
+  static int headFeature(int x, int y);
+
+public:
+  NnueNetwork();
+
+  bool isLoaded() const { return !inputWeights.empty(); }
+  bool load(const std::string &path, std::string &error);
+  bool save(const std::string &path) const;
+  void quantize(const NnueFloatWeights &weights);
+
+  void refresh(NnueAccumulator &acc, const Grid &grid, int headX, int headY, int otherX, int otherY) const;
+  void setCell(NnueAccumulator &acc, int x, int y, bool blocked) const;
+  void moveHeads(NnueAccumulator &acc, const Grid &grid, int headX, int headY, int otherX, int otherY) const;
+  int evaluate(const NnueAccumulator &self, const NnueAccumulator &other) const;
+
+  // Active feature indexes of a view, as the trainer sees them.
+  static int features(const Grid &grid, int headX, int headY, int otherX, int otherY, int *out);
+
+  static bool train(const std::string &path, int games, uint64_t seed = 1);
+  static bool train(NnueNetwork &network, int games, uint64_t seed, bool verbose);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "config.h"
+
+// Decides how often the game draws from what drawing costs. Every frame reports the
+// bytes it sent, how long the flush blocked and how much output the terminal has not
+// sent yet. When frames block for more than their share of the ticks they cover, the
+// pacer moves up a level: frames every second tick, then every fourth, then ASCII
+// trails, then every eighth tick. It moves back down one level at a time once output
+// has been calm for a while.
+class RenderPacer
+{
+private:
+  long unitMicros;
+  int level;
+  int sinceFrame;
+  int settleFrames;
+  int calmFrames;
+  bool adaptive;
+  double load;
+  double throughput;
+  long lastPending;
+  long frames;
+  long changes;
+
+  void setLevel(int next);
+
+public:
+  RenderPacer();
+
+  // The time one tick (or frame slot) has; resets to drawing every tick.
+  void reset(long micros);
+  // Without adapting, every tick is drawn in Unicode whatever the output costs.
+  void setAdaptive(bool enabled);
+
+  // Counts a tick; true once enough ticks have passed for the next frame.
+  bool tick();
+  void presented(long bytes, long blockedMicros, long pendingBytes);
+
+  int getTicksPerFrame() const { return Config::PACER_TICKS_PER_FRAME[level]; }
+  bool useAscii() const { return Config::PACER_ASCII[level]; }
+  int getLevel() const { return level; }
+  double getLoad() const { return load; }
+  // Bytes per second the output took while blocked, averaged over recent frames.
+  double getThroughput() const { return throughput; }
+  long getPending() const { return lastPending; }
+  long getFrames() const { return frames; }
+  long getChanges() const { return changes; }
+
+  // Bytes written to fd that the terminal has not sent yet, or 0 when it cannot tell.
+  static long outputQueued(int fd);
+};
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include <utility>
 #include "types.h"
 #include "config.h"
+#include "framebuffer.h"
 
 struct TrailSegment
 {
@@ -18,6 +20,81 @@ struct TrailSegment
   const char *getUnicodeChar() const;
 };
 
+// A rider's trail cells, oldest first. With a length limit the cells live in a ring:
+// pushing past the limit overwrites the tail in place, so a retired cell costs O(1).
+class Trail
+{
+private:
+  std::vector<TrailSegment> ring;
+  size_t start;
+  size_t limit;
+  long retired;
+  int retiredX, retiredY;
+
+  size_t slot(size_t index) const
+  {
+    size_t i = start + index;
+    return i < ring.size() ? i : i - ring.size();
+  }
+
+public:
+  class Iterator
+  {
+  private:
+    const Trail *trail;
+    size_t index;
+
+  public:
+    Iterator(const Trail *trail, size_t index) : trail(trail), index(index) {}
+    const TrailSegment &operator*() const { return (*trail)[index]; }
+    const TrailSegment *operator->() const { return &(*trail)[index]; }
+    Iterator &operator++()
+    {
+      index++;
+      return *this;
+    }
+    bool operator!=(const Iterator &other) const { return index != other.index; }
+  };
+
+  Trail() : start(0), limit(0), retired(0), retiredX(-1), retiredY(-1) {}
+
+  bool push(const TrailSegment &segment);
+  void clear();
+  void reserve(size_t cells) { ring.reserve(limit > 0 && limit < cells ? limit : cells); }
+  void setLimit(size_t cells);
+  // Refills a cleared trail, oldest cell first, as it stood when it was saved.
+  void restore(const TrailSegment *cells, size_t count, long retiredCells, int lastRetiredX, int lastRetiredY);
+
+  size_t size() const { return ring.size(); }
+  bool empty() const { return ring.empty(); }
+  const TrailSegment &operator[](size_t index) const { return ring[slot(index)]; }
+  const TrailSegment &front() const { return ring[start]; }
+  const TrailSegment &back() const { return ring[slot(ring.size() - 1)]; }
+  TrailSegment &back() { return ring[slot(ring.size() - 1)]; }
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, ring.size()); }
+
+  // 0 means the trail never fades.
+  size_t getLimit() const { return limit; }
+  // Cells dropped from the tail since the last clear; the latest one is at getRetiredX/Y.
+  long getRetired() const { return retired; }
+  long getTotal() const { return retired + static_cast<long>(ring.size()); }
+  int getRetiredX() const { return retiredX; }
+  int getRetiredY() const { return retiredY; }
+};
+
+// Where a rider stands and how its trail is kept, apart from the trail cells themselves.
+struct RiderState
+{
+  int x = 0, y = 0;
+  Direction direction = RIGHT;
+  Direction lastDirection = RIGHT;
+  bool tailRetired = false;
+  size_t limit = 0;
+  long retired = 0;
+  int retiredX = -1, retiredY = -1;
+};
+
 class Player
 {
 private:
@@ -25,7 +102,8 @@ private:
   int startX, startY;
   Direction direction;
   Direction lastDirection;
-  std::vector<TrailSegment> trail;
+  Trail trail;
+  bool tailRetired;
   int playerId;
 
 public:
@@ -33,8 +111,14 @@ public:
 
   void move();
   void setDirection(Direction newDir);
-  void draw();
+  // ASCII trails send one byte per cell instead of three.
+  void draw(FrameBuffer &frame, int originX, int originY, bool ascii = false) const;
   void reset(int newX = -1, int newY = -1);
+  void respawn(int newX, int newY, Direction newDir);
+  void reserveTrail(size_t cells) { trail.reserve(cells); }
+  void setTrailLimit(size_t cells);
+  void capture(RiderState &state) const;
+  void restore(const RiderState &state, const TrailSegment *cells, size_t count);
 
   void initializeTrail();
 
@@ -46,5 +130,7 @@ public:
   int getX() const { return x; }
   int getY() const { return y; }
   Direction getDirection() const { return direction; }
-  const std::vector<TrailSegment> &getTrail() const { return trail; }
+  const Trail &getTrail() const { return trail; }
+  // Whether the last move dropped the oldest trail cell.
+  bool retiredTail() const { return tailRetired; }
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "types.h"
+#include "config.h"
+
+// Splits the main thread's time and hardware counters (cycles, instructions, cache and
+// branch misses) between tick stages. Every stage switch reads the clock and the whole
+// perf_event group in one call and charges the difference to the stage being left, so
+// bot thinking inside a tick is not also counted as simulation. Where the kernel or
+// the machine offers no counters, only time is kept.
+class TickProfiler
+{
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct StageTotals
+  {
+    double seconds = 0;
+    uint64_t counters[Config::NUM_PROFILE_COUNTERS] = {};
+  };
+
+  int leader;
+  int fds[Config::NUM_PROFILE_COUNTERS];
+  // Position of each counter in a group read, or -1 when it could not be opened.
+  int slots[Config::NUM_PROFILE_COUNTERS];
+  int opened;
+  std::string unavailable;
+
+  // Stage being charged, or -1 between ticks (sleeping, menus).
+  int current;
+  Clock::time_point mark;
+  uint64_t markCounters[Config::NUM_PROFILE_COUNTERS];
+  StageTotals stages[Config::NUM_PROFILE_STAGES];
+  long ticks;
+  long switches;
+  uint64_t timeEnabled, timeRunning;
+
+  void sample(Clock::time_point &now, uint64_t *counters);
+  void close();
+
+  // The profiler of the calling thread; other threads never see one.
+  inline static thread_local TickProfiler *active = nullptr;
+
+public:
+  TickProfiler();
+  ~TickProfiler();
+  TickProfiler(const TickProfiler &) = delete;
+  TickProfiler &operator=(const TickProfiler &) = delete;
+
+  // False when no counter could be opened; the profiler then keeps time only.
+  bool open();
+  // Profiles the calling thread from now on.
+  void install() { active = this; }
+  void uninstall() { active = nullptr; }
+
+  // Starts charging stage (or nothing, for -1) and returns the stage that was charged.
+  int switchTo(int stage);
+  bool hasCounter(ProfileCounter counter) const { return slots[counter] >= 0; }
+  const std::string &getUnavailable() const { return unavailable; }
+  long getTicks() const { return ticks; }
+  void report(FILE *out) const;
+
+  static void countTick()
+  {
+    if (active)
+      active->ticks++;
+  }
+
+  // Charges its lifetime to a stage, then goes back to the stage around it.
+  class Scope
+  {
+  private:
+    TickProfiler *profiler;
+    int previous;
+
+  public:
+    explicit Scope(ProfileStage stage) : profiler(active), previous(profiler ? profiler->switchTo(stage) : -1) {}
+    ~Scope()
+    {
+      if (profiler)
+        profiler->switchTo(previous);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+};
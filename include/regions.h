@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "grid.h"
+
+// Connected components of the free cells of a Grid, kept current as cells fill.
+// Each region also counts its cells with odd x + y, for checkerboard bounds.
+// Filling a cell only shrinks its component unless the cell was a choke; then
+// searches from each side run in lockstep and only the pieces that finish first
+// are relabelled, so the cost follows the smaller side of the split.
+class RegionMap
+{
+private:
+  static const int MAX_SEARCHES = 4;
+
+  int width, height;
+  std::vector<int> labels;
+  std::vector<int> sizes;
+  std::vector<int> oddSizes;
+  std::vector<uint8_t> odd;
+  std::vector<int> freeLabels;
+  std::vector<uint32_t> seen;
+  uint32_t seenStamp;
+  std::vector<uint8_t> owner;
+  std::vector<int> queues[MAX_SEARCHES];
+  long work;
+
+  int newLabel();
+  void splitAround(int cell, int label);
+
+public:
+  RegionMap();
+
+  void reserve(int w, int h);
+  void rebuild(const Grid &grid);
+  void fill(int x, int y);
+
+  int labelAt(int x, int y) const { return labels[y * width + x]; }
+  int sizeAt(int x, int y) const { return sizes[labels[y * width + x]]; }
+  int oddSizeAt(int x, int y) const { return oddSizes[labels[y * width + x]]; }
+  long takeWork();
+};
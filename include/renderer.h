@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "framebuffer.h"
+
+// Receives the changed cells of a FrameBuffer flush. Each run is a stretch of
+// one row whose cells share a colour pair.
+class Renderer
+{
+public:
+  virtual ~Renderer() {}
+
+  virtual void begin(int width, int height, bool repaint) = 0;
+  virtual void run(int x, int y, const Cell *cells, int count) = 0;
+  virtual void end() = 0;
+};
+
+// The terminal through ncurses; colour pairs are whatever init_pair defined. ncurses
+// does its own writing, so the byte count is the glyphs plus an estimate for the
+// cursor moves and colour changes.
+class CursesRenderer : public Renderer
+{
+private:
+  int currentColor;
+  long bytes;
+
+public:
+  CursesRenderer();
+
+  void begin(int width, int height, bool repaint) override;
+  void run(int x, int y, const Cell *cells, int count) override;
+  void end() override;
+
+  long getBytes() const { return bytes; }
+};
+
+// Plain ANSI escape sequences written to a file descriptor once per frame, with
+// its own colour pair table. Nothing is written while the descriptor is negative.
+class AnsiRenderer : public Renderer
+{
+private:
+  struct Pair
+  {
+    short foreground = -1;
+    short background = -1;
+  };
+
+  int fd;
+  std::string out;
+  std::vector<Pair> pairs;
+  int cursorX, cursorY;
+  int currentColor;
+  long bytes;
+
+  void moveTo(int x, int y);
+  void setColor(int color);
+
+public:
+  explicit AnsiRenderer(int fd = -1);
+
+  void setPair(int pair, short foreground, short background);
+  void begin(int width, int height, bool repaint) override;
+  void run(int x, int y, const Cell *cells, int count) override;
+  void end() override;
+
+  const std::string &lastFrame() const { return out; }
+  long getBytes() const { return bytes; }
+};
+
+// Animated GIF written to a file frame by frame. Each cell is a solid block in its
+// pair's foreground colour (pair 0 is background). A frame only encodes the rectangle
+// its runs touched, with cells that did not change left transparent, and is LZW-coded
+// straight to the file.
+class GifRenderer : public Renderer
+{
+private:
+  FILE *file;
+  int width, height;
+  std::vector<uint8_t> screen;
+  std::vector<uint8_t> shown;
+  std::vector<short> pairs;
+  int left, top, right, bottom;
+  int delay;
+  long bytes;
+  std::vector<uint16_t> codes;
+  std::vector<uint8_t> pixels;
+  std::string out;
+
+  void writeHeader();
+  void encode(int x, int y, int w, int h);
+
+public:
+  explicit GifRenderer(FILE *file = nullptr);
+
+  void setPair(int pair, short foreground);
+  // How long the next frame stays up, in hundredths of a second.
+  void setDelay(int centiseconds) { delay = centiseconds; }
+  void begin(int width, int height, bool repaint) override;
+  void run(int x, int y, const Cell *cells, int count) override;
+  void end() override;
+  // Writes the trailer; nothing may be drawn after it.
+  bool finish();
+
+  long getBytes() const { return bytes; }
+};
+
+// Keeps the screen in memory, for benchmarks and golden snapshots.
+class TextRenderer : public Renderer
+{
+private:
+  int width, height;
+  std::vector<Cell> cells;
+
+public:
+  TextRenderer();
+
+  void begin(int width, int height, bool repaint) override;
+  void run(int x, int y, const Cell *cells, int count) override;
+  void end() override {}
+
+  const Cell &at(int x, int y) const { return cells[y * width + x]; }
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+
+  // Glyph rows without trailing blanks, then one character per cell naming its colour pair.
+  std::string snapshot() const;
+};
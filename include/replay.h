@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "player.h"
+#include "arenamap.h"
+#include "grid.h"
+#include "types.h"
+#include "config.h"
+
+// One recorded round: how it started and the direction every rider held on each tick,
+// the tick that ended the round included. Re-simulating the moves reproduces the round
+// without the bots or keys that chose them.
+struct ReplayRound
+{
+  GameMode mode = BOT_BATTLE;
+  int width = 0;
+  int height = 0;
+  int tickMicros = NORMAL;
+  int trailLength = Config::TRAIL_LENGTH_FULL;
+  int players = 0;
+  int winner = Config::WINNER_TIE;
+  MapSpawn spawns[Config::REPLAY_MAX_PLAYERS] = {};
+  // Empty for an open arena.
+  ArenaMap map;
+  // One byte per tick, two bits per rider from the low end.
+  std::vector<uint8_t> moves;
+
+  long getTicks() const { return static_cast<long>(moves.size()); }
+  Direction move(long tick, int player) const { return static_cast<Direction>((moves[tick] >> (2 * player)) & 3); }
+};
+
+// Appends rounds to a replay file; a round is written in one piece when it ends, so a
+// file never holds half a round. The moves buffer is kept between rounds.
+class ReplayWriter
+{
+private:
+  FILE *file;
+  ReplayRound round;
+  bool recording;
+
+public:
+  ReplayWriter();
+  ~ReplayWriter();
+  ReplayWriter(const ReplayWriter &) = delete;
+  ReplayWriter &operator=(const ReplayWriter &) = delete;
+
+  bool open(const std::string &path, std::string &error);
+  void close();
+  bool isOpen() const { return file != nullptr; }
+
+  void begin(GameMode mode, int width, int height, int tickMicros, int trailLength, const ArenaMap &map, int players,
+             const Player *const *riders);
+  void tick(const Player *const *riders);
+  bool end(int winner);
+};
+
+// Reads rounds one at a time, so memory stays at one round whatever the file size.
+// Reading stops at the first torn or corrupt round, which isDamaged() then tells apart
+// from the end of the file.
+class ReplayReader
+{
+private:
+  FILE *file;
+  long size;
+  long rounds;
+  std::string damage;
+
+  bool refuse(const char *reason);
+
+public:
+  ReplayReader();
+  ~ReplayReader();
+  ReplayReader(const ReplayReader &) = delete;
+  ReplayReader &operator=(const ReplayReader &) = delete;
+
+  bool open(const std::string &path, std::string &error);
+  void close();
+  bool next(ReplayRound &round);
+  long getRounds() const { return rounds; }
+  bool isDamaged() const { return !damage.empty(); }
+  const std::string &getDamage() const { return damage; }
+
+  static bool readRound(const std::string &path, long index, ReplayRound &round, std::string &error);
+};
+
+// Steers a rider along a recorded round for TickEngine.
+class ReplayController
+{
+private:
+  Player *rider;
+  const ReplayRound *round;
+  int index;
+  long tick;
+
+public:
+  ReplayController(Player &player, const ReplayRound &recorded, int rider) : rider(&player), round(&recorded), index(rider), tick(0) {}
+
+  Player *player() const { return rider; }
+  bool handleKey(int) { return false; }
+  void think(const Grid &);
+  void respawn(int x, int y, Direction dir);
+};
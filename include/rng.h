@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+class Rng
+{
+private:
+  uint64_t state;
+
+public:
+  explicit Rng(uint64_t seed = 0);
+
+  void seed(uint64_t value) { state = value; }
+  uint64_t next();
+  int range(int low, int high);
+
+  uint64_t getState() const { return state; }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "grid.h"
+#include "types.h"
+#include "config.h"
+
+enum SearchBound
+{
+  BOUND_EXACT = 0,
+  BOUND_LOWER = 1,
+  BOUND_UPPER = 2
+};
+
+struct TableEntry
+{
+  int depth;
+  int score;
+  SearchBound bound;
+  int move;
+};
+
+// Shared by every thread of a search without locks. Each slot holds the key XORed with
+// the packed data next to the data itself; a slot torn by two racing writers fails the
+// key check on probe instead of handing back another position's score.
+class TranspositionTable
+{
+private:
+  struct Slot
+  {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+  };
+
+  std::unique_ptr<Slot[]> slots;
+  size_t mask;
+
+public:
+  TranspositionTable();
+
+  void resize(size_t entries);
+  void clear();
+  bool probe(uint64_t key, TableEntry &entry) const;
+  void store(uint64_t key, int depth, int score, SearchBound bound, int move);
+  size_t size() const { return mask + 1; }
+};
+
+class Search
+{
+private:
+  int width, height;
+  std::vector<uint8_t> board;
+  std::vector<int> dist;
+  std::vector<uint8_t> owner;
+  std::vector<int> queue;
+  long nodes;
+
+  // Deep-search state: the board's key, the shared table and when to give up.
+  uint64_t key;
+  int rootSelf, rootOpp;
+  int variation;
+  TranspositionTable *table;
+  const std::atomic<bool> *stop;
+  long maxNodes;
+  std::chrono::steady_clock::time_point deadline;
+  bool limited;
+  bool aborted;
+  long tableHits;
+
+  int offset(Direction dir) const;
+  void occupy(int cell, uint8_t value);
+  void vacate(int cell);
+  void order(int first, Direction *dirs) const;
+  bool outOfBudget();
+  int alphaBeta(int selfPos, int oppPos, int depth, int alpha, int beta);
+  int replyValue(int selfPos, int oppPos, int depth, int alpha, int beta);
+  int evaluate(int selfPos, int oppPos);
+
+public:
+  Search();
+
+  Direction bestMove(const Grid &grid, int selfX, int selfY, Direction selfDir, int oppX, int oppY, int depth);
+  // Cells self reaches strictly first minus cells the opponent does; the static score at the leaves.
+  int territory(const Grid &grid, int selfX, int selfY, int oppX, int oppY);
+
+  // One root for iterative deepening. Variation reorders moves so helper threads
+  // wander into different parts of the tree; searchRoot() fails once the limits hit.
+  void setRoot(const Grid &grid, int selfX, int selfY, int oppX, int oppY);
+  void setLimits(TranspositionTable *shared, const std::atomic<bool> *stopFlag, long nodeLimit,
+                 std::chrono::steady_clock::time_point until, int rotation);
+  bool searchRoot(int depth, Direction preferred, Direction &move, int &score);
+
+  long getNodes() const { return nodes; }
+  long getTableHits() const { return tableHits; }
+};
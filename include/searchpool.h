@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "search.h"
+#include "grid.h"
+#include "types.h"
+#include "config.h"
+
+// What one search did, per thread: the deepest iteration it finished and its work.
+struct SearchReport
+{
+  int threads = 0;
+  int depth = 0;
+  std::vector<int> depths;
+  std::vector<long> nodes;
+  std::vector<long> tableHits;
+
+  long totalNodes() const;
+};
+
+// Lazy SMP: every thread runs iterative deepening on the same root and they share one
+// transposition table, so the helpers mostly fill the table for the main thread.
+// Helpers start one ply deeper on odd threads and order moves differently. The
+// threads are started once and park between searches; with one thread and no
+// deadline the search is deterministic.
+class SearchPool
+{
+private:
+  struct Worker
+  {
+    Search search;
+    int depth = 0;
+    Direction move = UP;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> helpers;
+  TranspositionTable table;
+
+  std::mutex mutex;
+  std::condition_variable wake, finished;
+  uint64_t job;
+  int busy;
+  bool quitting;
+  std::atomic<bool> stop;
+
+  const Grid *grid;
+  int selfX, selfY, oppX, oppY;
+  Direction selfDir;
+  long maxNodes;
+  int maxDepth;
+  std::chrono::steady_clock::time_point deadline;
+  SearchReport report;
+
+  void deepen(int index);
+  void serve(int index, uint64_t seen);
+  void stopHelpers();
+
+public:
+  explicit SearchPool(int threads = 1);
+  ~SearchPool();
+
+  SearchPool(const SearchPool &) = delete;
+  SearchPool &operator=(const SearchPool &) = delete;
+
+  void setThreads(int threads);
+  int getThreads() const { return static_cast<int>(workers.size()); }
+  void clearTable() { table.clear(); }
+
+  // False when not even the first ply finished in time.
+  bool bestMove(const Grid &occupied, int fromX, int fromY, Direction fromDir, int opponentX, int opponentY, long nodeLimit,
+                std::chrono::steady_clock::time_point until, int depthLimit, Direction &move);
+  const SearchReport &getReport() const { return report; }
+
+  static int resolveThreads(int requested);
+};
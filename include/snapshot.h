@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "engine.h"
+#include "arenamap.h"
+#include "weights.h"
+#include "types.h"
+#include "config.h"
+
+// One rider of a saved match; the bot fields only count when bot is set.
+struct SnapshotRider
+{
+  RiderState state;
+  std::vector<TrailSegment> trail;
+  bool alive = true;
+  bool bot = false;
+  BotDifficulty difficulty = BOT_NORMAL;
+  BotBudget budget = {};
+  BotWeights weights;
+  uint64_t noise = 0;
+};
+
+// A match stopped between two ticks: everything the following ticks depend on, plus the
+// clock and score on screen. What bots derive from the board (evaluator grids, region
+// labels, search tables) is rebuilt on their next move rather than saved.
+struct MatchSnapshot
+{
+  GameMode mode = SINGLE_PLAYER;
+  int width = 0;
+  int height = 0;
+  int tickMicros = NORMAL;
+  int trailLength = Config::TRAIL_LENGTH_FULL;
+  int battleSpeed = 0;
+  int score = 0;
+  long ticks = 0;
+  long elapsedMicros = 0;
+  // State of the generator that places the next round's spawns.
+  uint64_t spawner = 0;
+  // Empty for an open arena.
+  ArenaMap map;
+  std::vector<uint8_t> grid;
+  std::vector<SnapshotRider> riders;
+
+  template <typename Engine>
+  void capture(Engine &engine);
+  // False, leaving the engine alone, when the snapshot does not fit its roster or size.
+  template <typename Engine>
+  bool restore(Engine &engine) const;
+
+  // Written to a temporary file and renamed over path, so a crash never leaves half a snapshot.
+  bool save(const std::string &path, std::string &error) const;
+  // Maps the file and copies the match out of it; a torn or foreign file is refused.
+  bool load(const std::string &path, std::string &error);
+
+  static std::string defaultPath();
+};
+
+void captureController(const HumanController &controller, SnapshotRider &rider);
+void captureController(const BotController &controller, SnapshotRider &rider);
+void restoreController(HumanController &controller, const SnapshotRider &rider);
+void restoreController(BotController &controller, const SnapshotRider &rider);
+
+template <typename Engine>
+void MatchSnapshot::capture(Engine &engine)
+{
+  width = engine.getWidth();
+  height = engine.getHeight();
+  ticks = engine.getTicks();
+  grid = engine.getGrid().getCells();
+  riders.resize(engine.getPlayerCount());
+  for (int i = 0; i < engine.getPlayerCount(); i++)
+  {
+    SnapshotRider &rider = riders[i];
+    const Player &player = *engine.getPlayer(i);
+    player.capture(rider.state);
+    rider.trail.clear();
+    for (const TrailSegment &segment : player.getTrail())
+      rider.trail.push_back(segment);
+    rider.alive = engine.isAlive(i);
+    rider.bot = false;
+  }
+  engine.visitControllers([this](int i, const auto &controller) { captureController(controller, riders[i]); });
+}
+
+template <typename Engine>
+bool MatchSnapshot::restore(Engine &engine) const
+{
+  if (static_cast<int>(riders.size()) != engine.getPlayerCount() || width != engine.getWidth() || height != engine.getHeight() ||
+      grid.size() != engine.getGrid().getCells().size())
+    return false;
+  bool fits = true;
+  engine.visitControllers([this, &fits](int i, auto &controller)
+                          { fits = fits && riders[i].bot == std::is_same<std::decay_t<decltype(controller)>, BotController>::value; });
+  if (!fits)
+    return false;
+
+  engine.visitControllers([this](int i, auto &controller)
+                          {
+                            const SnapshotRider &rider = riders[i];
+                            controller.player()->restore(rider.state, rider.trail.data(), rider.trail.size());
+                            restoreController(controller, rider);
+                          });
+  for (int i = 0; i < engine.getPlayerCount(); i++)
+    engine.setAlive(i, riders[i].alive);
+  engine.restore(grid.data(), ticks);
+  return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include "types.h"
+#include "config.h"
+
+struct MatchSummary
+{
+  int64_t time;
+  GameMode mode;
+  BotDifficulty difficulty;
+  int winner;
+  int seconds;
+};
+
+// Results from player one's side; single player rounds only count games and time.
+struct ModeTotals
+{
+  long matches = 0;
+  long wins = 0;
+  long losses = 0;
+  long ties = 0;
+  int bestSeconds = 0;
+};
+
+struct StatsIndex
+{
+  ModeTotals modes[Config::NUM_GAME_MODES];
+  ModeTotals bots[Config::NUM_BOT_DIFFICULTIES];
+  std::vector<MatchSummary> recent;
+};
+
+// Match results in an append-only log of fixed-size records. Nothing is read until
+// the stats screen asks for the index, which then only reads what was appended since.
+// Once the log grows past a limit a background thread folds it into per-mode totals
+// plus the recent matches and swaps the file in place.
+class StatsStore
+{
+private:
+  std::mutex mutex;
+  std::string path;
+  StatsIndex index;
+  bool indexed;
+  ino_t indexedInode;
+  off_t indexedSize;
+  std::thread compactor;
+  std::atomic<bool> compacting;
+  bool autoCompact;
+
+  StatsStore();
+  void resetIndex();
+  void compactInBackground();
+
+public:
+  ~StatsStore();
+  StatsStore(const StatsStore &) = delete;
+  StatsStore &operator=(const StatsStore &) = delete;
+
+  static StatsStore &instance();
+
+  bool record(GameMode mode, BotDifficulty difficulty, int winner, int seconds);
+  StatsIndex snapshot();
+  bool compact();
+  // Off, record() leaves the log to grow; turning it off waits for a running compaction.
+  void setAutoCompact(bool enabled);
+
+  const std::string &getPath() const { return path; }
+  void setPath(const std::string &newPath);
+};
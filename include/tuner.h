@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "weights.h"
+#include "config.h"
+#include "arena.h"
+#include "engine.h"
+
+struct TunerSettings
+{
+  int width = Config::TUNER_DEFAULT_WIDTH;
+  int height = Config::TUNER_DEFAULT_HEIGHT;
+  long games = Config::TUNER_DEFAULT_GAMES;
+  int gamesPerIteration = Config::TUNER_DEFAULT_GAMES_PER_ITERATION;
+  int gamesPerBatch = Config::TUNER_DEFAULT_GAMES_PER_BATCH;
+  int threads = 0;
+  long nodes = Config::BOT_NORMAL_NODES;
+  double stepSize = 0.2;
+  double perturbation = 0.1;
+  uint64_t seed = 1;
+  int checkpointEvery = Config::TUNER_DEFAULT_CHECKPOINT_EVERY;
+  std::string checkpointPath = "tune.ckpt";
+  std::string outputPath = "tuned.weights";
+};
+
+// Per-thread self-play state. The two bots and the engine are built once and reused
+// by every game, so a game in steady state performs no heap allocation.
+class SelfPlayTable
+{
+private:
+  TunerSettings settings;
+  MatchArena arena;
+  std::unique_ptr<TickEngine<BotController, BotController>> engine;
+
+public:
+  explicit SelfPlayTable(const TunerSettings &tunerSettings);
+
+  int play(const BotWeights &first, const BotWeights &second, uint64_t seed);
+};
+
+// One table per thread for the whole run. The helper threads are started once and park
+// between SPSA iterations; the calling thread plays its share of every iteration too.
+class SelfPlayPool
+{
+private:
+  TunerSettings settings;
+  std::vector<std::unique_ptr<SelfPlayTable>> tables;
+  std::vector<std::thread> helpers;
+
+  std::mutex mutex;
+  std::condition_variable wake, finished;
+  uint64_t job;
+  int busy;
+  bool quitting;
+
+  const BotWeights *plus;
+  const BotWeights *minus;
+  long iteration;
+  std::atomic<int> nextGame;
+  std::atomic<int> score;
+
+  void serve(int index, uint64_t seen);
+  void playShare(int index);
+
+public:
+  SelfPlayPool(const TunerSettings &tunerSettings, int threads);
+  ~SelfPlayPool();
+
+  SelfPlayPool(const SelfPlayPool &) = delete;
+  SelfPlayPool &operator=(const SelfPlayPool &) = delete;
+
+  // Plays one SPSA iteration: the plus and minus vectors swap sides every other game.
+  int playIteration(const BotWeights &plusWeights, const BotWeights &minusWeights, long iterationIndex);
+};
+
+int runTuner(const std::string &configPath);
@@ -11,7 +11,8 @@ enum GameMode
 {
   SINGLE_PLAYER = 0,
   TWO_PLAYER = 1,
-  VS_BOT = 2
+  VS_BOT = 2,
+  BOT_BATTLE = 3
 };
 
 enum GameSpeed
@@ -37,6 +38,14 @@ enum Direction
   RIGHT = 3
 };
 
+enum BotDifficulty
+{
+  BOT_EASY = 0,
+  BOT_NORMAL = 1,
+  BOT_HARD = 2,
+  BOT_INSANE = 3
+};
+
 enum MenuState
 {
   MAIN_MENU,
@@ -44,5 +53,40 @@ enum MenuState
   SETTINGS_MENU,
   GAME_SPEED_MENU,
   COLOR_SCHEME_MENU,
+  DIFFICULTY_MENU,
+  STATS_MENU,
+  TRAIL_MENU,
+  THREADS_MENU,
   IN_GAME
-};
\ No newline at end of file
+};
+
+enum MenuAction
+{
+  MENU_OPEN,
+  MENU_START,
+  MENU_QUIT,
+  MENU_SET_MODE,
+  MENU_SET_SPEED,
+  MENU_SET_COLORS,
+  MENU_SET_DIFFICULTY,
+  MENU_SET_TRAIL,
+  MENU_SET_THREADS
+};
+
+// Parts of a tick the profiler charges time and counters to; bot thinking happens
+// inside the simulation step but is charged separately.
+enum ProfileStage
+{
+  STAGE_INPUT = 0,
+  STAGE_SIMULATION = 1,
+  STAGE_BOT = 2,
+  STAGE_RENDER = 3
+};
+
+enum ProfileCounter
+{
+  COUNTER_CYCLES = 0,
+  COUNTER_INSTRUCTIONS = 1,
+  COUNTER_CACHE_MISSES = 2,
+  COUNTER_BRANCH_MISSES = 3
+};
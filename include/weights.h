@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include "config.h"
+
+struct BotWeights
+{
+  int space = Config::WEIGHT_SPACE;
+  int wallDistance = Config::WEIGHT_WALL_DISTANCE;
+  int keepStraight = Config::WEIGHT_KEEP_STRAIGHT;
+  int keepNear = Config::WEIGHT_KEEP_NEAR;
+  int lookAhead = Config::WEIGHT_LOOK_AHEAD;
+  int exits = Config::WEIGHT_EXITS;
+  int opponentDistance = Config::WEIGHT_OPPONENT_DISTANCE;
+  // Only counts when the bot has a network.
+  int network = Config::WEIGHT_NETWORK;
+
+  static const int COUNT = 8;
+  // The tuner moves only the first TUNED_COUNT weights: its bots play without a network,
+  // so network would just drift.
+  static const int TUNED_COUNT = 7;
+
+  static const char *name(int index);
+  int get(int index) const;
+  void set(int index, int value);
+
+  bool parse(const std::string &key, const std::string &value);
+  bool load(const std::string &path);
+  bool save(const std::string &path) const;
+
+  // Strips spaces, tabs and carriage returns from both ends of a key = value field.
+  static std::string trimField(const std::string &text);
+};
@@ -0,0 +1,70 @@
+#include "../include/alloccount.h"
+
+#ifdef TRON_ALLOC_COUNT
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<long> allocations(0);
+}
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *block = malloc(size ? size : 1);
+    if (!block)
+        throw std::bad_alloc();
+    return block;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *block) noexcept
+{
+    free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+    free(block);
+}
+
+void operator delete[](void *block, size_t) noexcept
+{
+    free(block);
+}
+
+bool AllocationCounter::isEnabled()
+{
+    return true;
+}
+
+long AllocationCounter::count()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isEnabled()
+{
+    return false;
+}
+
+long AllocationCounter::count()
+{
+    return 0;
+}
+
+#endif
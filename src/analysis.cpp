@@ -0,0 +1,603 @@
+#include "../include/analysis.h"
+#include "../include/engine.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    const int MODE_COUNT = 4;
+    const char *const MODE_NAMES[MODE_COUNT] = {"single", "two_player", "vs_bot", "bot_battle"};
+
+    enum Side
+    {
+        SIDE_TOP,
+        SIDE_RIGHT,
+        SIDE_BOTTOM,
+        SIDE_LEFT,
+        SIDE_COUNT
+    };
+
+    int bucketFor(long ticks)
+    {
+        return static_cast<int>(std::min(ticks / Config::ANALYSIS_TICK_BUCKET, static_cast<long>(Config::ANALYSIS_TICK_BUCKETS - 1)));
+    }
+
+    // The last bucket is open-ended, so its upper bound is left empty.
+    void printBucket(FILE *out, int bucket)
+    {
+        long from = static_cast<long>(bucket) * Config::ANALYSIS_TICK_BUCKET;
+        if (bucket == Config::ANALYSIS_TICK_BUCKETS - 1)
+            fprintf(out, "%ld,", from);
+        else
+            fprintf(out, "%ld,%ld", from, from + Config::ANALYSIS_TICK_BUCKET - 1);
+    }
+
+    // Riders start facing into the arena, so the heading tells the side they spawned on.
+    int sideOf(Direction dir)
+    {
+        switch (dir)
+        {
+        case DOWN:
+            return SIDE_TOP;
+        case LEFT:
+            return SIDE_RIGHT;
+        case UP:
+            return SIDE_BOTTOM;
+        case RIGHT:
+        default:
+            return SIDE_LEFT;
+        }
+    }
+
+    const char *sideName(int side)
+    {
+        switch (side)
+        {
+        case SIDE_TOP:
+            return "top";
+        case SIDE_RIGHT:
+            return "right";
+        case SIDE_BOTTOM:
+            return "bottom";
+        default:
+            return "left";
+        }
+    }
+
+    // Rounds and their results: wins[0] counts ties, wins[1] and wins[2] each player's wins.
+    struct Tally
+    {
+        long rounds = 0;
+        long wins[3] = {};
+
+        void add(int winner)
+        {
+            rounds++;
+            wins[winner == Config::WINNER_PLAYER1 || winner == Config::WINNER_PLAYER2 ? winner : 0]++;
+        }
+
+        void merge(const Tally &other)
+        {
+            rounds += other.rounds;
+            for (int i = 0; i < 3; i++)
+                wins[i] += other.wins[i];
+        }
+
+        void print(FILE *out) const { fprintf(out, "%ld,%ld,%ld,%ld", rounds, wins[1], wins[2], wins[0]); }
+    };
+
+    // How each mode's rounds end and how long they last.
+    class OutcomeVisitor : public ReplayVisitor
+    {
+    private:
+        Tally tally[MODE_COUNT];
+        long ticks[MODE_COUNT] = {};
+        long longest[MODE_COUNT] = {};
+        long mismatched[MODE_COUNT] = {};
+
+    public:
+        const char *name() const override { return "outcomes"; }
+        std::unique_ptr<ReplayVisitor> clone() const override { return std::unique_ptr<ReplayVisitor>(new OutcomeVisitor()); }
+
+        void endRound(const ReplayRound &round, const RoundOutcome &outcome) override
+        {
+            tally[round.mode].add(outcome.winner);
+            ticks[round.mode] += outcome.ticks;
+            longest[round.mode] = std::max(longest[round.mode], outcome.ticks);
+            mismatched[round.mode] += !outcome.matches;
+        }
+
+        void merge(const ReplayVisitor &other) override
+        {
+            const OutcomeVisitor &from = static_cast<const OutcomeVisitor &>(other);
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                tally[m].merge(from.tally[m]);
+                ticks[m] += from.ticks[m];
+                longest[m] = std::max(longest[m], from.longest[m]);
+                mismatched[m] += from.mismatched[m];
+            }
+        }
+
+        bool writeCsv(FILE *out) const override
+        {
+            fprintf(out, "mode,rounds,player1_wins,player2_wins,ties,mean_ticks,longest,mismatched\n");
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                if (tally[m].rounds == 0)
+                    continue;
+                fprintf(out, "%s,", MODE_NAMES[m]);
+                tally[m].print(out);
+                fprintf(out, ",%.1f,%ld,%ld\n", static_cast<double>(ticks[m]) / tally[m].rounds, longest[m], mismatched[m]);
+            }
+            return !ferror(out);
+        }
+    };
+
+    // Results by round length: in vs-bot rounds, player 1 wins are the ticks the bot loses at.
+    class LengthVisitor : public ReplayVisitor
+    {
+    private:
+        Tally tally[MODE_COUNT][Config::ANALYSIS_TICK_BUCKETS];
+
+    public:
+        const char *name() const override { return "length"; }
+        std::unique_ptr<ReplayVisitor> clone() const override { return std::unique_ptr<ReplayVisitor>(new LengthVisitor()); }
+
+        void endRound(const ReplayRound &round, const RoundOutcome &outcome) override
+        {
+            tally[round.mode][bucketFor(outcome.ticks)].add(outcome.winner);
+        }
+
+        void merge(const ReplayVisitor &other) override
+        {
+            const LengthVisitor &from = static_cast<const LengthVisitor &>(other);
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int b = 0; b < Config::ANALYSIS_TICK_BUCKETS; b++)
+                    tally[m][b].merge(from.tally[m][b]);
+            }
+        }
+
+        bool writeCsv(FILE *out) const override
+        {
+            fprintf(out, "mode,tick_from,tick_to,rounds,player1_wins,player2_wins,ties\n");
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int b = 0; b < Config::ANALYSIS_TICK_BUCKETS; b++)
+                {
+                    if (tally[m][b].rounds == 0)
+                        continue;
+                    fprintf(out, "%s,", MODE_NAMES[m]);
+                    printBucket(out, b);
+                    fprintf(out, ",");
+                    tally[m][b].print(out);
+                    fprintf(out, "\n");
+                }
+            }
+            return !ferror(out);
+        }
+    };
+
+    // Results by the sides the two riders spawned on.
+    class SpawnVisitor : public ReplayVisitor
+    {
+    private:
+        Tally tally[MODE_COUNT][SIDE_COUNT][SIDE_COUNT];
+
+    public:
+        const char *name() const override { return "spawns"; }
+        std::unique_ptr<ReplayVisitor> clone() const override { return std::unique_ptr<ReplayVisitor>(new SpawnVisitor()); }
+
+        void endRound(const ReplayRound &round, const RoundOutcome &outcome) override
+        {
+            if (round.players == 2)
+                tally[round.mode][sideOf(round.spawns[0].dir)][sideOf(round.spawns[1].dir)].add(outcome.winner);
+        }
+
+        void merge(const ReplayVisitor &other) override
+        {
+            const SpawnVisitor &from = static_cast<const SpawnVisitor &>(other);
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int a = 0; a < SIDE_COUNT; a++)
+                {
+                    for (int b = 0; b < SIDE_COUNT; b++)
+                        tally[m][a][b].merge(from.tally[m][a][b]);
+                }
+            }
+        }
+
+        bool writeCsv(FILE *out) const override
+        {
+            fprintf(out, "mode,player1_side,player2_side,rounds,player1_wins,player2_wins,ties,player1_win_rate\n");
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int a = 0; a < SIDE_COUNT; a++)
+                {
+                    for (int b = 0; b < SIDE_COUNT; b++)
+                    {
+                        const Tally &cell = tally[m][a][b];
+                        if (cell.rounds == 0)
+                            continue;
+                        fprintf(out, "%s,%s,%s,", MODE_NAMES[m], sideName(a), sideName(b));
+                        cell.print(out);
+                        fprintf(out, ",%.4f\n", static_cast<double>(cell.wins[1]) / cell.rounds);
+                    }
+                }
+            }
+            return !ferror(out);
+        }
+    };
+
+    // How play changes as rounds go on: turns, open cells next to each head and the
+    // distance between two riders, per tick bucket.
+    class TempoVisitor : public ReplayVisitor
+    {
+    private:
+        struct Bucket
+        {
+            long riderTicks = 0;
+            long turns = 0;
+            long exits = 0;
+            long distance = 0;
+            long pairs = 0;
+        };
+
+        Bucket buckets[MODE_COUNT][Config::ANALYSIS_TICK_BUCKETS];
+        Direction heading[Config::REPLAY_MAX_PLAYERS];
+
+    public:
+        const char *name() const override { return "tempo"; }
+        std::unique_ptr<ReplayVisitor> clone() const override { return std::unique_ptr<ReplayVisitor>(new TempoVisitor()); }
+        bool wantsTicks() const override { return true; }
+
+        void beginRound(const ReplayRound &round) override
+        {
+            for (int i = 0; i < round.players; i++)
+                heading[i] = round.spawns[i].dir;
+        }
+
+        void tick(const ReplayRound &round, const TickView &view) override
+        {
+            Bucket &bucket = buckets[round.mode][bucketFor(view.tick)];
+            for (int i = 0; i < view.riders; i++)
+            {
+                if (!view.alive[i])
+                    continue;
+                const Player &rider = *view.players[i];
+                int x = rider.getX(), y = rider.getY();
+                bucket.riderTicks++;
+                bucket.turns += rider.getDirection() != heading[i];
+                bucket.exits += view.grid->isFree(x + 1, y) + view.grid->isFree(x - 1, y) + view.grid->isFree(x, y + 1) + view.grid->isFree(x, y - 1);
+                heading[i] = rider.getDirection();
+            }
+            if (view.riders == 2 && view.alive[0] && view.alive[1])
+            {
+                bucket.distance += std::abs(view.players[0]->getX() - view.players[1]->getX()) + std::abs(view.players[0]->getY() - view.players[1]->getY());
+                bucket.pairs++;
+            }
+        }
+
+        void endRound(const ReplayRound &, const RoundOutcome &) override {}
+
+        void merge(const ReplayVisitor &other) override
+        {
+            const TempoVisitor &from = static_cast<const TempoVisitor &>(other);
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int b = 0; b < Config::ANALYSIS_TICK_BUCKETS; b++)
+                {
+                    buckets[m][b].riderTicks += from.buckets[m][b].riderTicks;
+                    buckets[m][b].turns += from.buckets[m][b].turns;
+                    buckets[m][b].exits += from.buckets[m][b].exits;
+                    buckets[m][b].distance += from.buckets[m][b].distance;
+                    buckets[m][b].pairs += from.buckets[m][b].pairs;
+                }
+            }
+        }
+
+        bool writeCsv(FILE *out) const override
+        {
+            fprintf(out, "mode,tick_from,tick_to,rider_ticks,turns_per_100_ticks,mean_exits,mean_head_distance\n");
+            for (int m = 0; m < MODE_COUNT; m++)
+            {
+                for (int b = 0; b < Config::ANALYSIS_TICK_BUCKETS; b++)
+                {
+                    const Bucket &bucket = buckets[m][b];
+                    if (bucket.riderTicks == 0)
+                        continue;
+                    fprintf(out, "%s,", MODE_NAMES[m]);
+                    printBucket(out, b);
+                    fprintf(out, ",%ld,%.2f,%.3f,", bucket.riderTicks, 100.0 * bucket.turns / bucket.riderTicks,
+                            static_cast<double>(bucket.exits) / bucket.riderTicks);
+                    if (bucket.pairs > 0)
+                        fprintf(out, "%.2f", static_cast<double>(bucket.distance) / bucket.pairs);
+                    fprintf(out, "\n");
+                }
+            }
+            return !ferror(out);
+        }
+    };
+
+    // One analysis thread: its own riders and its own clone of every visitor.
+    class AnalysisWorker
+    {
+    private:
+        Player first, second;
+        std::vector<std::unique_ptr<ReplayVisitor>> visitors;
+        std::vector<ReplayVisitor *> tickVisitors;
+
+        template <typename Engine>
+        void simulate(Engine &engine, const ReplayRound &round)
+        {
+            std::pair<int, int> spawns[2];
+            Direction dirs[2];
+            for (int i = 0; i < round.players; i++)
+            {
+                spawns[i] = {round.spawns[i].x, round.spawns[i].y};
+                dirs[i] = round.spawns[i].dir;
+            }
+            engine.setObstacles(round.map);
+            engine.respawn(spawns, dirs);
+            for (auto &visitor : visitors)
+                visitor->beginRound(round);
+
+            const Player *players[2] = {engine.getPlayer(0), engine.getPlayer(round.players - 1)};
+            bool alive[2];
+            TickView view = {0, round.players, players, alive, &engine.getGrid()};
+            TickResult result = {false, Config::WINNER_TIE};
+            long ticks = 0;
+            while (!result.finished && ticks < round.getTicks())
+            {
+                result = engine.tick();
+                ticks++;
+                if (tickVisitors.empty())
+                    continue;
+                for (int i = 0; i < round.players; i++)
+                    alive[i] = engine.isAlive(i);
+                view.tick = ticks;
+                for (ReplayVisitor *visitor : tickVisitors)
+                    visitor->tick(round, view);
+            }
+
+            RoundOutcome outcome = {ticks, result.winner, result.finished && ticks == round.getTicks() && result.winner == round.winner};
+            for (auto &visitor : visitors)
+                visitor->endRound(round, outcome);
+            report.rounds++;
+            report.ticks += ticks;
+            report.mismatched += !outcome.matches;
+        }
+
+    public:
+        AnalysisReport report;
+
+        explicit AnalysisWorker(const std::vector<std::unique_ptr<ReplayVisitor>> &prototypes)
+            : first(0, 0, Config::PLAYER_1_ID), second(0, 0, Config::PLAYER_2_ID)
+        {
+            for (const auto &prototype : prototypes)
+            {
+                visitors.push_back(prototype->clone());
+                if (visitors.back()->wantsTicks())
+                    tickVisitors.push_back(visitors.back().get());
+            }
+        }
+
+        const ReplayVisitor &getVisitor(size_t index) const { return *visitors[index]; }
+
+        void replay(const ReplayRound &round)
+        {
+            if (round.players < 1 || round.players > 2)
+            {
+                report.skipped++;
+                return;
+            }
+            first.setTrailLimit(round.trailLength);
+            second.setTrailLimit(round.trailLength);
+            if (round.players == 1)
+            {
+                TickEngine<ReplayController> engine(round.width, round.height, ReplayController(first, round, 0));
+                simulate(engine, round);
+            }
+            else
+            {
+                TickEngine<ReplayController, ReplayController> engine(round.width, round.height, ReplayController(first, round, 0),
+                                                                      ReplayController(second, round, 1));
+                simulate(engine, round);
+            }
+        }
+    };
+}
+
+const char *const ReplayAnalyzer::VISITOR_NAMES[] = {"outcomes", "length", "spawns", "tempo"};
+const int ReplayAnalyzer::VISITOR_COUNT = 4;
+
+ReplayAnalyzer::ReplayAnalyzer(int threads)
+{
+    threadCount = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+}
+
+std::unique_ptr<ReplayVisitor> ReplayAnalyzer::makeVisitor(const std::string &name)
+{
+    if (name == "outcomes")
+        return std::unique_ptr<ReplayVisitor>(new OutcomeVisitor());
+    if (name == "length")
+        return std::unique_ptr<ReplayVisitor>(new LengthVisitor());
+    if (name == "spawns")
+        return std::unique_ptr<ReplayVisitor>(new SpawnVisitor());
+    if (name == "tempo")
+        return std::unique_ptr<ReplayVisitor>(new TempoVisitor());
+    return nullptr;
+}
+
+bool ReplayAnalyzer::run(const std::string &path, std::string &error)
+{
+    ReplayReader reader;
+    if (!reader.open(path, error))
+        return false;
+    auto start = std::chrono::steady_clock::now();
+
+    // Slots move from the reader to a worker through ready and back through spare.
+    std::vector<ReplayRound> slots(getSlotCount());
+    std::vector<int> spare, ready;
+    spare.reserve(slots.size());
+    ready.reserve(slots.size());
+    for (int i = 0; i < static_cast<int>(slots.size()); i++)
+        spare.push_back(i);
+    std::mutex lock;
+    std::condition_variable slotFreed, roundReady;
+    bool drained = false;
+
+    std::vector<std::unique_ptr<AnalysisWorker>> workers;
+    for (int t = 0; t < threadCount; t++)
+        workers.emplace_back(new AnalysisWorker(visitors));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+                             {
+                                 AnalysisWorker &worker = *workers[t];
+                                 while (true)
+                                 {
+                                     int slot;
+                                     {
+                                         std::unique_lock<std::mutex> held(lock);
+                                         roundReady.wait(held, [&]() { return !ready.empty() || drained; });
+                                         if (ready.empty())
+                                             return;
+                                         slot = ready.back();
+                                         ready.pop_back();
+                                     }
+                                     worker.replay(slots[slot]);
+                                     {
+                                         std::lock_guard<std::mutex> held(lock);
+                                         spare.push_back(slot);
+                                     }
+                                     slotFreed.notify_one();
+                                 }
+                             });
+    }
+
+    while (true)
+    {
+        int slot;
+        {
+            std::unique_lock<std::mutex> held(lock);
+            slotFreed.wait(held, [&]() { return !spare.empty(); });
+            slot = spare.back();
+            spare.pop_back();
+        }
+        if (!reader.next(slots[slot]))
+            break;
+        {
+            std::lock_guard<std::mutex> held(lock);
+            ready.push_back(slot);
+        }
+        roundReady.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> held(lock);
+        drained = true;
+    }
+    roundReady.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+
+    report = AnalysisReport();
+    for (const auto &worker : workers)
+    {
+        for (size_t v = 0; v < visitors.size(); v++)
+            visitors[v]->merge(worker->getVisitor(v));
+        report.rounds += worker->report.rounds;
+        report.ticks += worker->report.ticks;
+        report.mismatched += worker->report.mismatched;
+        report.skipped += worker->report.skipped;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // A torn or corrupt round would otherwise pass for the end of the archive and leave
+    // the tables quietly short.
+    if (reader.isDamaged())
+    {
+        error = path + ": " + reader.getDamage() + ", after " + std::to_string(reader.getRounds()) + " intact rounds";
+        return false;
+    }
+    return true;
+}
+
+int runAnalysis(int argc, char **argv)
+{
+    if (argc < 4 || argc > 6)
+    {
+        fprintf(stderr, "Usage: %s --analyze REPLAY PREFIX [THREADS [VISITOR,...]]\n", argv[0]);
+        return 1;
+    }
+    int threads = argc > 4 ? atoi(argv[4]) : 0;
+    if (threads < 0)
+    {
+        fprintf(stderr, "Threads must be 0 (all cores) or more\n");
+        return 1;
+    }
+
+    std::vector<std::string> names;
+    if (argc > 5)
+    {
+        std::string list = argv[5];
+        size_t from = 0;
+        while (from <= list.size())
+        {
+            size_t comma = list.find(',', from);
+            if (comma == std::string::npos)
+                comma = list.size();
+            names.push_back(list.substr(from, comma - from));
+            from = comma + 1;
+        }
+    }
+    else
+    {
+        names.assign(ReplayAnalyzer::VISITOR_NAMES, ReplayAnalyzer::VISITOR_NAMES + ReplayAnalyzer::VISITOR_COUNT);
+    }
+
+    ReplayAnalyzer analyzer(threads);
+    for (const std::string &name : names)
+    {
+        std::unique_ptr<ReplayVisitor> visitor = ReplayAnalyzer::makeVisitor(name);
+        if (!visitor)
+        {
+            fprintf(stderr, "Unknown visitor: %s (outcomes, length, spawns, tempo)\n", name.c_str());
+            return 1;
+        }
+        analyzer.add(std::move(visitor));
+    }
+
+    std::string error;
+    if (!analyzer.run(argv[2], error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    const AnalysisReport &report = analyzer.getReport();
+    fprintf(stderr, "Analyzed %ld rounds (%ld ticks) on %d threads in %.2fs: %.0f rounds/s\n", report.rounds, report.ticks,
+            analyzer.getThreadCount(), report.seconds, report.rounds / std::max(report.seconds, 1e-9));
+    if (report.mismatched > 0)
+        fprintf(stderr, "Warning: %ld rounds did not replay as recorded\n", report.mismatched);
+    if (report.skipped > 0)
+        fprintf(stderr, "Skipped %ld rounds of more than two riders\n", report.skipped);
+
+    int failures = 0;
+    for (const auto &visitor : analyzer.getVisitors())
+    {
+        std::string path = std::string(argv[3]) + "." + visitor->name() + ".csv";
+        FILE *out = fopen(path.c_str(), "w");
+        bool written = out && visitor->writeCsv(out);
+        written = out && fclose(out) == 0 && written;
+        fprintf(stderr, "%s %s\n", written ? "Wrote" : "Cannot write", path.c_str());
+        failures += !written;
+    }
+    return failures != 0;
+}
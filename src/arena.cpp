@@ -0,0 +1,55 @@
+#include "../include/arena.h"
+#include <algorithm>
+
+MatchArena::MatchArena(int playerSlots, int botSlots)
+    : playersInUse(0), botsInUse(0), generation(0), width(0), height(0)
+{
+    players.reserve(playerSlots);
+    for (int i = 0; i < playerSlots; i++)
+        players.emplace_back(0, 0, Config::PLAYER_1_ID + i);
+
+    // The first bot plays a human in player 2's colours; a second one takes player 1's.
+    bots.reserve(botSlots);
+    for (int i = 0; i < botSlots; i++)
+        bots.emplace_back(0, 0, RIGHT, i == 0 ? Config::PLAYER_2_ID : Config::PLAYER_1_ID);
+}
+
+void MatchArena::reserve(int w, int h)
+{
+    if (w <= width && h <= height)
+        return;
+
+    width = std::max(w, width);
+    height = std::max(h, height);
+    for (auto &player : players)
+        player.reserveTrail(static_cast<size_t>(width) * height);
+    for (auto &bot : bots)
+        bot.reserve(width, height);
+}
+
+void MatchArena::reset()
+{
+    playersInUse = 0;
+    botsInUse = 0;
+    generation++;
+}
+
+Player *MatchArena::acquirePlayer(int x, int y, Direction dir)
+{
+    if (playersInUse >= static_cast<int>(players.size()))
+        return nullptr;
+
+    Player *player = &players[playersInUse++];
+    player->respawn(x, y, dir);
+    return player;
+}
+
+Bot *MatchArena::acquireBot(int x, int y, Direction dir)
+{
+    if (botsInUse >= static_cast<int>(bots.size()))
+        return nullptr;
+
+    Bot *bot = &bots[botsInUse++];
+    bot->respawn(x, y, dir);
+    return bot;
+}
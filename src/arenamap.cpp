@@ -0,0 +1,269 @@
+#include "../include/arenamap.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const char MAP_MAGIC[8] = {'T', 'R', 'O', 'N', 'M', 'A', 'P', 'S'};
+    const uint32_t MAP_VERSION = 1;
+
+    struct MapHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint16_t width;
+        uint16_t height;
+        uint32_t spawns;
+        uint32_t reserved;
+    };
+
+    struct PackedSpawn
+    {
+        uint16_t x;
+        uint16_t y;
+        uint8_t dir;
+        uint8_t reserved[3];
+    };
+
+    size_t wordsFor(int width, int height)
+    {
+        return (static_cast<size_t>(width) * height + 63) / 64;
+    }
+
+    bool spawnGlyph(char c, Direction &dir)
+    {
+        switch (c)
+        {
+        case '^':
+            dir = UP;
+            return true;
+        case 'v':
+            dir = DOWN;
+            return true;
+        case '<':
+            dir = LEFT;
+            return true;
+        case '>':
+            dir = RIGHT;
+            return true;
+        }
+        return false;
+    }
+}
+
+ArenaMap::ArenaMap() : width(0), height(0), interiorWalls(0) {}
+
+void ArenaMap::reset(int w, int h)
+{
+    width = w;
+    height = h;
+    walls.assign(wordsFor(w, h), 0);
+    spawns.clear();
+    interiorWalls = 0;
+}
+
+void ArenaMap::setWall(int x, int y)
+{
+    if (x <= 0 || y <= 0 || x >= width - 1 || y >= height - 1 || isWall(x, y))
+        return;
+    size_t bit = static_cast<size_t>(y) * width + x;
+    walls[bit >> 6] |= 1ULL << (bit & 63);
+    interiorWalls++;
+}
+
+void ArenaMap::addSpawn(int x, int y, Direction dir)
+{
+    spawns.push_back({x, y, dir});
+}
+
+bool ArenaMap::parseText(const std::string &text, std::string &error)
+{
+    std::vector<std::string> rows;
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] != ';')
+            rows.push_back(line);
+        start = end + 1;
+    }
+    while (!rows.empty() && rows.back().empty())
+        rows.pop_back();
+
+    size_t longest = 0;
+    for (const std::string &row : rows)
+        longest = row.size() > longest ? row.size() : longest;
+    int w = static_cast<int>(longest);
+    int h = static_cast<int>(rows.size());
+    if (w < Config::MAP_MIN_SIZE || h < Config::MAP_MIN_SIZE || w > Config::MAP_MAX_SIZE || h > Config::MAP_MAX_SIZE)
+    {
+        error = "map must be between " + std::to_string(Config::MAP_MIN_SIZE) + " and " + std::to_string(Config::MAP_MAX_SIZE) +
+                " cells on each side, not " + std::to_string(w) + "x" + std::to_string(h);
+        return false;
+    }
+
+    reset(w, h);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < static_cast<int>(rows[y].size()); x++)
+        {
+            char c = rows[y][x];
+            Direction dir;
+            if (c == '#')
+            {
+                setWall(x, y);
+            }
+            else if (spawnGlyph(c, dir))
+            {
+                addSpawn(x, y, dir);
+            }
+            else if (c != '.' && c != ' ')
+            {
+                error = "unknown cell '" + std::string(1, c) + "' at row " + std::to_string(y + 1) + ", column " + std::to_string(x + 1);
+                return false;
+            }
+        }
+    }
+
+    return checkSpawns(error);
+}
+
+// The outer ring counts as wall, so this also refuses spawns on the border.
+bool ArenaMap::checkSpawns(std::string &error) const
+{
+    for (const MapSpawn &spawn : spawns)
+    {
+        int aheadX = spawn.x + (spawn.dir == RIGHT) - (spawn.dir == LEFT);
+        int aheadY = spawn.y + (spawn.dir == DOWN) - (spawn.dir == UP);
+        if (isWall(spawn.x, spawn.y) || isWall(aheadX, aheadY))
+        {
+            error = "spawn at " + std::to_string(spawn.x) + "," + std::to_string(spawn.y) + " is on or facing a wall";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ArenaMap::unpack(const std::string &data, std::string &error)
+{
+    MapHeader header;
+    if (data.size() < sizeof(header))
+    {
+        error = "truncated map header";
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.version != MAP_VERSION || header.width < Config::MAP_MIN_SIZE || header.height < Config::MAP_MIN_SIZE ||
+        header.width > Config::MAP_MAX_SIZE || header.height > Config::MAP_MAX_SIZE)
+    {
+        error = "unsupported packed map";
+        return false;
+    }
+
+    size_t words = wordsFor(header.width, header.height);
+    size_t expected = sizeof(header) + header.spawns * sizeof(PackedSpawn) + words * sizeof(uint64_t);
+    if (data.size() != expected)
+    {
+        error = "packed map has the wrong size";
+        return false;
+    }
+
+    reset(header.width, header.height);
+    const char *cursor = data.data() + sizeof(header);
+    for (uint32_t i = 0; i < header.spawns; i++)
+    {
+        PackedSpawn spawn;
+        memcpy(&spawn, cursor, sizeof(spawn));
+        cursor += sizeof(spawn);
+        if (spawn.dir > RIGHT || spawn.x >= width || spawn.y >= height)
+        {
+            error = "packed map has a bad spawn";
+            return false;
+        }
+        addSpawn(spawn.x, spawn.y, static_cast<Direction>(spawn.dir));
+    }
+    memcpy(walls.data(), cursor, words * sizeof(uint64_t));
+
+    for (int y = 1; y < height - 1; y++)
+    {
+        for (int x = 1; x < width - 1; x++)
+            interiorWalls += isWall(x, y);
+    }
+    return checkSpawns(error);
+}
+
+bool ArenaMap::load(const std::string &path, std::string &error)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string data;
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.append(buffer, got);
+    fclose(file);
+
+    if (data.size() >= sizeof(MAP_MAGIC) && memcmp(data.data(), MAP_MAGIC, sizeof(MAP_MAGIC)) == 0)
+        return unpack(data, error);
+    return parseText(data, error);
+}
+
+bool ArenaMap::save(const std::string &path) const
+{
+    MapHeader header;
+    memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+    header.version = MAP_VERSION;
+    header.width = static_cast<uint16_t>(width);
+    header.height = static_cast<uint16_t>(height);
+    header.spawns = static_cast<uint32_t>(spawns.size());
+    header.reserved = 0;
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        perror(path.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const MapSpawn &spawn : spawns)
+    {
+        PackedSpawn packed = {static_cast<uint16_t>(spawn.x), static_cast<uint16_t>(spawn.y), static_cast<uint8_t>(spawn.dir), {0, 0, 0}};
+        ok = ok && fwrite(&packed, sizeof(packed), 1, file) == 1;
+    }
+    ok = ok && fwrite(walls.data(), sizeof(uint64_t), walls.size(), file) == walls.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+        fprintf(stderr, "Failed to write map to %s\n", path.c_str());
+    return ok;
+}
+
+std::string ArenaMap::toText() const
+{
+    static const char spawnGlyphs[] = {'^', 'v', '<', '>'};
+
+    std::string text;
+    text.reserve(static_cast<size_t>(width + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        size_t rowStart = text.size();
+        for (int x = 0; x < width; x++)
+            text += isWall(x, y) ? '#' : '.';
+        for (const MapSpawn &spawn : spawns)
+        {
+            if (spawn.y == y)
+                text[rowStart + spawn.x] = spawnGlyphs[spawn.dir];
+        }
+        text += '\n';
+    }
+    return text;
+}
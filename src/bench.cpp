@@ -0,0 +1,2256 @@
+#include "../include/bench.h"
+#include "../include/alloccount.h"
+#include "../include/bot.h"
+#include "../include/engine.h"
+#include "../include/game.h"
+#include "../include/menu.h"
+#include "../include/tuner.h"
+#include "../include/host.h"
+#include "../include/regions.h"
+#include "../include/arenamap.h"
+#include "../include/endgame.h"
+#include "../include/evaluator.h"
+#include "../include/nnue.h"
+#include "../include/search.h"
+#include "../include/searchpool.h"
+#include "../include/framebuffer.h"
+#include "../include/renderer.h"
+#include "../include/stats.h"
+#include "../include/replay.h"
+#include "../include/cast.h"
+#include "../include/pacer.h"
+#include "../include/snapshot.h"
+#include "../include/analysis.h"
+#include "../include/profiler.h"
+#include <ncurses.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    const int BENCH_WIDTH = 80;
+    const int BENCH_HEIGHT = 24;
+    const int BENCH_WARMUP_TICKS = 120;
+    const int BENCH_FRONTIER_RADIUS = 8;
+    const int BENCH_ITERATIONS = 2000;
+    const int RENDER_WIDTH = 160;
+    const int RENDER_HEIGHT = 48;
+    const int RENDER_TICKS = 600;
+    const int RENDER_FRAMES = 2000;
+    const int RENDER_TICK_FRAMES = 200000;
+    const int TICK_WIDTH = 160;
+    const int TICK_HEIGHT = 48;
+    const int TICK_GAMES = 2000;
+    const int TICK_CROWD_PLAYERS = 8;
+    const int TICK_CROWD_GAMES = 500;
+    const int GREEDY_TURN_ODDS = 12;
+    const uint64_t TICK_SEED = 0x7469636bULL;
+    const int ROUND_WIDTH = 40;
+    const int ROUND_HEIGHT = 20;
+    const int ROUND_COUNT = 3000;
+    const int ROUND_WARMUP = 50;
+    const int HOST_MATCHES_PER_THREAD = 64;
+    const double HOST_BENCH_SECONDS = 2.0;
+    const int REGION_GAMES = 40;
+    const int REGION_AUDIT_INTERVAL = 16;
+    const int ENDGAME_BOARD_SIZE = 9;
+    const int ENDGAME_POSITIONS = 300;
+    const int ENDGAME_WALL_ODDS = 4;
+    const int ENDGAME_MATCHES = 100;
+    const int MODE_WARMUP_TICKS = 300;
+    const int MODE_TICKS = 5000;
+    const int STATS_MATCHES = 5000;
+    const uint64_t STATS_SEED = 0x73746174ULL;
+    const char *const SNAPSHOT_DIR = "snapshots";
+    const int SNAPSHOT_WIDTH = 40;
+    const int SNAPSHOT_HEIGHT = 16;
+    const int SNAPSHOT_TICKS = 60;
+    const int SNAPSHOT_CROWD_PLAYERS = 4;
+    const int MAP_WALL_ODDS = 12;
+    const int MAP_BOT_ROUNDS = 200;
+    const int FADE_CHECK_GAMES = 200;
+    const int FADE_BOT_ROUNDS = 40;
+    const int NNUE_BENCH_TRAIN_GAMES = 60;
+    const int NNUE_CHECK_GAMES = 60;
+    const int NNUE_MATCHES = 100;
+    // The network weight the learned side plays at; the default weight leaves it off.
+    const int NNUE_BENCH_WEIGHT = 3;
+    const int SMP_POSITIONS = 8;
+    const long SMP_SEARCH_MICROS = 250000;
+    const long SMP_DETERMINISM_NODES = 20000;
+    const int SMP_MATCHES = 20;
+    const long SMP_MATCH_MICROS = 1000;
+    const int CAST_ROUNDS = 60;
+    const int CAST_EXPORTS = 5;
+    const long PACING_TICKS = 6000;
+    const double PACING_BUFFER_BYTES = 65536;
+    // Terminal links in bytes per second: 9600 and 19200 baud serial lines, a slow remote session, a local terminal.
+    const double PACING_LINKS[] = {960, 1920, 12000, 1e7};
+    const int SNAPSHOT_ROUNDS = 12;
+    const int SNAPSHOT_SAVE_TICK = 60;
+    // Fading trails can keep both bots alive indefinitely; compare this many ticks at most.
+    const int SNAPSHOT_MAX_TICKS = 3000;
+    // Bot budgets without a time limit, so both halves of a split match think alike.
+    const long SNAPSHOT_BOT_MICROS = 1000000000L;
+    const int ANALYZE_ROUNDS = 2000;
+
+    long outputSize(FILE *file)
+    {
+        fflush(file);
+        struct stat st;
+        return fstat(fileno(file), &st) == 0 ? static_cast<long>(st.st_size) : 0;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // A real ncurses screen that writes into a temporary file instead of a tty.
+    SCREEN *openHeadlessScreen(FILE *&output, int width, int height)
+    {
+        setlocale(LC_ALL, "");
+        output = tmpfile();
+        const char *term = getenv("TERM");
+        SCREEN *screen = output ? newterm(term && *term ? term : "xterm-256color", output, stdin) : nullptr;
+        if (screen)
+            resizeterm(height, width);
+        return screen;
+    }
+
+    void closeHeadlessScreen(SCREEN *screen, FILE *output)
+    {
+        endwin();
+        delscreen(screen);
+        fclose(output);
+    }
+
+    // Plays two bots against each other to get a realistic mid-game arena.
+    void playOpening(Bot &first, Bot &second, int width, int height, int ticks)
+    {
+        first.getPlayer()->initializeTrail();
+        second.getPlayer()->initializeTrail();
+
+        BotEvaluator occupancy;
+        for (int t = 0; t < ticks; t++)
+        {
+            first.update(*second.getPlayer(), width, height);
+            second.update(*first.getPlayer(), width, height);
+
+            Player *a = first.getPlayer();
+            Player *b = second.getPlayer();
+            occupancy.prepare(*a, *b, width, height);
+            if (!occupancy.isFree(a->getNextX(), a->getNextY()) || !occupancy.isFree(b->getNextX(), b->getNextY()))
+                break;
+
+            a->move();
+            b->move();
+        }
+    }
+
+    // Cheap deterministic rider: mostly straight, turns at random or when blocked.
+    class GreedyController
+    {
+    private:
+        Player *rider;
+        Rng rng;
+
+        bool isOpen(const Grid &occupied, Direction dir) const
+        {
+            int x = rider->getX() + (dir == RIGHT) - (dir == LEFT);
+            int y = rider->getY() + (dir == DOWN) - (dir == UP);
+            return occupied.isFree(x, y);
+        }
+
+    public:
+        GreedyController(Player &player, uint64_t seed) : rider(&player), rng(seed) {}
+
+        Player *player() const { return rider; }
+        bool handleKey(int) { return false; }
+        void respawn(int x, int y, Direction dir) { rider->respawn(x, y, dir); }
+
+        void think(const Grid &occupied)
+        {
+            Direction current = rider->getDirection();
+            bool wander = rng.range(0, GREEDY_TURN_ODDS - 1) == 0;
+            if (!wander && isOpen(occupied, current))
+                return;
+
+            Direction turns[2] = {LEFT, RIGHT};
+            if (current == LEFT || current == RIGHT)
+            {
+                turns[0] = UP;
+                turns[1] = DOWN;
+            }
+            int pick = rng.range(0, 1);
+            for (int k = 0; k < 2; k++)
+            {
+                Direction dir = turns[(pick + k) % 2];
+                if (isOpen(occupied, dir))
+                {
+                    rider->setDirection(dir);
+                    return;
+                }
+            }
+        }
+    };
+
+    void tickSpawns(Rng &rng, int count, int width, int height, std::pair<int, int> *spawns, Direction *dirs)
+    {
+        int first = rng.range(0, Config::NUM_SIDES - 1);
+        for (int i = 0; i < count; i++)
+        {
+            int side = (first + (i % 2) * 2 + i / 2) % Config::NUM_SIDES;
+            spawns[i] = Game::getPositionOnSide(side, rng.range(0, Game::getSideSpan(side, width, height) - 1), width, height);
+            dirs[i] = Game::getSafeDirection(side);
+        }
+    }
+
+    // The per-mode resolution Game used before the tick engine: linear trail scans.
+    bool legacyTrailHit(int x, int y, const Player &player)
+    {
+        const auto &trail = player.getTrail();
+        if (trail.size() <= Config::COLLISION_TRAIL_MIN_LENGTH)
+            return false;
+        for (size_t i = 0; i < trail.size() - Config::COLLISION_TRAIL_MIN_LENGTH; i++)
+        {
+            if (trail[i].x == x && trail[i].y == y)
+                return true;
+        }
+        return false;
+    }
+
+    TickResult legacyTick(GreedyController &first, GreedyController &second, Grid &occupied)
+    {
+        first.think(occupied);
+        second.think(occupied);
+
+        Player &a = *first.player();
+        Player &b = *second.player();
+        int ax = a.getNextX(), ay = a.getNextY();
+        int bx = b.getNextX(), by = b.getNextY();
+        bool aLoses = ax <= 0 || ax >= TICK_WIDTH - 1 || ay <= 0 || ay >= TICK_HEIGHT - 1 || legacyTrailHit(ax, ay, a) || legacyTrailHit(ax, ay, b);
+        bool bLoses = bx <= 0 || bx >= TICK_WIDTH - 1 || by <= 0 || by >= TICK_HEIGHT - 1 || legacyTrailHit(bx, by, b) || legacyTrailHit(bx, by, a);
+
+        if ((ax == bx && ay == by) || (aLoses && bLoses))
+            return {true, Config::WINNER_TIE};
+        if (aLoses)
+            return {true, Config::WINNER_PLAYER2};
+        if (bLoses)
+            return {true, Config::WINNER_PLAYER1};
+
+        a.move();
+        b.move();
+        occupied.set(ax, ay, Config::CELL_WALL);
+        occupied.set(bx, by, Config::CELL_WALL);
+        return {false, Config::WINNER_TIE};
+    }
+
+    struct TickRun
+    {
+        long ticks;
+        long checksum;
+        double seconds;
+    };
+
+    template <typename Engine>
+    TickRun runEngine(Engine &engine, int games, int count)
+    {
+        Rng spawner(TICK_SEED);
+        std::vector<std::pair<int, int>> spawns(count);
+        std::vector<Direction> dirs(count);
+        TickRun run = {0, 0, 0};
+
+        auto start = std::chrono::steady_clock::now();
+        for (int g = 0; g < games; g++)
+        {
+            tickSpawns(spawner, count, engine.getWidth(), engine.getHeight(), spawns.data(), dirs.data());
+            engine.respawn(spawns.data(), dirs.data());
+            for (int t = 0; t < engine.getWidth() * engine.getHeight(); t++)
+            {
+                TickResult result = engine.tick();
+                run.ticks++;
+                if (result.finished)
+                {
+                    run.checksum += result.winner * 7919 + t;
+                    break;
+                }
+            }
+        }
+        run.seconds = secondsSince(start);
+        return run;
+    }
+
+    int benchTick()
+    {
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+
+        TickRun legacy = {0, 0, 0};
+        {
+            GreedyController first(a, TICK_SEED + 1);
+            GreedyController second(b, TICK_SEED + 2);
+            Grid occupied(TICK_WIDTH, TICK_HEIGHT);
+            Rng spawner(TICK_SEED);
+            std::pair<int, int> spawns[2];
+            Direction dirs[2];
+
+            auto start = std::chrono::steady_clock::now();
+            for (int g = 0; g < TICK_GAMES; g++)
+            {
+                tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+                first.respawn(spawns[0].first, spawns[0].second, dirs[0]);
+                second.respawn(spawns[1].first, spawns[1].second, dirs[1]);
+                occupied.clear();
+                occupied.set(spawns[0].first, spawns[0].second, Config::CELL_WALL);
+                occupied.set(spawns[1].first, spawns[1].second, Config::CELL_WALL);
+                for (int t = 0; t < TICK_WIDTH * TICK_HEIGHT; t++)
+                {
+                    TickResult result = legacyTick(first, second, occupied);
+                    legacy.ticks++;
+                    if (result.finished)
+                    {
+                        legacy.checksum += result.winner * 7919 + t;
+                        break;
+                    }
+                }
+            }
+            legacy.seconds = secondsSince(start);
+        }
+
+        TickEngine<GreedyController, GreedyController> fixed(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                             GreedyController(b, TICK_SEED + 2));
+        TickRun fixedRun = runEngine(fixed, TICK_GAMES, 2);
+
+        CrowdEngine<GreedyController> crowd(TICK_WIDTH, TICK_HEIGHT, {GreedyController(a, TICK_SEED + 1), GreedyController(b, TICK_SEED + 2)});
+        TickRun crowdRun = runEngine(crowd, TICK_GAMES, 2);
+
+        std::vector<Player> riders;
+        std::vector<GreedyController> crowdControllers;
+        riders.reserve(TICK_CROWD_PLAYERS);
+        for (int i = 0; i < TICK_CROWD_PLAYERS; i++)
+        {
+            riders.emplace_back(0, 0, i + 1);
+            crowdControllers.emplace_back(riders.back(), TICK_SEED + 1 + i);
+        }
+        CrowdEngine<GreedyController> large(TICK_WIDTH, TICK_HEIGHT, crowdControllers);
+        TickRun largeRun = runEngine(large, TICK_CROWD_GAMES, TICK_CROWD_PLAYERS);
+
+        printf("tick: %d games of 2 riders on %dx%d, %ld ticks\n", TICK_GAMES, TICK_WIDTH, TICK_HEIGHT, fixedRun.ticks);
+        printf("  legacy scans:   %12.0f ticks/s\n", legacy.ticks / legacy.seconds);
+        printf("  fixed engine:   %12.0f ticks/s (%.2fx)\n", fixedRun.ticks / fixedRun.seconds, legacy.seconds / fixedRun.seconds);
+        printf("  runtime engine: %12.0f ticks/s (%.2fx)\n", crowdRun.ticks / crowdRun.seconds, legacy.seconds / crowdRun.seconds);
+        printf("  %d riders:      %12.0f ticks/s over %ld ticks\n", TICK_CROWD_PLAYERS, largeRun.ticks / largeRun.seconds, largeRun.ticks);
+
+        // Legacy scans skipped the last two cells of every trail, so a rider could drive
+        // into the other's head; only game lengths are comparable with the old path.
+        if (fixedRun.checksum != crowdRun.checksum || legacy.ticks != fixedRun.ticks || crowdRun.ticks != fixedRun.ticks)
+        {
+            fprintf(stderr, "tick: engine outcomes differ\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    // Builds every bot and the engine from scratch, as each round did before match slots were pooled.
+    int playFreshRound(const TunerSettings &settings, uint64_t seed)
+    {
+        Rng rng(seed);
+        int width = settings.width;
+        int height = settings.height;
+
+        int side1 = rng.range(0, Config::NUM_SIDES - 1);
+        int side2 = (side1 + 2) % Config::NUM_SIDES;
+        auto pos1 = Game::getPositionOnSide(side1, rng.range(0, Game::getSideSpan(side1, width, height) - 1), width, height);
+        auto pos2 = Game::getPositionOnSide(side2, rng.range(0, Game::getSideSpan(side2, width, height) - 1), width, height);
+
+        BotBudget budget = {settings.nodes, 3600L * 1000 * 1000, 0};
+        budget.search = false;
+        Bot bot1(pos1.first, pos1.second, Game::getSafeDirection(side1));
+        Bot bot2(pos2.first, pos2.second, Game::getSafeDirection(side2));
+        bot1.setBudget(budget);
+        bot2.setBudget(budget);
+        bot1.getPlayer()->initializeTrail();
+        bot2.getPlayer()->initializeTrail();
+
+        TickEngine<BotController, BotController> engine(width, height, BotController(bot1, *bot2.getPlayer(), width, height),
+                                                        BotController(bot2, *bot1.getPlayer(), width, height));
+        for (int tick = 0; tick < width * height; tick++)
+        {
+            TickResult result = engine.tick();
+            if (result.finished)
+                return result.winner == Config::WINNER_PLAYER1 ? 1 : result.winner == Config::WINNER_PLAYER2 ? -1 : 0;
+        }
+        return 0;
+    }
+
+    int benchRounds()
+    {
+        TunerSettings settings;
+        settings.width = ROUND_WIDTH;
+        settings.height = ROUND_HEIGHT;
+        settings.nodes = Config::BOT_EASY_NODES;
+        BotWeights weights;
+
+        long freshScore = 0;
+        long allocations = AllocationCounter::count();
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUND_COUNT; r++)
+            freshScore += (r + 1) * playFreshRound(settings, TICK_SEED + r);
+        double freshSeconds = secondsSince(start);
+        long freshAllocations = AllocationCounter::count() - allocations;
+
+        SelfPlayTable table(settings);
+        for (int r = 0; r < ROUND_WARMUP; r++)
+            table.play(weights, weights, TICK_SEED + r);
+
+        long pooledScore = 0;
+        allocations = AllocationCounter::count();
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUND_COUNT; r++)
+            pooledScore += (r + 1) * table.play(weights, weights, TICK_SEED + r);
+        double pooledSeconds = secondsSince(start);
+        long pooledAllocations = AllocationCounter::count() - allocations;
+
+        printf("rounds: %d bot-vs-bot rounds on %dx%d\n", ROUND_COUNT, ROUND_WIDTH, ROUND_HEIGHT);
+        printf("  fresh objects: %10.0f rounds/s\n", ROUND_COUNT / freshSeconds);
+        printf("  match slots:   %10.0f rounds/s (%.2fx)\n", ROUND_COUNT / pooledSeconds, freshSeconds / pooledSeconds);
+        if (AllocationCounter::isEnabled())
+        {
+            printf("  allocations:   %10.2f/round fresh, %ld in %d pooled rounds\n",
+                   static_cast<double>(freshAllocations) / ROUND_COUNT, pooledAllocations, ROUND_COUNT);
+        }
+        else
+        {
+            printf("  allocations:   not counted (build with make alloccheck)\n");
+        }
+
+        if (freshScore != pooledScore)
+        {
+            fprintf(stderr, "rounds: pooled and fresh rounds disagree\n");
+            return 1;
+        }
+        if (AllocationCounter::isEnabled() && pooledAllocations != 0)
+        {
+            fprintf(stderr, "rounds: %ld heap allocations in steady-state rounds\n", pooledAllocations);
+            return 1;
+        }
+        return 0;
+    }
+
+    int benchHost()
+    {
+        int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> threadCounts;
+        for (int t = 1; t < cores; t *= 2)
+            threadCounts.push_back(t);
+        threadCounts.push_back(cores);
+
+        printf("host: unthrottled matches, %d per thread, %.1fs per run, %d cores\n", HOST_MATCHES_PER_THREAD, HOST_BENCH_SECONDS, cores);
+        double single = 0;
+        for (int threads : threadCounts)
+        {
+            HostSettings settings;
+            settings.matches = threads * HOST_MATCHES_PER_THREAD;
+            settings.threads = threads;
+            settings.seconds = HOST_BENCH_SECONDS;
+            settings.unthrottled = true;
+
+            MatchHost host(settings);
+            host.run();
+            LatencyStats total = host.aggregate();
+            double perThread = total.ticks / host.getElapsedSeconds() / threads;
+            if (single == 0)
+                single = perThread;
+            printf("  %3d threads: %10.0f ticks/s  %9.0f ticks/s/thread  %5.1f%% scaling  p99 %ld us\n", threads,
+                   perThread * threads, perThread, 100.0 * perThread / single, total.percentile(0.99));
+        }
+        return 0;
+    }
+
+    int floodSize(const Grid &grid, int startX, int startY, std::vector<uint32_t> &visited, uint32_t stamp, std::vector<int> &queue)
+    {
+        int width = grid.getWidth();
+        const std::vector<uint8_t> &cells = grid.getCells();
+        int head = 0, tail = 0;
+        queue[tail++] = startY * width + startX;
+        visited[queue[0]] = stamp;
+        while (head < tail)
+        {
+            int cell = queue[head++];
+            const int neighbours[] = {cell - width, cell + width, cell - 1, cell + 1};
+            for (int next : neighbours)
+            {
+                if (visited[next] != stamp && cells[next] == Config::CELL_EMPTY)
+                {
+                    visited[next] = stamp;
+                    queue[tail++] = next;
+                }
+            }
+        }
+        return tail;
+    }
+
+    int benchRegions()
+    {
+        MatchArena arena(0, 2);
+        arena.reserve(RENDER_WIDTH, RENDER_HEIGHT);
+        Bot &first = *arena.acquireBot(0, 0, RIGHT);
+        Bot &second = *arena.acquireBot(0, 0, LEFT);
+        first.seedNoise(TICK_SEED);
+        second.seedNoise(TICK_SEED + 1);
+        TickEngine<BotController, BotController> engine(RENDER_WIDTH, RENDER_HEIGHT, BotController(first, *second.getPlayer(), RENDER_WIDTH, RENDER_HEIGHT),
+                                                        BotController(second, *first.getPlayer(), RENDER_WIDTH, RENDER_HEIGHT));
+
+        Grid grid(RENDER_WIDTH, RENDER_HEIGHT);
+        RegionMap regions, audit;
+        regions.reserve(RENDER_WIDTH, RENDER_HEIGHT);
+        audit.reserve(RENDER_WIDTH, RENDER_HEIGHT);
+        std::vector<uint32_t> visited(grid.getCells().size(), 0);
+        std::vector<int> queue(grid.getCells().size());
+        uint32_t stamp = 0;
+
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        long ticks = 0, incrementalWork = 0, floodWork = 0, mismatches = 0;
+        double incrementalSeconds = 0, floodSeconds = 0;
+
+        for (int g = 0; g < REGION_GAMES; g++)
+        {
+            tickSpawns(spawner, 2, RENDER_WIDTH, RENDER_HEIGHT, spawns, dirs);
+            engine.respawn(spawns, dirs);
+            grid.clear();
+            for (int p = 0; p < 2; p++)
+                grid.set(spawns[p].first, spawns[p].second, Config::CELL_WALL);
+            regions.rebuild(grid);
+            regions.takeWork();
+
+            while (!engine.tick().finished)
+            {
+                ticks++;
+                auto start = std::chrono::steady_clock::now();
+                for (int p = 0; p < 2; p++)
+                {
+                    const Player &rider = *engine.getPlayer(p);
+                    grid.set(rider.getX(), rider.getY(), Config::CELL_WALL);
+                    regions.fill(rider.getX(), rider.getY());
+                }
+                incrementalSeconds += secondsSince(start);
+                incrementalWork += regions.takeWork();
+
+                // What the bots did before: a flood from every free neighbour of both heads.
+                start = std::chrono::steady_clock::now();
+                for (int p = 0; p < 2; p++)
+                {
+                    const Player &rider = *engine.getPlayer(p);
+                    for (int d = 0; d < 4; d++)
+                    {
+                        int x = rider.getX() + (d == RIGHT) - (d == LEFT);
+                        int y = rider.getY() + (d == DOWN) - (d == UP);
+                        if (!grid.isFree(x, y))
+                            continue;
+                        int size = floodSize(grid, x, y, visited, ++stamp, queue);
+                        floodWork += size;
+                        mismatches += size != regions.sizeAt(x, y);
+                    }
+                }
+                floodSeconds += secondsSince(start);
+
+                if (ticks % REGION_AUDIT_INTERVAL == 0)
+                {
+                    audit.rebuild(grid);
+                    for (int y = 1; y < RENDER_HEIGHT - 1; y++)
+                    {
+                        for (int x = 1; x < RENDER_WIDTH - 1; x++)
+                        {
+                            if (grid.isFree(x, y))
+                                mismatches += audit.sizeAt(x, y) != regions.sizeAt(x, y);
+                        }
+                    }
+                }
+            }
+        }
+
+        printf("regions: %d bot games on %dx%d, %ld ticks\n", REGION_GAMES, RENDER_WIDTH, RENDER_HEIGHT, ticks);
+        printf("  incremental labels: %8.0f ns/tick  %8.1f cells/tick\n", incrementalSeconds * 1e9 / ticks, static_cast<double>(incrementalWork) / ticks);
+        printf("  flood per move:     %8.0f ns/tick  %8.1f cells/tick\n", floodSeconds * 1e9 / ticks, static_cast<double>(floodWork) / ticks);
+        if (mismatches != 0)
+        {
+            fprintf(stderr, "regions: %ld region sizes disagree with a full flood\n", mismatches);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Plain exhaustive longest path, the reference for the endgame solver.
+    int exhaustiveLongest(std::vector<uint8_t> &cells, int width, int head, long &nodes)
+    {
+        nodes++;
+        int best = 0;
+        const int neighbours[] = {head - width, head + width, head - 1, head + 1};
+        for (int next : neighbours)
+        {
+            if (cells[next] != Config::CELL_EMPTY)
+                continue;
+            cells[next] = Config::CELL_SELF;
+            best = std::max(best, 1 + exhaustiveLongest(cells, width, next, nodes));
+            cells[next] = Config::CELL_EMPTY;
+        }
+        return best;
+    }
+
+    // Plays one round between two arena bots that configure(tested, baseline) sets up; the
+    // tested bot rides first when firstTested is set. Returns +1 when the tested bot wins,
+    // -1 when it loses and 0 for a tie.
+    template <typename Configure>
+    int playHeadToHead(MatchArena &arena, Rng &spawner, bool firstTested, Configure configure)
+    {
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        tickSpawns(spawner, 2, BENCH_WIDTH, BENCH_HEIGHT, spawns, dirs);
+
+        arena.reset();
+        Bot &first = *arena.acquireBot(spawns[0].first, spawns[0].second, dirs[0]);
+        Bot &second = *arena.acquireBot(spawns[1].first, spawns[1].second, dirs[1]);
+        configure(firstTested ? first : second, firstTested ? second : first);
+
+        TickEngine<BotController, BotController> engine(BENCH_WIDTH, BENCH_HEIGHT, BotController(first, *second.getPlayer(), BENCH_WIDTH, BENCH_HEIGHT),
+                                                        BotController(second, *first.getPlayer(), BENCH_WIDTH, BENCH_HEIGHT));
+        engine.reset();
+        while (!engine.tick().finished)
+        {
+        }
+        if (engine.isAlive(0) == engine.isAlive(1))
+            return 0;
+        return engine.isAlive(0) == firstTested ? 1 : -1;
+    }
+
+    int benchEndgame()
+    {
+        EndgameSolver solver;
+        RegionMap regions;
+        Grid grid(ENDGAME_BOARD_SIZE, ENDGAME_BOARD_SIZE);
+        Rng rng(TICK_SEED);
+        std::vector<uint8_t> cells;
+        long solverNodes = 0, exhaustiveNodes = 0, mismatches = 0;
+        auto never = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+        for (int p = 0; p < ENDGAME_POSITIONS; p++)
+        {
+            grid.clear();
+            for (int y = 1; y < ENDGAME_BOARD_SIZE - 1; y++)
+            {
+                for (int x = 1; x < ENDGAME_BOARD_SIZE - 1; x++)
+                {
+                    if (rng.range(0, ENDGAME_WALL_ODDS - 1) == 0)
+                        grid.set(x, y, Config::CELL_WALL);
+                }
+            }
+            int headX = rng.range(1, ENDGAME_BOARD_SIZE - 2);
+            int headY = rng.range(1, ENDGAME_BOARD_SIZE - 2);
+            grid.set(headX, headY, Config::CELL_SELF);
+
+            regions.rebuild(grid);
+            solver.bestMove(grid, regions, headX, headY, UP, Config::SEARCH_WIN_SCORE * 1000L, never);
+            solverNodes += solver.getNodes();
+
+            cells = grid.getCells();
+            int longest = exhaustiveLongest(cells, ENDGAME_BOARD_SIZE, headY * ENDGAME_BOARD_SIZE + headX, exhaustiveNodes);
+            mismatches += !solver.isExact() || solver.getLength() != longest;
+        }
+
+        printf("endgame: %d positions on %dx%d checked against exhaustive search\n", ENDGAME_POSITIONS, ENDGAME_BOARD_SIZE, ENDGAME_BOARD_SIZE);
+        printf("  solver:      %10.1f nodes/position\n", static_cast<double>(solverNodes) / ENDGAME_POSITIONS);
+        printf("  exhaustive:  %10.1f nodes/position\n", static_cast<double>(exhaustiveNodes) / ENDGAME_POSITIONS);
+
+        MatchArena arena(0, 2);
+        arena.reserve(BENCH_WIDTH, BENCH_HEIGHT);
+        for (BotDifficulty level : {BOT_NORMAL, BOT_HARD})
+        {
+            int results[3] = {0, 0, 0};
+            BotBudget solving = Bot::budgetFor(level);
+            BotBudget heuristic = solving;
+            solving.endgame = true;
+            heuristic.endgame = false;
+            auto configure = [&](Bot &tested, Bot &baseline)
+            {
+                tested.setBudget(solving);
+                baseline.setBudget(heuristic);
+            };
+            for (int m = 0; m < ENDGAME_MATCHES; m++)
+                results[playHeadToHead(arena, rng, m % 2 == 0, configure) + 1]++;
+            printf("  %-6s solver vs heuristic on %dx%d: %d wins  %d losses  %d ties\n", Bot::difficultyName(level), BENCH_WIDTH, BENCH_HEIGHT,
+                   results[2], results[0], results[1]);
+        }
+
+        if (mismatches != 0)
+        {
+            fprintf(stderr, "endgame: %ld positions where the solver missed the longest path\n", mismatches);
+            return 1;
+        }
+        return 0;
+    }
+
+    int benchEval()
+    {
+        Bot first(Config::SPAWN_MARGIN, BENCH_HEIGHT / 2, RIGHT);
+        Bot second(BENCH_WIDTH - Config::SPAWN_MARGIN, BENCH_HEIGHT / 2, LEFT);
+        playOpening(first, second, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WARMUP_TICKS);
+
+        const Player &self = *first.getPlayer();
+        const Player &opponent = *second.getPlayer();
+        BotBudget budget = Bot::budgetFor(BOT_NORMAL);
+        BotWeights weights;
+        long maxNodes = budget.maxNodes / 4;
+        auto noDeadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+        BotEvaluator evaluator;
+        evaluator.prepare(self, opponent, BENCH_WIDTH, BENCH_HEIGHT);
+
+        CandidateBatch frontier;
+        for (int y = self.getY() - BENCH_FRONTIER_RADIUS; y <= self.getY() + BENCH_FRONTIER_RADIUS; y++)
+        {
+            for (int x = self.getX() - BENCH_FRONTIER_RADIUS; x <= self.getX() + BENCH_FRONTIER_RADIUS; x++)
+            {
+                if (abs(x - self.getX()) + abs(y - self.getY()) > BENCH_FRONTIER_RADIUS || !evaluator.isFree(x, y))
+                    continue;
+                for (int d = 0; d < 4; d++)
+                    frontier.add(x, y, static_cast<Direction>(d));
+            }
+        }
+
+        const size_t n = frontier.size();
+        if (n == 0)
+        {
+            fprintf(stderr, "eval: no free frontier cells\n");
+            return 1;
+        }
+
+        CandidateBatch single;
+        long checksumSingle = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < BENCH_ITERATIONS; it++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                single.clear();
+                single.add(frontier.x[i], frontier.y[i], static_cast<Direction>(frontier.dir[i]));
+                evaluator.prepare(self, opponent, BENCH_WIDTH, BENCH_HEIGHT);
+                evaluator.evaluate(single, weights, self.getDirection(), opponent.getX(), opponent.getY(), maxNodes, noDeadline);
+                checksumSingle += single.space[0];
+            }
+        }
+        double singleSeconds = secondsSince(start);
+
+        long checksumBatch = 0;
+        start = std::chrono::steady_clock::now();
+        for (int it = 0; it < BENCH_ITERATIONS; it++)
+        {
+            evaluator.prepare(self, opponent, BENCH_WIDTH, BENCH_HEIGHT);
+            evaluator.evaluate(frontier, weights, self.getDirection(), opponent.getX(), opponent.getY(), maxNodes, noDeadline);
+            for (size_t i = 0; i < n; i++)
+                checksumBatch += frontier.space[i];
+        }
+        double batchSeconds = secondsSince(start);
+
+        double positions = static_cast<double>(n) * BENCH_ITERATIONS;
+        printf("eval: %zu candidates per batch, %d iterations\n", n, BENCH_ITERATIONS);
+        printf("  per-position: %12.0f positions/s\n", positions / singleSeconds);
+        printf("  batched:      %12.0f positions/s (%.2fx)\n", positions / batchSeconds, singleSeconds / batchSeconds);
+        if (checksumSingle != checksumBatch)
+        {
+            fprintf(stderr, "eval: batch and per-position results differ\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    // Each game mode's full tick (keys, simulation, bot, drawing, flush) from a scripted match.
+    int benchModes()
+    {
+        FILE *output = nullptr;
+        SCREEN *screen = openHeadlessScreen(output, BENCH_WIDTH, BENCH_HEIGHT);
+        if (!screen)
+        {
+            fprintf(stderr, "modes: cannot create a headless ncurses screen\n");
+            return 1;
+        }
+
+        // Arrows steer the first rider and WASD the second, with idle ticks in between.
+        const std::vector<int> keys = {ERR, KEY_UP, ERR, 'd', ERR, KEY_LEFT, 's', ERR, ERR, KEY_DOWN, 'a', ERR, KEY_RIGHT, 'w', ERR};
+        const GameMode modes[] = {SINGLE_PLAYER, TWO_PLAYER, VS_BOT, BOT_BATTLE};
+        const char *const names[] = {"single player", "two player", "vs bot", "bot battle"};
+
+        printf("modes: %d scripted ticks per mode after %d warm-up ticks on %dx%d\n", MODE_TICKS, MODE_WARMUP_TICKS, BENCH_WIDTH, BENCH_HEIGHT);
+        int failures = 0;
+        for (int m = 0; m < 4; m++)
+        {
+            Game game(BENCH_WIDTH, BENCH_HEIGHT);
+            game.setGameMode(modes[m]);
+            auto start = std::chrono::steady_clock::now();
+            long allocations = game.playScripted(keys, MODE_WARMUP_TICKS, MODE_TICKS);
+            double seconds = secondsSince(start);
+
+            printf("  %-14s %8.0f ns/tick", names[m], seconds * 1e9 / (MODE_WARMUP_TICKS + MODE_TICKS));
+            if (AllocationCounter::isEnabled())
+            {
+                printf("  %ld allocations after warm-up", allocations);
+                failures += allocations != 0;
+            }
+            printf("\n");
+        }
+        closeHeadlessScreen(screen, output);
+
+        if (failures != 0)
+        {
+            fprintf(stderr, "modes: %d game modes allocate on the tick path\n", failures);
+            return 1;
+        }
+        return 0;
+    }
+
+    int benchStats()
+    {
+        StatsStore &store = StatsStore::instance();
+        std::string previous = store.getPath();
+        std::string path = "/tmp/tron-bench-" + std::to_string(getpid()) + ".stats";
+        unlink(path.c_str());
+        store.setPath(path);
+
+        ModeTotals expected[Config::NUM_GAME_MODES];
+        ModeTotals expectedBots[Config::NUM_BOT_DIFFICULTIES];
+        Rng rng(STATS_SEED);
+        int failures = 0;
+
+        // Background compaction would shrink the log under the timings below.
+        store.setAutoCompact(false);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < STATS_MATCHES; i++)
+        {
+            GameMode mode = static_cast<GameMode>(rng.range(0, Config::NUM_GAME_MODES - 1));
+            BotDifficulty level = static_cast<BotDifficulty>(rng.range(0, Config::NUM_BOT_DIFFICULTIES - 1));
+            int winner = rng.range(Config::WINNER_TIE, Config::WINNER_PLAYER2);
+            int seconds = rng.range(1, 300);
+            failures += !store.record(mode, level, winner, seconds);
+
+            for (ModeTotals *totals : {&expected[mode], mode == VS_BOT ? &expectedBots[level] : nullptr})
+            {
+                if (!totals)
+                    continue;
+                totals->matches++;
+                totals->wins += winner == Config::WINNER_PLAYER1;
+                totals->losses += winner == Config::WINNER_PLAYER2;
+                totals->ties += winner == Config::WINNER_TIE;
+                totals->bestSeconds = std::max(totals->bestSeconds, seconds);
+            }
+        }
+        double appendSeconds = secondsSince(start);
+
+        auto matches = [&](const StatsIndex &stats)
+        {
+            auto same = [](const ModeTotals &a, const ModeTotals &b)
+            { return a.matches == b.matches && a.wins == b.wins && a.losses == b.losses && a.ties == b.ties && a.bestSeconds == b.bestSeconds; };
+            bool ok = stats.recent.size() == static_cast<size_t>(Config::STATS_RECENT_MATCHES);
+            for (int m = 0; m < Config::NUM_GAME_MODES; m++)
+                ok = ok && same(stats.modes[m], expected[m]);
+            for (int d = 0; d < Config::NUM_BOT_DIFFICULTIES; d++)
+                ok = ok && same(stats.bots[d], expectedBots[d]);
+            return ok;
+        };
+
+        store.setPath(path);
+        start = std::chrono::steady_clock::now();
+        failures += !matches(store.snapshot());
+        double coldSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        failures += !matches(store.snapshot());
+        double warmSeconds = secondsSince(start);
+
+        struct stat before;
+        stat(path.c_str(), &before);
+        start = std::chrono::steady_clock::now();
+        failures += !store.compact();
+        double compactSeconds = secondsSince(start);
+        struct stat after;
+        stat(path.c_str(), &after);
+        failures += !matches(store.snapshot());
+
+        store.setAutoCompact(true);
+        store.setPath(previous);
+        unlink(path.c_str());
+
+        printf("stats: %d matches\n", STATS_MATCHES);
+        printf("  append:      %8.1f us/match\n", appendSeconds * 1e6 / STATS_MATCHES);
+        printf("  cold index:  %8.1f us (%ld byte log)\n", coldSeconds * 1e6, static_cast<long>(before.st_size));
+        printf("  warm index:  %8.1f us\n", warmSeconds * 1e6);
+        printf("  compaction:  %8.1f us (%ld -> %ld bytes)\n", compactSeconds * 1e6, static_cast<long>(before.st_size),
+               static_cast<long>(after.st_size));
+
+        if (failures != 0)
+        {
+            fprintf(stderr, "stats: %d checks failed\n", failures);
+            return 1;
+        }
+        return 0;
+    }
+
+    void drawArena(FrameBuffer &frame, int width, int height)
+    {
+        frame.print(0, 0, Config::COLOR_BORDERS, "╔");
+        frame.print(width - 1, 0, Config::COLOR_BORDERS, "╗");
+        frame.print(0, height - 1, Config::COLOR_BORDERS, "╚");
+        frame.print(width - 1, height - 1, Config::COLOR_BORDERS, "╝");
+        for (int x = 1; x < width - 1; x++)
+        {
+            frame.print(x, 0, Config::COLOR_BORDERS, "═");
+            frame.print(x, height - 1, Config::COLOR_BORDERS, "═");
+        }
+        for (int y = 1; y < height - 1; y++)
+        {
+            frame.print(0, y, Config::COLOR_BORDERS, "║");
+            frame.print(width - 1, y, Config::COLOR_BORDERS, "║");
+        }
+    }
+
+    // Scattered pillars with the spawn rows kept clear, like an authored map file.
+    void scatterMap(ArenaMap &map, int width, int height, uint64_t seed)
+    {
+        Rng rng(seed);
+        map.reset(width, height);
+        for (int y = 1; y < height - 1; y++)
+        {
+            for (int x = 1; x < width - 1; x++)
+            {
+                if (y != height / 2 && rng.range(0, MAP_WALL_ODDS - 1) == 0)
+                    map.setWall(x, y);
+            }
+        }
+        map.addSpawn(Config::SPAWN_MARGIN, height / 2, RIGHT);
+        map.addSpawn(width - 1 - Config::SPAWN_MARGIN, height / 2, LEFT);
+    }
+
+    // Plays rounds from the map spawns; counts riders that end up on a wall, and
+    // riders that crash into one while an open cell was next to them.
+    template <typename Engine>
+    TickRun runOnMap(Engine &engine, const ArenaMap &map, int rounds, long &onWall, long &blind)
+    {
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        for (int i = 0; i < 2; i++)
+        {
+            spawns[i] = {map.getSpawns()[i].x, map.getSpawns()[i].y};
+            dirs[i] = map.getSpawns()[i].dir;
+        }
+
+        TickRun run = {0, 0, 0};
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++)
+        {
+            engine.respawn(spawns, dirs);
+            for (int t = 0; t < engine.getWidth() * engine.getHeight(); t++)
+            {
+                TickResult result = engine.tick();
+                run.ticks++;
+                for (int i = 0; i < engine.getPlayerCount(); i++)
+                {
+                    const Player &rider = *engine.getPlayer(i);
+                    if (engine.isAlive(i) && map.isWall(rider.getX(), rider.getY()))
+                        onWall++;
+                    if (result.finished && !engine.isAlive(i) && map.isWall(rider.getNextX(), rider.getNextY()))
+                    {
+                        const Grid &grid = engine.getGrid();
+                        blind += grid.isFree(rider.getX() + 1, rider.getY()) || grid.isFree(rider.getX() - 1, rider.getY()) ||
+                                 grid.isFree(rider.getX(), rider.getY() + 1) || grid.isFree(rider.getX(), rider.getY() - 1);
+                    }
+                }
+                if (result.finished)
+                {
+                    run.checksum += result.winner * 7919 + t;
+                    break;
+                }
+            }
+        }
+        run.seconds = secondsSince(start);
+        return run;
+    }
+
+    int benchMaps()
+    {
+        int failures = 0;
+        ArenaMap map;
+        scatterMap(map, TICK_WIDTH, TICK_HEIGHT, TICK_SEED);
+
+        // Text and packed forms both load back to the same map.
+        std::string base = "/tmp/tron-bench-" + std::to_string(getpid());
+        std::string textPath = base + ".txt", packedPath = base + ".map";
+        FILE *file = fopen(textPath.c_str(), "w");
+        if (file)
+        {
+            fputs(map.toText().c_str(), file);
+            fclose(file);
+        }
+        ArenaMap fromText, fromPacked;
+        std::string error;
+        bool textOk = fromText.load(textPath, error) && fromText.toText() == map.toText();
+        bool packedOk = map.save(packedPath) && fromPacked.load(packedPath, error) && fromPacked.toText() == map.toText();
+        struct stat textStat, packedStat;
+        stat(textPath.c_str(), &textStat);
+        stat(packedPath.c_str(), &packedStat);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_ITERATIONS; i++)
+            fromPacked.load(packedPath, error);
+        double packedLoad = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_ITERATIONS; i++)
+            fromText.load(textPath, error);
+        double textLoad = secondsSince(start);
+        unlink(textPath.c_str());
+        unlink(packedPath.c_str());
+        failures += !textOk + !packedOk;
+
+        ArenaMap open;
+        open.reset(TICK_WIDTH, TICK_HEIGHT);
+        open.addSpawn(Config::SPAWN_MARGIN, TICK_HEIGHT / 2, RIGHT);
+        open.addSpawn(TICK_WIDTH - 1 - Config::SPAWN_MARGIN, TICK_HEIGHT / 2, LEFT);
+
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+        long onWall = 0, blind = 0;
+        TickEngine<GreedyController, GreedyController> empty(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                             GreedyController(b, TICK_SEED + 2));
+        TickRun emptyRun = runOnMap(empty, open, TICK_GAMES, onWall, blind);
+        TickEngine<GreedyController, GreedyController> walled(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                              GreedyController(b, TICK_SEED + 2));
+        walled.setObstacles(map);
+        TickRun walledRun = runOnMap(walled, map, TICK_GAMES, onWall, blind);
+        long greedyBlind = blind;
+        blind = 0;
+
+        Bot first(0, 0, RIGHT);
+        Bot second(0, 0, LEFT);
+        for (Bot *bot : {&first, &second})
+        {
+            bot->setDifficulty(BOT_NORMAL);
+            bot->setMap(&map);
+            bot->seedNoise(TICK_SEED);
+        }
+        TickEngine<BotController, BotController> bots(TICK_WIDTH, TICK_HEIGHT, BotController(first, *second.getPlayer(), TICK_WIDTH, TICK_HEIGHT),
+                                                      BotController(second, *first.getPlayer(), TICK_WIDTH, TICK_HEIGHT));
+        bots.setObstacles(map);
+        TickRun botRun = runOnMap(bots, map, MAP_BOT_ROUNDS, onWall, blind);
+        failures += onWall != 0 || blind != 0;
+
+        printf("maps: %dx%d with %d walls (1 in %d interior cells)\n", TICK_WIDTH, TICK_HEIGHT, map.getInteriorWalls(), MAP_WALL_ODDS);
+        printf("  text:    %6ld bytes  %8.1f us/load  %s\n", static_cast<long>(textStat.st_size), textLoad * 1e6 / BENCH_ITERATIONS,
+               textOk ? "round trip ok" : "ROUND TRIP FAILED");
+        printf("  packed:  %6ld bytes  %8.1f us/load  %s\n", static_cast<long>(packedStat.st_size), packedLoad * 1e6 / BENCH_ITERATIONS,
+               packedOk ? "round trip ok" : "ROUND TRIP FAILED");
+        printf("  greedy ticks, open arena:   %12.0f ticks/s\n", emptyRun.ticks / emptyRun.seconds);
+        printf("  greedy ticks, with walls:   %12.0f ticks/s (%ld crashes into walls with room to turn)\n", walledRun.ticks / walledRun.seconds,
+               greedyBlind);
+        printf("  bot rounds, with walls:     %12.0f rounds/s (%ld ticks, %ld crashes into walls with room to turn)\n",
+               MAP_BOT_ROUNDS / botRun.seconds, botRun.ticks, blind);
+
+        if (failures != 0)
+        {
+            fprintf(stderr, "maps: round trip failed, or %ld riders on walls and %ld bots crashed into walls they could avoid\n", onWall, blind);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Rebuilds the occupancy a tick engine should hold from the trails alone.
+    template <typename Engine>
+    bool occupancyMatches(const Engine &engine, Grid &expected)
+    {
+        expected.clear();
+        for (int i = 0; i < engine.getPlayerCount(); i++)
+        {
+            for (const auto &segment : engine.getPlayer(i)->getTrail())
+                expected.set(segment.x, segment.y, Config::CELL_WALL);
+        }
+        return expected.getCells() == engine.getGrid().getCells();
+    }
+
+    int benchFade()
+    {
+        const int limit = Config::TRAIL_LENGTH_SHORT;
+        int failures = 0;
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+
+        // Occupancy and screen both follow the ring: checked against rebuilds every tick.
+        a.setTrailLimit(limit);
+        b.setTrailLimit(limit);
+        TickEngine<GreedyController, GreedyController> checked(BENCH_WIDTH, BENCH_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                               GreedyController(b, TICK_SEED + 2));
+        Grid expected(BENCH_WIDTH, BENCH_HEIGHT);
+        FrameBuffer frame;
+        frame.resize(BENCH_WIDTH, BENCH_HEIGHT);
+        TextRenderer incremental, repainted;
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        long checkedTicks = 0, flushedCells = 0, retired = 0, mismatches = 0;
+        for (int g = 0; g < FADE_CHECK_GAMES; g++)
+        {
+            tickSpawns(spawner, 2, BENCH_WIDTH, BENCH_HEIGHT, spawns, dirs);
+            checked.respawn(spawns, dirs);
+            for (int t = 0; t < BENCH_WIDTH * BENCH_HEIGHT && !checked.tick().finished; t++)
+            {
+                checkedTicks++;
+                retired += a.retiredTail() + b.retiredTail();
+                mismatches += !occupancyMatches(checked, expected);
+
+                frame.clear();
+                drawArena(frame, BENCH_WIDTH, BENCH_HEIGHT);
+                a.draw(frame, 0, 0);
+                b.draw(frame, 0, 0);
+                flushedCells += frame.flush(incremental);
+            }
+        }
+        frame.invalidate();
+        frame.flush(repainted);
+        bool screenOk = incremental.snapshot() == repainted.snapshot();
+        failures += mismatches != 0 || !screenOk;
+
+        // Per-tick cost with whole and fading trails.
+        a.setTrailLimit(Config::TRAIL_LENGTH_FULL);
+        b.setTrailLimit(Config::TRAIL_LENGTH_FULL);
+        TickEngine<GreedyController, GreedyController> whole(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                             GreedyController(b, TICK_SEED + 2));
+        TickRun wholeRun = runEngine(whole, TICK_GAMES, 2);
+        a.setTrailLimit(limit);
+        b.setTrailLimit(limit);
+        TickEngine<GreedyController, GreedyController> fading(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                              GreedyController(b, TICK_SEED + 2));
+        TickRun fadingRun = runEngine(fading, TICK_GAMES, 2);
+
+        // Bots that plan with cells coming free, against each other.
+        Bot first(0, 0, RIGHT);
+        Bot second(0, 0, LEFT);
+        long botTicks[2] = {0, 0};
+        double botSeconds[2] = {0, 0};
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (Bot *bot : {&first, &second})
+            {
+                bot->setDifficulty(BOT_NORMAL);
+                bot->seedNoise(TICK_SEED);
+                bot->getPlayer()->setTrailLimit(pass == 0 ? Config::TRAIL_LENGTH_FULL : limit);
+            }
+            TickEngine<BotController, BotController> bots(BENCH_WIDTH, BENCH_HEIGHT,
+                                                          BotController(first, *second.getPlayer(), BENCH_WIDTH, BENCH_HEIGHT),
+                                                          BotController(second, *first.getPlayer(), BENCH_WIDTH, BENCH_HEIGHT));
+            Rng botSpawner(TICK_SEED);
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < FADE_BOT_ROUNDS; r++)
+            {
+                tickSpawns(botSpawner, 2, BENCH_WIDTH, BENCH_HEIGHT, spawns, dirs);
+                bots.respawn(spawns, dirs);
+                for (int t = 0; t < BENCH_WIDTH * BENCH_HEIGHT && !bots.tick().finished; t++)
+                    botTicks[pass]++;
+            }
+            botSeconds[pass] = secondsSince(start);
+        }
+
+        printf("fade: trails of %d cells, %d checked games on %dx%d, %ld ticks\n", limit, FADE_CHECK_GAMES, BENCH_WIDTH, BENCH_HEIGHT,
+               checkedTicks);
+        printf("  occupancy:      %ld cells retired, %ld ticks differing from a rebuild\n", retired, mismatches);
+        printf("  screen:         %6.2f cells flushed per tick, %s\n", static_cast<double>(flushedCells) / std::max(1L, checkedTicks),
+               screenOk ? "matches a full repaint" : "DIFFERS FROM A FULL REPAINT");
+        printf("  whole trails:   %12.0f ticks/s on %dx%d\n", wholeRun.ticks / wholeRun.seconds, TICK_WIDTH, TICK_HEIGHT);
+        printf("  fading trails:  %12.0f ticks/s (%.2fx)\n", fadingRun.ticks / fadingRun.seconds,
+               (fadingRun.ticks / fadingRun.seconds) / (wholeRun.ticks / wholeRun.seconds));
+        printf("  bot rounds:     %6.1f ticks/round whole, %6.1f fading (%.1f us/tick)\n", static_cast<double>(botTicks[0]) / FADE_BOT_ROUNDS,
+               static_cast<double>(botTicks[1]) / FADE_BOT_ROUNDS, botSeconds[1] * 1e6 / std::max(1L, botTicks[1]));
+
+        if (failures != 0)
+        {
+            fprintf(stderr, "fade: occupancy or screen out of step with the trails\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    int benchRender()
+    {
+        Bot first(Config::SPAWN_MARGIN, RENDER_HEIGHT / 2, RIGHT);
+        Bot second(RENDER_WIDTH - Config::SPAWN_MARGIN, RENDER_HEIGHT / 2, LEFT);
+        playOpening(first, second, RENDER_WIDTH, RENDER_HEIGHT, RENDER_TICKS);
+        const Player &a = *first.getPlayer();
+        const Player &b = *second.getPlayer();
+        long cells = static_cast<long>(a.getTrail().size() + b.getTrail().size());
+
+        FrameBuffer frame;
+        frame.resize(RENDER_WIDTH, RENDER_HEIGHT);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RENDER_FRAMES; i++)
+        {
+            frame.clear();
+            a.draw(frame, 0, 0);
+            b.draw(frame, 0, 0);
+        }
+        double drawSeconds = secondsSince(start);
+
+        // The same full-screen flushes through each backend.
+        TextRenderer memory;
+        long memoryCells = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RENDER_FRAMES; i++)
+        {
+            frame.invalidate();
+            memoryCells += frame.flush(memory);
+        }
+        double memorySeconds = secondsSince(start);
+
+        AnsiRenderer ansi;
+        ansi.setPair(Config::COLOR_PLAYER_HEAD, COLOR_CYAN, COLOR_BLACK);
+        ansi.setPair(Config::COLOR_PLAYER_TRAIL, COLOR_BLUE, COLOR_BLACK);
+        ansi.setPair(Config::COLOR_PLAYER2_HEAD, COLOR_RED, COLOR_BLACK);
+        ansi.setPair(Config::COLOR_PLAYER2_TRAIL, COLOR_YELLOW, COLOR_BLACK);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RENDER_FRAMES; i++)
+        {
+            frame.invalidate();
+            frame.flush(ansi);
+        }
+        double ansiSeconds = secondsSince(start);
+
+        FILE *output = nullptr;
+        SCREEN *screen = openHeadlessScreen(output, RENDER_WIDTH, RENDER_HEIGHT);
+        if (!screen)
+        {
+            fprintf(stderr, "render: cannot create a headless ncurses screen\n");
+            return 1;
+        }
+        start_color();
+        init_pair(Config::COLOR_PLAYER_HEAD, COLOR_CYAN, COLOR_BLACK);
+        init_pair(Config::COLOR_PLAYER_TRAIL, COLOR_BLUE, COLOR_BLACK);
+        init_pair(Config::COLOR_PLAYER2_HEAD, COLOR_RED, COLOR_BLACK);
+        init_pair(Config::COLOR_PLAYER2_TRAIL, COLOR_YELLOW, COLOR_BLACK);
+
+        CursesRenderer curses;
+        long flushedCells = 0;
+        long bytesBefore = outputSize(output);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RENDER_FRAMES; i++)
+        {
+            frame.invalidate();
+            flushedCells += frame.flush(curses);
+        }
+        double flushSeconds = secondsSince(start);
+        long flushBytes = outputSize(output) - bytesBefore;
+        closeHeadlessScreen(screen, output);
+
+        // Game-shaped frames: one tick of trail growth per frame, redrawn and diffed into memory.
+        FrameBuffer small;
+        small.resize(BENCH_WIDTH, BENCH_HEIGHT);
+        TextRenderer tickScreen;
+        Player p1(0, 0, Config::PLAYER_1_ID);
+        Player p2(0, 0, Config::PLAYER_2_ID);
+        TickEngine<GreedyController, GreedyController> engine(BENCH_WIDTH, BENCH_HEIGHT, GreedyController(p1, TICK_SEED + 1),
+                                                              GreedyController(p2, TICK_SEED + 2));
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        long tickFrames = 0;
+        start = std::chrono::steady_clock::now();
+        while (tickFrames < RENDER_TICK_FRAMES)
+        {
+            tickSpawns(spawner, 2, BENCH_WIDTH, BENCH_HEIGHT, spawns, dirs);
+            engine.respawn(spawns, dirs);
+            for (bool finished = false; !finished && tickFrames < RENDER_TICK_FRAMES; tickFrames++)
+            {
+                finished = engine.tick().finished;
+                small.clear();
+                drawArena(small, BENCH_WIDTH, BENCH_HEIGHT);
+                p1.draw(small, 0, 0);
+                p2.draw(small, 0, 0);
+                small.flush(tickScreen);
+            }
+        }
+        double tickSeconds = secondsSince(start);
+
+        double screenCells = static_cast<double>(RENDER_WIDTH) * RENDER_HEIGHT;
+        printf("render: %ld trail cells, %d frames of %dx%d\n", cells, RENDER_FRAMES, RENDER_WIDTH, RENDER_HEIGHT);
+        printf("  draw:           %8.1f ns/cell\n", drawSeconds * 1e9 / (static_cast<double>(cells) * RENDER_FRAMES));
+        printf("  memory flush:   %8.1f ns/screen cell  %9.0f frames/s\n", memorySeconds * 1e9 / std::max(1L, memoryCells),
+               RENDER_FRAMES / memorySeconds);
+        printf("  ansi flush:     %8.1f ns/screen cell  %9.0f frames/s  %6.2f bytes/trail cell\n",
+               ansiSeconds * 1e9 / (screenCells * RENDER_FRAMES), RENDER_FRAMES / ansiSeconds,
+               static_cast<double>(ansi.getBytes()) / (static_cast<double>(cells) * RENDER_FRAMES));
+        printf("  ncurses flush:  %8.1f ns/screen cell  %9.0f frames/s  %6.2f bytes/trail cell\n",
+               flushSeconds * 1e9 / std::max(1L, flushedCells), RENDER_FRAMES / flushSeconds,
+               static_cast<double>(flushBytes) / (static_cast<double>(cells) * RENDER_FRAMES));
+        printf("  tick frames:    %8.1f us/frame       %9.0f frames/s on %dx%d\n", tickSeconds * 1e6 / tickFrames, tickFrames / tickSeconds,
+               BENCH_WIDTH, BENCH_HEIGHT);
+        return 0;
+    }
+
+    template <typename Engine>
+    std::string snapshotScene(Engine &engine, int ticks, bool &consistent)
+    {
+        int width = engine.getWidth();
+        int height = engine.getHeight();
+        Rng spawner(TICK_SEED);
+        std::vector<std::pair<int, int>> spawns(engine.getPlayerCount());
+        std::vector<Direction> dirs(engine.getPlayerCount());
+        tickSpawns(spawner, engine.getPlayerCount(), width, height, spawns.data(), dirs.data());
+        engine.respawn(spawns.data(), dirs.data());
+
+        // One renderer follows every frame's diff, the other only sees the last frame in full.
+        FrameBuffer frame;
+        frame.resize(width, height);
+        TextRenderer live;
+        for (int t = 0; t < ticks && !engine.tick().finished; t++)
+        {
+            frame.clear();
+            drawArena(frame, width, height);
+            for (int i = 0; i < engine.getPlayerCount(); i++)
+                engine.getPlayer(i)->draw(frame, 0, 0);
+            frame.flush(live);
+        }
+
+        TextRenderer fresh;
+        frame.invalidate();
+        frame.flush(fresh);
+        consistent = live.snapshot() == fresh.snapshot();
+        return fresh.snapshot();
+    }
+
+    int checkSnapshot(const char *name, const std::string &actual, bool consistent)
+    {
+        std::string path = std::string(SNAPSHOT_DIR) + "/" + name + ".txt";
+        const char *update = getenv("TRON_UPDATE_SNAPSHOTS");
+        if (update && *update)
+        {
+            FILE *file = fopen(path.c_str(), "w");
+            bool written = file && fwrite(actual.data(), 1, actual.size(), file) == actual.size();
+            if (file)
+                fclose(file);
+            printf("  %-10s %s\n", name, written ? "written" : "cannot write");
+            return written ? 0 : 1;
+        }
+
+        std::string golden;
+        FILE *file = fopen(path.c_str(), "r");
+        if (file)
+        {
+            char buffer[4096];
+            size_t got;
+            while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                golden.append(buffer, got);
+            fclose(file);
+        }
+
+        bool matches = file && golden == actual;
+        std::string status = !file ? "missing " + path : matches ? "ok" : "differs from " + path;
+        printf("  %-10s %s%s\n", name, status.c_str(), consistent ? "" : " (incremental frames disagree with a full repaint)");
+        if (!matches)
+        {
+            fputs(actual.c_str(), stdout);
+        }
+        return matches && consistent ? 0 : 1;
+    }
+
+    int benchSnapshots()
+    {
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+        TickEngine<GreedyController, GreedyController> duel(SNAPSHOT_WIDTH, SNAPSHOT_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                            GreedyController(b, TICK_SEED + 2));
+
+        std::vector<Player> riders;
+        std::vector<GreedyController> controllers;
+        riders.reserve(SNAPSHOT_CROWD_PLAYERS);
+        for (int i = 0; i < SNAPSHOT_CROWD_PLAYERS; i++)
+        {
+            riders.emplace_back(0, 0, i + 1);
+            controllers.emplace_back(riders.back(), TICK_SEED + 1 + i);
+        }
+        CrowdEngine<GreedyController> crowd(SNAPSHOT_WIDTH, SNAPSHOT_HEIGHT, controllers);
+
+        printf("snapshots: rendered in memory, compared against %s/\n", SNAPSHOT_DIR);
+        int failures = 0;
+        bool consistent = true;
+        std::string frame = snapshotScene(duel, SNAPSHOT_TICKS, consistent);
+        failures += checkSnapshot("duel", frame, consistent);
+        frame = snapshotScene(crowd, SNAPSHOT_TICKS, consistent);
+        failures += checkSnapshot("crowd", frame, consistent);
+
+        // Menu screens, and how much of the screen one selection move repaints.
+        Menu menu;
+        TextRenderer menuScreen;
+        menu.compose(BENCH_WIDTH, BENCH_HEIGHT);
+        menu.getFrame().flush(menuScreen);
+        failures += checkSnapshot("menu", menuScreen.snapshot(), true);
+
+        menu.handleKey(KEY_DOWN);
+        menu.compose(BENCH_WIDTH, BENCH_HEIGHT);
+        int moved = menu.getFrame().flush(menuScreen);
+        printf("  selection move repaints %d cells\n", moved);
+        failures += moved > 2 * (2 * Config::MENU_BOX_HALF_WIDTH);
+
+        menu.handleKey(KEY_DOWN);
+        menu.handleKey('\n');
+        menu.compose(BENCH_WIDTH, BENCH_HEIGHT);
+        menu.getFrame().flush(menuScreen);
+        failures += checkSnapshot("settings", menuScreen.snapshot(), true);
+
+        if (failures != 0)
+        {
+            fprintf(stderr, "snapshots: %d frames differ (TRON_UPDATE_SNAPSHOTS=1 rewrites them)\n", failures);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Learned values straight from a refresh of both views, for checking the incremental path.
+    int refreshedValue(const NnueNetwork &network, Grid &scratch, int x, int y, int otherX, int otherY)
+    {
+        NnueAccumulator self, other;
+        scratch.set(x, y, Config::CELL_WALL);
+        network.refresh(self, scratch, x, y, otherX, otherY);
+        network.refresh(other, scratch, otherX, otherY, x, y);
+        scratch.set(x, y, Config::CELL_EMPTY);
+        return network.evaluate(self, other);
+    }
+
+    int benchNnue()
+    {
+        NnueNetwork network;
+        const char *path = getenv("TRON_NNUE");
+        if (path)
+        {
+            std::string error;
+            if (!network.load(path, error))
+            {
+                fprintf(stderr, "nnue: cannot load %s: %s\n", path, error.c_str());
+                return 1;
+            }
+        }
+        else if (!NnueNetwork::train(network, NNUE_BENCH_TRAIN_GAMES, TICK_SEED, false))
+        {
+            return 1;
+        }
+
+        // The evaluator's accumulators follow the game tick by tick; every learned value
+        // must equal one computed from scratch. Half the games use fading trails.
+        BotWeights learned;
+        learned.network = NNUE_BENCH_WEIGHT;
+        BotEvaluator watcher;
+        watcher.setNetwork(&network);
+        CandidateBatch batch;
+        batch.reserve(4);
+        Grid scratch(BENCH_WIDTH, BENCH_HEIGHT);
+        Search search;
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+        TickEngine<GreedyController, GreedyController> checked(BENCH_WIDTH, BENCH_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                               GreedyController(b, TICK_SEED + 2));
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        auto noDeadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+        long checkedMoves = 0, mismatches = 0;
+        double learnedError = 0, meanError = 0;
+        for (int g = 0; g < NNUE_CHECK_GAMES; g++)
+        {
+            int limit = g % 2 ? Config::TRAIL_LENGTH_SHORT : Config::TRAIL_LENGTH_FULL;
+            a.setTrailLimit(limit);
+            b.setTrailLimit(limit);
+            tickSpawns(spawner, 2, BENCH_WIDTH, BENCH_HEIGHT, spawns, dirs);
+            checked.respawn(spawns, dirs);
+            for (int t = 0; t < BENCH_WIDTH * BENCH_HEIGHT && !checked.tick().finished; t++)
+            {
+                watcher.prepare(a, b, BENCH_WIDTH, BENCH_HEIGHT);
+                batch.clear();
+                for (int d = 0; d < 4; d++)
+                {
+                    int x = a.getX() + (d == RIGHT) - (d == LEFT);
+                    int y = a.getY() + (d == DOWN) - (d == UP);
+                    if (watcher.isFree(x, y))
+                        batch.add(x, y, static_cast<Direction>(d));
+                }
+                watcher.evaluate(batch, learned, a.getDirection(), b.getX(), b.getY(), 1, noDeadline);
+
+                scratch = checked.getGrid();
+                for (size_t i = 0; i < batch.size(); i++)
+                {
+                    checkedMoves++;
+                    mismatches += batch.learned[i] != refreshedValue(network, scratch, batch.x[i], batch.y[i], b.getX(), b.getY());
+                    if (limit != Config::TRAIL_LENGTH_FULL)
+                        continue;
+                    scratch.set(batch.x[i], batch.y[i], Config::CELL_WALL);
+                    double cells = search.territory(scratch, batch.x[i], batch.y[i], b.getX(), b.getY());
+                    double bound = Config::NNUE_LABEL_LIMIT * Config::NNUE_LABEL_CELLS;
+                    cells = std::min(std::max(cells, -bound), bound);
+                    scratch.set(batch.x[i], batch.y[i], Config::CELL_EMPTY);
+                    learnedError += std::fabs(batch.learned[i] - cells);
+                    meanError += std::fabs(cells);
+                }
+            }
+        }
+
+        // Cost per candidate: incremental update, full refresh of both views, flood-fill heuristic.
+        Bot first(Config::SPAWN_MARGIN, BENCH_HEIGHT / 2, RIGHT);
+        Bot second(BENCH_WIDTH - Config::SPAWN_MARGIN, BENCH_HEIGHT / 2, LEFT);
+        playOpening(first, second, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WARMUP_TICKS);
+        const Player &self = *first.getPlayer();
+        const Player &opponent = *second.getPlayer();
+        long maxNodes = Bot::budgetFor(BOT_NORMAL).maxNodes / 4;
+
+        BotWeights plain;
+        plain.network = 0;
+        BotEvaluator heuristic;
+        heuristic.prepare(self, opponent, BENCH_WIDTH, BENCH_HEIGHT);
+        batch.clear();
+        for (int d = 0; d < 4; d++)
+        {
+            int x = self.getX() + (d == RIGHT) - (d == LEFT);
+            int y = self.getY() + (d == DOWN) - (d == UP);
+            if (heuristic.isFree(x, y))
+                batch.add(x, y, static_cast<Direction>(d));
+        }
+        const size_t n = batch.size();
+        if (n == 0)
+        {
+            fprintf(stderr, "nnue: no free moves after the opening\n");
+            return 1;
+        }
+
+        NnueAccumulator selfView, otherView;
+        network.refresh(selfView, heuristic.getGrid(), self.getX(), self.getY(), opponent.getX(), opponent.getY());
+        network.refresh(otherView, heuristic.getGrid(), opponent.getX(), opponent.getY(), self.getX(), self.getY());
+        scratch = heuristic.getGrid();
+        long checksumIncremental = 0, checksumRefresh = 0;
+        int crossings = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < BENCH_ITERATIONS * 100; it++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                NnueAccumulator selfMove = selfView;
+                NnueAccumulator otherMove = otherView;
+                scratch.set(batch.x[i], batch.y[i], Config::CELL_WALL);
+                network.setCell(selfMove, batch.x[i], batch.y[i], true);
+                network.setCell(otherMove, batch.x[i], batch.y[i], true);
+                network.moveHeads(selfMove, scratch, batch.x[i], batch.y[i], opponent.getX(), opponent.getY());
+                network.moveHeads(otherMove, scratch, opponent.getX(), opponent.getY(), batch.x[i], batch.y[i]);
+                scratch.set(batch.x[i], batch.y[i], Config::CELL_EMPTY);
+                checksumIncremental += network.evaluate(selfMove, otherMove);
+                crossings += it == 0 && (selfMove.centerX != selfView.centerX || selfMove.centerY != selfView.centerY);
+            }
+        }
+        double incrementalSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int it = 0; it < BENCH_ITERATIONS * 10; it++)
+        {
+            for (size_t i = 0; i < n; i++)
+                checksumRefresh += refreshedValue(network, scratch, batch.x[i], batch.y[i], opponent.getX(), opponent.getY());
+        }
+        double refreshSeconds = secondsSince(start) * 10;
+
+        start = std::chrono::steady_clock::now();
+        for (int it = 0; it < BENCH_ITERATIONS; it++)
+        {
+            heuristic.evaluate(batch, plain, self.getDirection(), opponent.getX(), opponent.getY(), maxNodes, noDeadline);
+        }
+        double heuristicSeconds = secondsSince(start) * 100;
+
+        MatchArena arena(0, 2);
+        arena.reserve(BENCH_WIDTH, BENCH_HEIGHT);
+        int results[3] = {0, 0, 0};
+        Rng matchSpawner(TICK_SEED);
+        for (int m = 0; m < NNUE_MATCHES; m++)
+        {
+            bool firstLearned = m % 2 == 0;
+            auto configure = [&](Bot &tested, Bot &baseline)
+            {
+                tested.setDifficulty(BOT_NORMAL);
+                baseline.setDifficulty(BOT_NORMAL);
+                (firstLearned ? tested : baseline).seedNoise(matchSpawner.next());
+                (firstLearned ? baseline : tested).seedNoise(matchSpawner.next());
+                tested.setNetwork(&network);
+                tested.setWeights(learned);
+                baseline.setNetwork(nullptr);
+                baseline.setWeights(BotWeights());
+            };
+            results[playHeadToHead(arena, matchSpawner, firstLearned, configure) + 1]++;
+        }
+
+        double evaluations = static_cast<double>(n) * BENCH_ITERATIONS * 100;
+        printf("nnue: %d features, %d+%d hidden units, %s\n", Config::NNUE_FEATURES, Config::NNUE_HIDDEN, Config::NNUE_LAYER2,
+               path ? path : "trained in memory");
+        printf("  incremental:    %ld moves checked against a refresh, %ld differ\n", checkedMoves, mismatches);
+        printf("  territory:      %6.1f cells mean error (%.1f guessing zero)\n", learnedError / std::max(1L, checkedMoves / 2),
+               meanError / std::max(1L, checkedMoves / 2));
+        printf("  incremental:    %12.0f evals/s (%d of %zu moves leave the anchor block and refresh)\n", evaluations / incrementalSeconds,
+               crossings, n);
+        printf("  refresh:        %12.0f evals/s (%.1fx slower)\n", evaluations / refreshSeconds, refreshSeconds / incrementalSeconds);
+        printf("  heuristic:      %12.0f evals/s (region sizes, up to %ld cells)\n", evaluations / heuristicSeconds, maxNodes);
+        printf("  normal+nnue (network=%d) vs normal on %dx%d: %d wins  %d losses  %d ties\n", NNUE_BENCH_WEIGHT, BENCH_WIDTH, BENCH_HEIGHT,
+               results[2], results[0], results[1]);
+        if (mismatches != 0 || checksumIncremental != checksumRefresh * 10)
+        {
+            fprintf(stderr, "nnue: incremental accumulators drifted from a refresh\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    struct SearchPosition
+    {
+        Grid grid;
+        int selfX, selfY, oppX, oppY;
+        Direction selfDir;
+    };
+
+    int benchSmp()
+    {
+        // Mid-game roots from noisy bot openings.
+        std::vector<SearchPosition> positions;
+        BotEvaluator occupancy;
+        for (int p = 0; p < SMP_POSITIONS; p++)
+        {
+            Bot first(Config::SPAWN_MARGIN, BENCH_HEIGHT / 2 - 4 + p, RIGHT);
+            Bot second(BENCH_WIDTH - Config::SPAWN_MARGIN, BENCH_HEIGHT / 2 + 4 - p, LEFT);
+            first.setDifficulty(BOT_EASY);
+            second.setDifficulty(BOT_EASY);
+            first.seedNoise(TICK_SEED + p);
+            second.seedNoise(TICK_SEED + p + SMP_POSITIONS);
+            playOpening(first, second, BENCH_WIDTH, BENCH_HEIGHT, BENCH_WARMUP_TICKS);
+            const Player &self = *first.getPlayer();
+            const Player &opponent = *second.getPlayer();
+            occupancy.prepare(self, opponent, BENCH_WIDTH, BENCH_HEIGHT);
+            positions.push_back({occupancy.getGrid(), self.getX(), self.getY(), opponent.getX(), opponent.getY(), self.getDirection()});
+        }
+
+        // One thread with a node limit and no deadline must repeat itself exactly.
+        long mismatches = 0;
+        std::vector<long> firstNodes;
+        std::vector<Direction> firstMoves;
+        auto never = std::chrono::steady_clock::now() + std::chrono::hours(1);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            SearchPool single(1);
+            for (size_t p = 0; p < positions.size(); p++)
+            {
+                const SearchPosition &at = positions[p];
+                Direction move = at.selfDir;
+                single.bestMove(at.grid, at.selfX, at.selfY, at.selfDir, at.oppX, at.oppY, SMP_DETERMINISM_NODES, never,
+                                Config::SEARCH_MAX_DEPTH, move);
+                if (pass == 0)
+                {
+                    firstNodes.push_back(single.getReport().totalNodes());
+                    firstMoves.push_back(move);
+                }
+                else
+                {
+                    mismatches += firstNodes[p] != single.getReport().totalNodes() || firstMoves[p] != move;
+                }
+            }
+        }
+
+        std::vector<int> counts = {1, 2, 4, SearchPool::resolveThreads(0)};
+        std::sort(counts.begin(), counts.end());
+        counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+
+        printf("smp: %d mid-game roots on %dx%d, %ld ms per search, %u cores\n", SMP_POSITIONS, BENCH_WIDTH, BENCH_HEIGHT,
+               SMP_SEARCH_MICROS / 1000, std::thread::hardware_concurrency());
+        printf("  deterministic:  1 thread, %ld nodes per root, %ld of %d roots differ between runs\n", SMP_DETERMINISM_NODES, mismatches,
+               SMP_POSITIONS);
+        double baseRate = 0;
+        for (int threads : counts)
+        {
+            SearchPool pool(threads);
+            long nodes = 0, hits = 0;
+            double depth = 0, mainDepth = 0, seconds = 0;
+            for (const SearchPosition &at : positions)
+            {
+                pool.clearTable();
+                Direction move;
+                auto start = std::chrono::steady_clock::now();
+                pool.bestMove(at.grid, at.selfX, at.selfY, at.selfDir, at.oppX, at.oppY, 0,
+                              start + std::chrono::microseconds(SMP_SEARCH_MICROS), Config::SEARCH_MAX_DEPTH, move);
+                seconds += secondsSince(start);
+                const SearchReport &report = pool.getReport();
+                nodes += report.totalNodes();
+                for (long count : report.tableHits)
+                    hits += count;
+                depth += report.depth;
+                mainDepth += report.depths[0];
+            }
+            double rate = nodes / seconds;
+            if (threads == 1)
+                baseRate = rate;
+            printf("  %2d thread%s  %10.0f nodes/s (%.2fx)  %9.0f per thread  depth %4.1f (main %4.1f)  table hits %4.1f%%\n", threads,
+                   threads == 1 ? ": " : "s:", rate, rate / baseRate, rate / threads, depth / SMP_POSITIONS, mainDepth / SMP_POSITIONS,
+                   100.0 * hits / std::max(1L, nodes));
+        }
+
+        MatchArena arena(0, 2);
+        arena.reserve(BENCH_WIDTH, BENCH_HEIGHT);
+        int results[3] = {0, 0, 0};
+        Rng spawner(TICK_SEED);
+        BotBudget searching = Bot::budgetFor(BOT_INSANE);
+        searching.maxMicros = SMP_MATCH_MICROS;
+        BotBudget heuristic = searching;
+        heuristic.search = false;
+        auto configure = [&](Bot &tested, Bot &baseline)
+        {
+            tested.setBudget(searching);
+            baseline.setBudget(heuristic);
+        };
+        for (int m = 0; m < SMP_MATCHES; m++)
+            results[playHeadToHead(arena, spawner, m % 2 == 0, configure) + 1]++;
+        printf("  insane search vs insane heuristic at %ld ms per move: %d wins  %d losses  %d ties\n", SMP_MATCH_MICROS / 1000,
+               results[2], results[0], results[1]);
+
+        if (mismatches != 0)
+        {
+            fprintf(stderr, "smp: single-thread search is not deterministic\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    // Greedy rounds on the bench arena, every other one with fading trails so some run long.
+    bool recordRounds(const std::string &path, int rounds)
+    {
+        ReplayWriter writer;
+        std::string error;
+        if (!writer.open(path, error))
+            return false;
+
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+        TickEngine<GreedyController, GreedyController> engine(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                              GreedyController(b, TICK_SEED + 2));
+        const Player *riders[] = {&a, &b};
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        ArenaMap open;
+        bool written = true;
+        for (int r = 0; r < rounds; r++)
+        {
+            int trail = r % 2 ? Config::TRAIL_LENGTH_LONG : Config::TRAIL_LENGTH_FULL;
+            a.setTrailLimit(trail);
+            b.setTrailLimit(trail);
+            tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+            engine.respawn(spawns, dirs);
+            writer.begin(BOT_BATTLE, TICK_WIDTH, TICK_HEIGHT, NORMAL, trail, open, 2, riders);
+            TickResult result = {false, Config::WINNER_TIE};
+            while (!result.finished)
+            {
+                result = engine.tick();
+                writer.tick(riders);
+            }
+            written = writer.end(result.winner) && written;
+        }
+        return written;
+    }
+
+    int benchCast()
+    {
+        std::string base = "/tmp/tron-bench-" + std::to_string(getpid());
+        std::string replayPath = base + ".replay", castPath = base + ".cast", gifPath = base + ".gif";
+        int failures = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        failures += !recordRounds(replayPath, CAST_ROUNDS);
+        double recordSeconds = secondsSince(start);
+        struct stat replayStat;
+        stat(replayPath.c_str(), &replayStat);
+
+        // Every round replays to its recorded end; the longest one is timed below.
+        ReplayReader reader;
+        ReplayRound round, longest;
+        std::string error;
+        CastReport report;
+        int rounds = 0, matching = 0;
+        long ticks = 0;
+        if (reader.open(replayPath, error))
+        {
+            while (reader.next(round))
+            {
+                rounds++;
+                ticks += round.getTicks();
+                matching += exportCast(round, castPath, "", report, error) && report.matches;
+                if (round.getTicks() > longest.getTicks())
+                    longest = round;
+            }
+        }
+        failures += rounds != CAST_ROUNDS || matching != rounds;
+
+        double castSeconds = 0, gifSeconds = 0;
+        CastReport castOnly, withGif;
+        for (int i = 0; i < CAST_EXPORTS; i++)
+        {
+            start = std::chrono::steady_clock::now();
+            failures += !exportCast(longest, castPath, "", castOnly, error);
+            castSeconds += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            failures += !exportCast(longest, castPath, gifPath, withGif, error);
+            gifSeconds += secondsSince(start);
+        }
+        unlink(replayPath.c_str());
+        unlink(castPath.c_str());
+        unlink(gifPath.c_str());
+
+        double played = longest.getTicks() * static_cast<double>(longest.tickMicros) / 1e6;
+        printf("cast: %d greedy rounds on %dx%d recorded, replayed and exported without a terminal\n", CAST_ROUNDS, TICK_WIDTH, TICK_HEIGHT);
+        printf("  record:         %8.2f ms for %ld ticks, %.1f bytes per round on disk\n", recordSeconds * 1e3, ticks,
+               static_cast<double>(replayStat.st_size) / std::max(1, rounds));
+        printf("  replayed:       %d of %d rounds end on the recorded tick with the recorded winner\n", matching, rounds);
+        printf("  longest round:  %ld ticks, %.1f s of play\n", longest.getTicks(), played);
+        printf("  asciicast:      %8.2f ms  %9.0f frames/s  %8ld bytes\n", castSeconds * 1e3 / CAST_EXPORTS,
+               castOnly.frames * CAST_EXPORTS / castSeconds, castOnly.castBytes);
+        printf("  asciicast+gif:  %8.2f ms  %9.0f frames/s  %8ld bytes of GIF\n", gifSeconds * 1e3 / CAST_EXPORTS,
+               withGif.frames * CAST_EXPORTS / gifSeconds, withGif.gifBytes);
+        // A two-minute round at the default speed, at the rates measured above.
+        double minuteFrames = 120e6 / NORMAL;
+        printf("  2 minute round: %8.2f ms asciicast, %.2f ms with gif\n", minuteFrames * castSeconds * 1e3 / (castOnly.frames * CAST_EXPORTS),
+               minuteFrames * gifSeconds * 1e3 / (withGif.frames * CAST_EXPORTS));
+        return failures != 0;
+    }
+
+    struct PacingRun
+    {
+        long frames = 0;
+        double meanDelay = 0;
+        double worstDelay = 0;
+        double tickLag = 0;
+        int level = 0;
+        long changes = 0;
+    };
+
+    // Runs the play loop's schedule in virtual time against a link that sends bytesPerSecond
+    // through a PACING_BUFFER_BYTES output buffer: a flush blocks while the buffer is full,
+    // and a frame is on screen once the link has sent its last byte.
+    PacingRun simulatePacing(double bytesPerSecond, bool adaptive)
+    {
+        Player a(0, 0, Config::PLAYER_1_ID);
+        Player b(0, 0, Config::PLAYER_2_ID);
+        TickEngine<GreedyController, GreedyController> engine(TICK_WIDTH, TICK_HEIGHT, GreedyController(a, TICK_SEED + 1),
+                                                              GreedyController(b, TICK_SEED + 2));
+        FrameBuffer frame;
+        frame.resize(TICK_WIDTH, TICK_HEIGHT);
+        AnsiRenderer ansi;
+        RenderPacer pacer;
+        pacer.reset(FAST);
+        pacer.setAdaptive(adaptive);
+
+        Rng spawner(TICK_SEED);
+        std::pair<int, int> spawns[2];
+        Direction dirs[2];
+        tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+        engine.respawn(spawns, dirs);
+
+        const double interval = FAST / 1e6;
+        double clock = 0, nextTick = 0, queued = 0;
+        double delays = 0, lag = 0;
+        PacingRun run;
+        for (long ticks = 0; ticks < PACING_TICKS;)
+        {
+            if (nextTick + interval * Config::PACER_CATCH_UP_TICKS < clock)
+                nextTick = clock;
+
+            bool draw = false;
+            double drawn = nextTick;
+            while (nextTick <= clock && ticks < PACING_TICKS)
+            {
+                lag += clock - nextTick;
+                bool finished = engine.tick().finished;
+                if (finished)
+                {
+                    tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+                    engine.respawn(spawns, dirs);
+                }
+                draw = pacer.tick() || finished || draw;
+                drawn = nextTick;
+                nextTick += interval;
+                ticks++;
+            }
+
+            if (draw)
+            {
+                frame.clear();
+                drawArena(frame, TICK_WIDTH, TICK_HEIGHT);
+                a.draw(frame, 0, 0, pacer.useAscii());
+                b.draw(frame, 0, 0, pacer.useAscii());
+                frame.print(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Tick: %ld ╠", engine.getTicks());
+                long sent = ansi.getBytes();
+                frame.flush(ansi);
+                double bytes = static_cast<double>(ansi.getBytes() - sent);
+
+                double blocked = std::max(0.0, (queued + bytes - PACING_BUFFER_BYTES) / bytesPerSecond);
+                queued = std::min(queued + bytes, PACING_BUFFER_BYTES);
+                clock += blocked;
+                double delay = clock + queued / bytesPerSecond - drawn;
+                delays += delay;
+                run.worstDelay = std::max(run.worstDelay, delay);
+                pacer.presented(static_cast<long>(bytes), static_cast<long>(blocked * 1e6), static_cast<long>(queued));
+            }
+
+            // Sleep until the next tick while the link drains.
+            double idle = std::max(0.0, nextTick - clock);
+            clock += idle;
+            queued = std::max(0.0, queued - idle * bytesPerSecond);
+        }
+
+        run.frames = pacer.getFrames();
+        run.meanDelay = delays / std::max(1L, run.frames);
+        run.tickLag = lag / PACING_TICKS;
+        run.level = pacer.getLevel();
+        run.changes = pacer.getChanges();
+        return run;
+    }
+
+    int benchPacing()
+    {
+        printf("pacing: %ld ticks of a greedy duel on %dx%d at %d us per tick, simulated links with a %.0f byte buffer\n", PACING_TICKS,
+               TICK_WIDTH, TICK_HEIGHT, FAST, PACING_BUFFER_BYTES);
+        int failures = 0;
+        for (double link : PACING_LINKS)
+        {
+            PacingRun fixed = simulatePacing(link, false);
+            PacingRun paced = simulatePacing(link, true);
+            printf("  %9.0f B/s  fixed: %5ld frames  delay %8.1f ms mean %8.1f ms worst  tick lag %7.1f ms\n", link, fixed.frames,
+                   fixed.meanDelay * 1e3, fixed.worstDelay * 1e3, fixed.tickLag * 1e3);
+            printf("  %9s      paced: %5ld frames  delay %8.1f ms mean %8.1f ms worst  tick lag %7.1f ms  level %d, %ld changes\n", "",
+                   paced.frames, paced.meanDelay * 1e3, paced.worstDelay * 1e3, paced.tickLag * 1e3, paced.level, paced.changes);
+            // Pacing never makes the screen lag further behind, and leaves a fast terminal alone.
+            failures += paced.meanDelay > fixed.meanDelay * 1.05 + 1e-3;
+            if (link == PACING_LINKS[sizeof(PACING_LINKS) / sizeof(PACING_LINKS[0]) - 1])
+                failures += paced.frames != fixed.frames;
+        }
+        return failures != 0;
+    }
+
+    struct SnapshotCase
+    {
+        const char *name;
+        BotDifficulty difficulty;
+        int trail;
+    };
+
+    const SnapshotCase SNAPSHOT_CASES[] = {{"easy", BOT_EASY, Config::TRAIL_LENGTH_FULL},
+                                           {"normal", BOT_NORMAL, Config::TRAIL_LENGTH_FULL},
+                                           {"hard", BOT_HARD, Config::TRAIL_LENGTH_FULL},
+                                           {"fading", BOT_NORMAL, 60}};
+
+    using BattleEngine = TickEngine<BotController, BotController>;
+
+    // Plays out the round, one byte of directions per tick, and returns the winner (or -1 if
+    // it is still going after SNAPSHOT_MAX_TICKS).
+    int finishRound(BattleEngine &engine, std::vector<uint8_t> &moves)
+    {
+        moves.clear();
+        while (moves.size() < static_cast<size_t>(SNAPSHOT_MAX_TICKS))
+        {
+            TickResult result = engine.tick();
+            moves.push_back(static_cast<uint8_t>(engine.getPlayer(0)->getDirection() | engine.getPlayer(1)->getDirection() << 2));
+            if (result.finished)
+                return result.winner;
+        }
+        return -1;
+    }
+
+    struct DamagedField
+    {
+        const char *name;
+        void (*damage)(MatchSnapshot &snapshot);
+    };
+
+    const DamagedField DAMAGED_FIELDS[] = {
+        {"rider off the board", [](MatchSnapshot &s) { s.riders[0].state.x = s.riders[0].trail.back().x = s.width - 1; }},
+        {"head off its trail", [](MatchSnapshot &s) { s.riders[0].state.x = s.riders[0].trail.back().x == 1 ? 2 : 1; }},
+        {"trail cell off the board", [](MatchSnapshot &s) { s.riders[0].trail.front().y = s.height; }},
+        {"border cell not wall", [](MatchSnapshot &s) { s.grid[0] = Config::CELL_EMPTY; }},
+        {"zero tick length", [](MatchSnapshot &s) { s.tickMicros = 0; }},
+        {"trail length too short", [](MatchSnapshot &s) { s.trailLength = Config::TRAIL_MIN_LENGTH - 1; }}};
+
+    int benchSnapshot()
+    {
+        std::string path = "/tmp/tron-bench-" + std::to_string(getpid()) + ".snapshot";
+        printf("snapshot: bot rounds on %dx%d saved at tick %d, resumed on fresh bots and played out\n", TICK_WIDTH, TICK_HEIGHT,
+               SNAPSHOT_SAVE_TICK);
+        int failures = 0;
+        for (const SnapshotCase &test : SNAPSHOT_CASES)
+        {
+            MatchArena original(0, 2), restored(0, 2);
+            original.reserve(TICK_WIDTH, TICK_HEIGHT);
+            restored.reserve(TICK_WIDTH, TICK_HEIGHT);
+            Bot &a = *original.acquireBot(0, 0, RIGHT);
+            Bot &b = *original.acquireBot(0, 0, LEFT);
+            Bot &c = *restored.acquireBot(0, 0, RIGHT);
+            Bot &d = *restored.acquireBot(0, 0, LEFT);
+            BotBudget budget = Bot::budgetFor(test.difficulty);
+            budget.maxMicros = SNAPSHOT_BOT_MICROS;
+            for (Bot *bot : {&a, &b})
+            {
+                bot->setDifficulty(test.difficulty);
+                bot->setBudget(budget);
+                bot->getPlayer()->setTrailLimit(test.trail);
+            }
+            // The resuming side starts out differently in every way the snapshot covers.
+            for (Bot *bot : {&c, &d})
+                bot->setDifficulty(BOT_EASY);
+            BattleEngine first(TICK_WIDTH, TICK_HEIGHT, BotController(a, *b.getPlayer(), TICK_WIDTH, TICK_HEIGHT),
+                               BotController(b, *a.getPlayer(), TICK_WIDTH, TICK_HEIGHT));
+            BattleEngine second(TICK_WIDTH, TICK_HEIGHT, BotController(c, *d.getPlayer(), TICK_WIDTH, TICK_HEIGHT),
+                                BotController(d, *c.getPlayer(), TICK_WIDTH, TICK_HEIGHT));
+
+            Rng spawner(TICK_SEED);
+            std::pair<int, int> spawns[2];
+            Direction dirs[2];
+            std::vector<uint8_t> expected, actual;
+            int rounds = 0, matching = 0;
+            long bytes = 0, cells = 0;
+            double saveSeconds = 0, loadSeconds = 0;
+            std::string error;
+            while (rounds < SNAPSHOT_ROUNDS)
+            {
+                tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+                first.respawn(spawns, dirs);
+                a.seedNoise(spawner.next());
+                b.seedNoise(spawner.next());
+                bool finished = false;
+                for (int t = 0; t < SNAPSHOT_SAVE_TICK && !finished; t++)
+                    finished = first.tick().finished;
+                if (finished)
+                    continue;
+                rounds++;
+
+                auto start = std::chrono::steady_clock::now();
+                MatchSnapshot saved;
+                saved.mode = BOT_BATTLE;
+                saved.spawner = spawner.getState();
+                saved.capture(first);
+                failures += !saved.save(path, error);
+                saveSeconds += secondsSince(start);
+                struct stat info;
+                if (stat(path.c_str(), &info) == 0)
+                    bytes += static_cast<long>(info.st_size);
+                cells += static_cast<long>(saved.riders[0].trail.size() + saved.riders[1].trail.size());
+
+                int winner = finishRound(first, expected);
+
+                tickSpawns(spawner, 2, TICK_WIDTH, TICK_HEIGHT, spawns, dirs);
+                second.respawn(spawns, dirs);
+                start = std::chrono::steady_clock::now();
+                MatchSnapshot loaded;
+                bool ok = loaded.load(path, error) && loaded.restore(second);
+                loadSeconds += secondsSince(start);
+                ok = ok && finishRound(second, actual) == winner && actual == expected && second.getTicks() == first.getTicks();
+                matching += ok;
+            }
+            printf("  %-7s %2d/%d rounds resume identically  save %7.1f us  load %7.1f us  %7.0f bytes for %5.0f trail cells\n", test.name,
+                   matching, rounds, saveSeconds * 1e6 / rounds, loadSeconds * 1e6 / rounds, static_cast<double>(bytes) / rounds,
+                   static_cast<double>(cells) / rounds);
+            failures += matching != rounds;
+        }
+
+        // Fields a crafted file could carry past the checksum are refused one by one: each
+        // case damages one field of the last snapshot and saves it with a valid checksum.
+        MatchSnapshot good;
+        std::string error;
+        failures += !good.load(path, error);
+        for (const DamagedField &field : DAMAGED_FIELDS)
+        {
+            MatchSnapshot crafted = good;
+            field.damage(crafted);
+            MatchSnapshot reloaded;
+            bool refused = crafted.save(path, error) && !reloaded.load(path, error);
+            printf("  %-24s %s\n", field.name, refused ? "refused" : "accepted");
+            failures += !refused;
+        }
+        failures += !good.save(path, error);
+
+        // A damaged file is refused rather than half restored.
+        MatchSnapshot damaged;
+        FILE *file = fopen(path.c_str(), "r+b");
+        if (file)
+        {
+            fseek(file, -1, SEEK_END);
+            int last = fgetc(file);
+            fseek(file, -1, SEEK_END);
+            fputc(last ^ 1, file);
+            fclose(file);
+        }
+        bool refused = file && !damaged.load(path, error);
+        unlink(path.c_str());
+        printf("  damaged file %s\n", refused ? "refused" : "accepted");
+        failures += !refused;
+        return failures != 0;
+    }
+    std::string readWhole(const std::string &path)
+    {
+        std::string contents;
+        FILE *file = fopen(path.c_str(), "rb");
+        if (!file)
+            return contents;
+        char buffer[4096];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            contents.append(buffer, got);
+        fclose(file);
+        return contents;
+    }
+
+    // Runs every built-in visitor over the archive; the CSVs land in PREFIX.<visitor>.csv.
+    bool analyzeArchive(const std::string &replayPath, const std::string &prefix, int threads, AnalysisReport &report)
+    {
+        ReplayAnalyzer analyzer(threads);
+        for (int v = 0; v < ReplayAnalyzer::VISITOR_COUNT; v++)
+            analyzer.add(ReplayAnalyzer::makeVisitor(ReplayAnalyzer::VISITOR_NAMES[v]));
+        std::string error;
+        if (!analyzer.run(replayPath, error))
+            return false;
+        report = analyzer.getReport();
+        bool written = true;
+        for (const auto &visitor : analyzer.getVisitors())
+        {
+            FILE *out = fopen((prefix + "." + visitor->name() + ".csv").c_str(), "w");
+            written = out && visitor->writeCsv(out) && written;
+            written = out && fclose(out) == 0 && written;
+        }
+        return written;
+    }
+
+    int benchAnalyze()
+    {
+        std::string base = "/tmp/tron-bench-" + std::to_string(getpid());
+        std::string replayPath = base + ".replay";
+        int failures = !recordRounds(replayPath, ANALYZE_ROUNDS);
+        int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        AnalysisReport single, parallel;
+        failures += !analyzeArchive(replayPath, base + ".single", 1, single);
+        failures += !analyzeArchive(replayPath, base + ".parallel", cores, parallel);
+
+        // The merged totals must not depend on how rounds were spread over threads.
+        int identical = 0;
+        for (int v = 0; v < ReplayAnalyzer::VISITOR_COUNT; v++)
+        {
+            std::string singlePath = base + ".single." + ReplayAnalyzer::VISITOR_NAMES[v] + ".csv";
+            std::string parallelPath = base + ".parallel." + ReplayAnalyzer::VISITOR_NAMES[v] + ".csv";
+            std::string contents = readWhole(singlePath);
+            identical += !contents.empty() && contents == readWhole(parallelPath);
+            unlink(singlePath.c_str());
+            unlink(parallelPath.c_str());
+        }
+        unlink(replayPath.c_str());
+        failures += identical != ReplayAnalyzer::VISITOR_COUNT;
+        failures += single.rounds != ANALYZE_ROUNDS || parallel.rounds != ANALYZE_ROUNDS || single.mismatched != 0;
+
+        printf("analyze: %d greedy rounds on %dx%d re-simulated through all %d visitors\n", ANALYZE_ROUNDS, TICK_WIDTH, TICK_HEIGHT,
+               ReplayAnalyzer::VISITOR_COUNT);
+        printf("  1 thread:   %8.2f s  %9.0f rounds/s  %6.1fM rounds/hour  %9.0f ticks/s\n", single.seconds, single.rounds / single.seconds,
+               single.rounds / single.seconds * 3600 / 1e6, single.ticks / single.seconds);
+        printf("  %d threads:  %8.2f s  %9.0f rounds/s  %6.1fM rounds/hour  %9.0f ticks/s\n", cores, parallel.seconds,
+               parallel.rounds / parallel.seconds, parallel.rounds / parallel.seconds * 3600 / 1e6, parallel.ticks / parallel.seconds);
+        printf("  %.1f ticks per round, %ld mismatched, %d of %d CSVs identical across thread counts\n",
+               static_cast<double>(single.ticks) / std::max(1L, single.rounds), single.mismatched, identical, ReplayAnalyzer::VISITOR_COUNT);
+        return failures != 0;
+    }
+    // Scripted vs-bot ticks with and without the stage profiler, then its report.
+    int benchProfile()
+    {
+        FILE *output = nullptr;
+        SCREEN *screen = openHeadlessScreen(output, BENCH_WIDTH, BENCH_HEIGHT);
+        if (!screen)
+        {
+            fprintf(stderr, "profile: cannot create a headless ncurses screen\n");
+            return 1;
+        }
+
+        const std::vector<int> keys = {ERR, KEY_UP, ERR, ERR, KEY_LEFT, ERR, ERR, KEY_DOWN, ERR, KEY_RIGHT, ERR};
+        double seconds[2];
+        TickProfiler profiler;
+        bool counters = profiler.open();
+        for (int profiled = 0; profiled < 2; profiled++)
+        {
+            if (profiled)
+                profiler.install();
+            Game game(BENCH_WIDTH, BENCH_HEIGHT);
+            game.setGameMode(VS_BOT);
+            auto start = std::chrono::steady_clock::now();
+            game.playScripted(keys, 0, MODE_TICKS);
+            seconds[profiled] = secondsSince(start);
+            profiler.uninstall();
+        }
+        closeHeadlessScreen(screen, output);
+
+        printf("profile: %d scripted vs-bot ticks on %dx%d, hardware counters %s\n", MODE_TICKS, BENCH_WIDTH, BENCH_HEIGHT,
+               counters ? "open" : "unavailable");
+        printf("  unprofiled: %8.0f ns/tick\n", seconds[0] * 1e9 / MODE_TICKS);
+        printf("  profiled:   %8.0f ns/tick\n", seconds[1] * 1e9 / MODE_TICKS);
+        profiler.report(stdout);
+        if (profiler.getTicks() != MODE_TICKS)
+        {
+            fprintf(stderr, "profile: counted %ld ticks of %d\n", profiler.getTicks(), MODE_TICKS);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int runBenchmark(const std::string &name)
+{
+    if (name == "eval")
+        return benchEval();
+    if (name == "render")
+        return benchRender();
+    if (name == "tick")
+        return benchTick();
+    if (name == "rounds")
+        return benchRounds();
+    if (name == "host")
+        return benchHost();
+    if (name == "regions")
+        return benchRegions();
+    if (name == "endgame")
+        return benchEndgame();
+    if (name == "modes")
+        return benchModes();
+    if (name == "stats")
+        return benchStats();
+    if (name == "snapshots")
+        return benchSnapshots();
+    if (name == "maps")
+        return benchMaps();
+    if (name == "fade")
+        return benchFade();
+    if (name == "nnue")
+        return benchNnue();
+    if (name == "smp")
+        return benchSmp();
+    if (name == "cast")
+        return benchCast();
+    if (name == "pacing")
+        return benchPacing();
+    if (name == "snapshot")
+        return benchSnapshot();
+    if (name == "analyze")
+        return benchAnalyze();
+    if (name == "profile")
+        return benchProfile();
+
+    fprintf(stderr, "Unknown benchmark: %s (available: eval, render, tick, rounds, host, regions, endgame, modes, stats, snapshots, maps, fade, nnue, smp, cast, pacing, snapshot, analyze, profile)\n", name.c_str());
+    return 1;
+}
@@ -0,0 +1,323 @@
+#include "../include/book.h"
+#include "../include/game.h"
+#include "../include/grid.h"
+#include "../include/search.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char BOOK_MAGIC[8] = {'T', 'R', 'O', 'N', 'B', 'O', 'O', 'K'};
+    const uint32_t BOOK_VERSION = 1;
+
+    const int SYMMETRY_FLIP_X = 1;
+    const int SYMMETRY_FLIP_Y = 2;
+    const int NUM_SYMMETRIES = 4;
+
+    const uint64_t TAG_CELL_SELF = 1;
+    const uint64_t TAG_CELL_OPPONENT = 2;
+    const uint64_t TAG_HEAD_SELF = 3;
+    const uint64_t TAG_HEAD_OPPONENT = 4;
+    const uint64_t TAG_DIR_SELF = 5;
+    const uint64_t TAG_DIR_OPPONENT = 6;
+    const uint64_t TAG_SIZE = 7;
+
+    struct BookHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t capacity;
+        uint64_t entries;
+    };
+
+    uint64_t mix(uint64_t v)
+    {
+        v += 0x9e3779b97f4a7c15ULL;
+        v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        v = (v ^ (v >> 27)) * 0x94d049bb133111ebULL;
+        return v ^ (v >> 31);
+    }
+
+    uint64_t feature(uint64_t tag, int a, int b = 0)
+    {
+        return mix((tag << 48) | (static_cast<uint64_t>(a & 0xffff) << 16) | static_cast<uint64_t>(b & 0xffff));
+    }
+
+    uint64_t slotKey(uint64_t key)
+    {
+        key &= ~3ULL;
+        return key ? key : 4;
+    }
+
+    uint64_t slotIndex(uint64_t key, uint64_t capacity)
+    {
+        return (key >> 2) & (capacity - 1);
+    }
+
+    void fillGrid(Grid &grid, const Player &self, const Player &opponent, int width, int height)
+    {
+        if (grid.getWidth() != width || grid.getHeight() != height)
+            grid.resize(width, height);
+        else
+            grid.clear();
+
+        for (const auto &segment : self.getTrail())
+            grid.set(segment.x, segment.y, Config::CELL_SELF);
+        for (const auto &segment : opponent.getTrail())
+            grid.set(segment.x, segment.y, Config::CELL_OPPONENT);
+    }
+}
+
+OpeningBook::OpeningBook() : slots(nullptr), capacity(0), mapping(nullptr), mappingSize(0) {}
+
+OpeningBook::~OpeningBook()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+}
+
+OpeningBook &OpeningBook::instance()
+{
+    static OpeningBook book;
+    return book;
+}
+
+void OpeningBook::load()
+{
+    const char *path = getenv(Config::OPENING_BOOK_ENV);
+    if (!path || !*path)
+        path = Config::OPENING_BOOK_PATH;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BookHeader)))
+    {
+        close(fd);
+        return;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return;
+
+    const BookHeader *header = static_cast<const BookHeader *>(map);
+    bool valid = memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) == 0 &&
+                 header->version == BOOK_VERSION &&
+                 header->capacity > 0 &&
+                 (header->capacity & (header->capacity - 1)) == 0 &&
+                 header->capacity <= (size - sizeof(BookHeader)) / sizeof(uint64_t);
+    if (!valid)
+    {
+        munmap(map, size);
+        return;
+    }
+
+    mapping = map;
+    mappingSize = size;
+    capacity = header->capacity;
+    slots = reinterpret_cast<const uint64_t *>(static_cast<const char *>(map) + sizeof(BookHeader));
+}
+
+bool OpeningBook::isAvailable()
+{
+    std::call_once(loadOnce, &OpeningBook::load, this);
+    return slots != nullptr;
+}
+
+bool OpeningBook::lookup(const Player &self, const Player &opponent, int width, int height, Direction &move)
+{
+    if (!isAvailable())
+        return false;
+
+    uint64_t key;
+    int symmetry = canonicalSymmetry(self, opponent, width, height, key);
+    key = slotKey(key);
+
+    for (uint64_t i = slotIndex(key, capacity), probes = 0; probes < capacity; i = (i + 1) & (capacity - 1), probes++)
+    {
+        uint64_t slot = slots[i];
+        if (slot == 0)
+            return false;
+        if ((slot & ~3ULL) == key)
+        {
+            move = transform(static_cast<Direction>(slot & 3ULL), symmetry);
+            return true;
+        }
+    }
+    return false;
+}
+
+Direction OpeningBook::transform(Direction dir, int symmetry)
+{
+    if ((symmetry & SYMMETRY_FLIP_X) && (dir == LEFT || dir == RIGHT))
+        return dir == LEFT ? RIGHT : LEFT;
+    if ((symmetry & SYMMETRY_FLIP_Y) && (dir == UP || dir == DOWN))
+        return dir == UP ? DOWN : UP;
+    return dir;
+}
+
+uint64_t OpeningBook::positionKey(const Player &self, const Player &opponent, int width, int height, int symmetry)
+{
+    auto mapX = [&](int x)
+    { return (symmetry & SYMMETRY_FLIP_X) ? width - 1 - x : x; };
+    auto mapY = [&](int y)
+    { return (symmetry & SYMMETRY_FLIP_Y) ? height - 1 - y : y; };
+
+    uint64_t key = feature(TAG_SIZE, width, height);
+    for (const auto &segment : self.getTrail())
+        key ^= feature(TAG_CELL_SELF, mapX(segment.x), mapY(segment.y));
+    for (const auto &segment : opponent.getTrail())
+        key ^= feature(TAG_CELL_OPPONENT, mapX(segment.x), mapY(segment.y));
+
+    key ^= feature(TAG_HEAD_SELF, mapX(self.getX()), mapY(self.getY()));
+    key ^= feature(TAG_HEAD_OPPONENT, mapX(opponent.getX()), mapY(opponent.getY()));
+    key ^= feature(TAG_DIR_SELF, transform(self.getDirection(), symmetry));
+    key ^= feature(TAG_DIR_OPPONENT, transform(opponent.getDirection(), symmetry));
+    return key;
+}
+
+int OpeningBook::canonicalSymmetry(const Player &self, const Player &opponent, int width, int height, uint64_t &key)
+{
+    int best = 0;
+    key = positionKey(self, opponent, width, height, 0);
+    for (int symmetry = 1; symmetry < NUM_SYMMETRIES; symmetry++)
+    {
+        uint64_t candidate = positionKey(self, opponent, width, height, symmetry);
+        if (candidate < key)
+        {
+            key = candidate;
+            best = symmetry;
+        }
+    }
+    return best;
+}
+
+bool OpeningBook::generate(const std::string &path, const std::vector<std::pair<int, int>> &sizes, int plies, int depth)
+{
+    std::unordered_map<uint64_t, Direction> entries;
+    Search search;
+    Grid grid;
+    long searches = 0;
+
+    for (const auto &size : sizes)
+    {
+        int width = size.first;
+        int height = size.second;
+        if (width <= 2 * Config::SPAWN_MARGIN || height <= 2 * Config::SPAWN_MARGIN)
+        {
+            fprintf(stderr, "Skipping %dx%d: arena too small for spawning\n", width, height);
+            continue;
+        }
+
+        for (int botSide = 0; botSide < Config::NUM_SIDES; botSide++)
+        {
+            int oppSide = (botSide + 2) % Config::NUM_SIDES;
+            int botSpan = Game::getSideSpan(botSide, width, height);
+            int oppSpan = Game::getSideSpan(oppSide, width, height);
+
+            for (int botOffset = 0; botOffset < botSpan; botOffset++)
+            {
+                for (int oppOffset = 0; oppOffset < oppSpan; oppOffset++)
+                {
+                    auto botPos = Game::getPositionOnSide(botSide, botOffset, width, height);
+                    auto oppPos = Game::getPositionOnSide(oppSide, oppOffset, width, height);
+                    Player bot(botPos.first, botPos.second, Config::PLAYER_2_ID, Game::getSafeDirection(botSide));
+                    Player opponent(oppPos.first, oppPos.second, Config::PLAYER_1_ID, Game::getSafeDirection(oppSide));
+                    bot.initializeTrail();
+                    opponent.initializeTrail();
+
+                    for (int ply = 0; ply < plies; ply++)
+                    {
+                        uint64_t key;
+                        int symmetry = canonicalSymmetry(bot, opponent, width, height, key);
+                        key = slotKey(key);
+
+                        fillGrid(grid, bot, opponent, width, height);
+
+                        Direction move;
+                        auto it = entries.find(key);
+                        if (it != entries.end())
+                        {
+                            move = transform(it->second, symmetry);
+                        }
+                        else
+                        {
+                            move = search.bestMove(grid, bot.getX(), bot.getY(), bot.getDirection(),
+                                                   opponent.getX(), opponent.getY(), depth);
+                            entries[key] = transform(move, symmetry);
+                            searches++;
+                        }
+
+                        bot.setDirection(move);
+                        int botNextX = bot.getNextX(), botNextY = bot.getNextY();
+                        int oppNextX = opponent.getNextX(), oppNextY = opponent.getNextY();
+                        if (!grid.isFree(botNextX, botNextY) || !grid.isFree(oppNextX, oppNextY) ||
+                            (botNextX == oppNextX && botNextY == oppNextY))
+                        {
+                            break;
+                        }
+
+                        bot.move();
+                        opponent.move();
+                    }
+                }
+            }
+        }
+
+        fprintf(stderr, "%dx%d: %zu positions (%ld searched)\n", width, height, entries.size(), searches);
+    }
+
+    uint64_t capacity = 16;
+    while (capacity < entries.size() * 2)
+        capacity <<= 1;
+
+    std::vector<uint64_t> table(capacity, 0);
+    for (const auto &entry : entries)
+    {
+        uint64_t i = slotIndex(entry.first, capacity);
+        while (table[i] != 0)
+            i = (i + 1) & (capacity - 1);
+        table[i] = entry.first | static_cast<uint64_t>(entry.second);
+    }
+
+    BookHeader header;
+    memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.reserved = 0;
+    header.capacity = capacity;
+    header.entries = entries.size();
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        perror(path.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(table.data(), sizeof(uint64_t), table.size(), file) == table.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "Failed to write opening book to %s\n", path.c_str());
+        return false;
+    }
+
+    fprintf(stderr, "Wrote %zu positions to %s (%zu bytes)\n", entries.size(), path.c_str(),
+            sizeof(header) + table.size() * sizeof(uint64_t));
+    return true;
+}
@@ -1,86 +1,90 @@
 #include "../include/bot.h"
-#include <random>
+#include "../include/book.h"
 #include <algorithm>
-#include <queue>
-#include <set>
+#include <ctime>
+#include <strings.h>
+
+Bot::Bot(int startX, int startY, Direction startDirection, int playerId)
+    : botPlayer(startX, startY, playerId, startDirection),
+      difficulty(static_cast<BotDifficulty>(Config::DEFAULT_BOT_DIFFICULTY)),
+      budget(budgetFor(difficulty)),
+      rng(static_cast<uint64_t>(time(nullptr))),
+      searchThreads(Config::BOT_SEARCH_THREADS), nodesUsed(0), map(nullptr)
+{
+}
 
-Bot::Bot(int startX, int startY, Direction startDirection)
+void Bot::setSearchThreads(int threads)
 {
-  botPlayer = new Player(startX, startY, Config::PLAYER_2_ID, startDirection);
+  searchThreads = threads;
+  if (deepSearch)
+    deepSearch->setThreads(threads);
 }
 
-Bot::~Bot()
+void Bot::setMap(const ArenaMap *newMap)
 {
-  delete botPlayer;
+  map = newMap && newMap->getInteriorWalls() > 0 ? newMap : nullptr;
+  evaluator.setMap(map);
 }
 
 void Bot::update(const Player &opponent, int width, int height)
 {
   Direction nextMove = calculateBestMove(opponent, width, height);
-  botPlayer->setDirection(nextMove);
-  botPlayer->move();
+  botPlayer.setDirection(nextMove);
 }
 
 Direction Bot::calculateBestMove(const Player &opponent, int width, int height)
 {
   Direction directions[] = {UP, DOWN, LEFT, RIGHT};
-  Direction currentDir = botPlayer->getDirection();
+  Direction currentDir = botPlayer.getDirection();
 
-  int currentX = botPlayer->getX();
-  int currentY = botPlayer->getY();
+  int currentX = botPlayer.getX();
+  int currentY = botPlayer.getY();
 
-  std::vector<std::pair<Direction, int>> spaceAnalysis;
-  int maxSpace = -1;
-  Direction bestSpaceDir = currentDir;
+  evaluator.prepare(botPlayer, opponent, width, height);
 
-  for (int i = 0; i < 4; i++)
+  // Book lines were searched on an empty arena.
+  if (!map && static_cast<int>(botPlayer.getTrail().size()) <= Config::OPENING_BOOK_MAX_PLY)
   {
-    Direction dir = directions[i];
-    int nextX = currentX, nextY = currentY;
-
-    switch (dir)
-    {
-    case UP:
-      nextY--;
-      break;
-    case DOWN:
-      nextY++;
-      break;
-    case LEFT:
-      nextX--;
-      break;
-    case RIGHT:
-      nextX++;
-      break;
-    }
-
-    if (isPositionSafe(nextX, nextY, opponent, width, height))
+    Direction bookMove;
+    if (OpeningBook::instance().lookup(botPlayer, opponent, width, height, bookMove))
     {
-      int space = floodFill(nextX, nextY, opponent, width, height);
-      spaceAnalysis.push_back({dir, space});
-      if (space > maxSpace)
+      int bookX = currentX + (bookMove == RIGHT) - (bookMove == LEFT);
+      int bookY = currentY + (bookMove == DOWN) - (bookMove == UP);
+      if (evaluator.isFree(bookX, bookY))
       {
-        maxSpace = space;
-        bestSpaceDir = dir;
+        return bookMove;
       }
     }
   }
 
-  if (spaceAnalysis.empty())
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget.maxMicros);
+
+  // Once neither rider can reach the other, the round is decided by who fills more cells.
+  if (budget.endgame && evaluator.separated(currentX, currentY, opponent.getX(), opponent.getY()))
   {
-    return currentDir;
+    Direction move = endgame.bestMove(evaluator.getGrid(), evaluator.getRegions(), currentX, currentY, currentDir, budget.maxNodes, deadline);
+    nodesUsed = endgame.getNodes();
+    return move;
   }
 
-  int bestScore = -10000;
-  Direction bestDir = bestSpaceDir;
-
-  for (const auto &analysis : spaceAnalysis)
+  if (budget.search && budget.maxNodes >= Config::BOT_SEARCH_MIN_NODES)
   {
-    Direction dir = analysis.first;
-    int availableSpace = analysis.second;
-    int score = 0;
+    if (!deepSearch)
+      deepSearch.reset(new SearchPool(searchThreads));
+    Direction move;
+    bool found = deepSearch->bestMove(evaluator.getGrid(), currentX, currentY, currentDir, opponent.getX(), opponent.getY(),
+                                      budget.maxNodes, deadline, Config::SEARCH_MAX_DEPTH, move);
+    nodesUsed = deepSearch->getReport().totalNodes();
+    if (found)
+      return move;
+  }
 
+  candidates.clear();
+  for (int i = 0; i < 4; i++)
+  {
+    Direction dir = directions[i];
     int nextX = currentX, nextY = currentY;
+
     switch (dir)
     {
     case UP:
@@ -97,174 +101,123 @@ Direction Bot::calculateBestMove(const Player &opponent, int width, int height)
       break;
     }
 
-    score += availableSpace * 50;
-
-    int distFromLeft = nextX;
-    int distFromRight = width - 1 - nextX;
-    int distFromTop = nextY;
-    int distFromBottom = height - 1 - nextY;
-    int minDistToWall = std::min({distFromLeft, distFromRight, distFromTop, distFromBottom});
-    score += minDistToWall * 15;
-
-    if (dir == currentDir)
+    if (evaluator.isFree(nextX, nextY))
     {
-      if (availableSpace >= maxSpace * 0.9)
-      {
-        score += 100;
-      }
-      else if (availableSpace >= maxSpace * 0.75)
-      {
-        score += 30;
-      }
+      candidates.add(nextX, nextY, dir);
     }
+  }
 
-    int lookAheadSteps = 0;
-    int checkX = nextX, checkY = nextY;
-    for (int step = 0; step < 10; step++)
-    {
-      switch (dir)
-      {
-      case UP:
-        checkY--;
-        break;
-      case DOWN:
-        checkY++;
-        break;
-      case LEFT:
-        checkX--;
-        break;
-      case RIGHT:
-        checkX++;
-        break;
-      }
+  if (candidates.size() == 0)
+  {
+    return currentDir;
+  }
 
-      if (isPositionSafe(checkX, checkY, opponent, width, height))
-      {
-        lookAheadSteps++;
-      }
-      else
-      {
-        break;
-      }
-    }
-    score += lookAheadSteps * 8;
+  long nodesPerDirection = std::max(1L, budget.maxNodes / 4);
+  nodesUsed = evaluator.evaluate(candidates, weights, currentDir, opponent.getX(), opponent.getY(), nodesPerDirection, deadline);
 
-    int futureOptions = 0;
-    Direction futureDir[] = {UP, DOWN, LEFT, RIGHT};
-    for (int j = 0; j < 4; j++)
-    {
-      int futureX = nextX, futureY = nextY;
-      switch (futureDir[j])
-      {
-      case UP:
-        futureY--;
-        break;
-      case DOWN:
-        futureY++;
-        break;
-      case LEFT:
-        futureX--;
-        break;
-      case RIGHT:
-        futureX++;
-        break;
-      }
-      if (isPositionSafe(futureX, futureY, opponent, width, height))
-      {
-        futureOptions++;
-      }
-    }
-    score += futureOptions * 20;
+  int bestScore = -10000;
+  Direction bestDir = currentDir;
+
+  for (size_t i = 0; i < candidates.size(); i++)
+  {
+    int score = candidates.score[i];
 
-    int distToOpponent = abs(nextX - opponent.getX()) + abs(nextY - opponent.getY());
-    if (distToOpponent > 5)
+    if (budget.noise > 0)
     {
-      score += 10;
+      score += rng.range(-budget.noise, budget.noise);
     }
 
     if (score > bestScore)
     {
       bestScore = score;
-      bestDir = dir;
+      bestDir = static_cast<Direction>(candidates.dir[i]);
     }
   }
 
   return bestDir;
 }
 
-bool Bot::isPositionSafe(int x, int y, const Player &opponent, int width, int height)
+int Bot::evaluateMove(Direction dir, const Player &opponent, int width, int height)
 {
-  if (x <= 0 || x >= width - 1 || y <= 0 || y >= height - 1)
-  {
-    return false;
-  }
+  int nextX = botPlayer.getX() + (dir == RIGHT) - (dir == LEFT);
+  int nextY = botPlayer.getY() + (dir == DOWN) - (dir == UP);
 
-  const auto &botTrail = botPlayer->getTrail();
-  for (const auto &segment : botTrail)
+  evaluator.prepare(botPlayer, opponent, width, height);
+  if (!evaluator.isFree(nextX, nextY))
   {
-    if (segment.x == x && segment.y == y)
-    {
-      return false;
-    }
+    return -Config::SEARCH_WIN_SCORE;
   }
 
-  const auto &opponentTrail = opponent.getTrail();
-  for (const auto &segment : opponentTrail)
-  {
-    if (segment.x == x && segment.y == y)
-    {
-      return false;
-    }
-  }
-  return true;
+  CandidateBatch single;
+  single.add(nextX, nextY, dir);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget.maxMicros);
+  evaluator.evaluate(single, weights, botPlayer.getDirection(), opponent.getX(), opponent.getY(),
+                     std::max(1L, budget.maxNodes / 4), deadline);
+  return single.score[0];
 }
 
-Player *Bot::getPlayer() const
+void Bot::respawn(int x, int y, Direction dir)
 {
-  return botPlayer;
+  botPlayer.respawn(x, y, dir);
+  nodesUsed = 0;
 }
 
-void Bot::reset(int newX, int newY)
+void Bot::reserve(int width, int height)
 {
-  if (newX != -1 && newY != -1)
-  {
-    botPlayer->reset(newX, newY);
-  }
+  botPlayer.reserveTrail(static_cast<size_t>(width) * height);
+  evaluator.reserve(width, height);
+  endgame.reserve(width, height);
+  candidates.reserve(4);
 }
 
-int Bot::floodFill(int startX, int startY, const Player &opponent, int width, int height)
+void Bot::setDifficulty(BotDifficulty level)
 {
-  std::queue<std::pair<int, int>> q;
-  std::set<std::pair<int, int>> visited;
-
-  q.push({startX, startY});
-  visited.insert({startX, startY});
-
-  int accessibleCells = 0;
-  const int MAX_DEPTH = 100;
+  difficulty = level;
+  budget = budgetFor(level);
+}
 
-  while (!q.empty() && accessibleCells < MAX_DEPTH)
+BotBudget Bot::budgetFor(BotDifficulty level)
+{
+  switch (level)
   {
-    auto [x, y] = q.front();
-    q.pop();
-    accessibleCells++;
+  case BOT_EASY:
+    return {Config::BOT_EASY_NODES, Config::BOT_EASY_MICROS, Config::BOT_EASY_NOISE};
+  case BOT_HARD:
+    return {Config::BOT_HARD_NODES, Config::BOT_HARD_MICROS, Config::BOT_HARD_NOISE};
+  case BOT_INSANE:
+    return {Config::BOT_INSANE_NODES, Config::BOT_INSANE_MICROS, Config::BOT_INSANE_NOISE};
+  case BOT_NORMAL:
+  default:
+    return {Config::BOT_NORMAL_NODES, Config::BOT_NORMAL_MICROS, Config::BOT_NORMAL_NOISE};
+  }
+}
 
-    int dx[] = {0, 0, -1, 1};
-    int dy[] = {-1, 1, 0, 0};
+const char *Bot::difficultyName(BotDifficulty level)
+{
+  switch (level)
+  {
+  case BOT_EASY:
+    return "Easy";
+  case BOT_NORMAL:
+    return "Normal";
+  case BOT_HARD:
+    return "Hard";
+  case BOT_INSANE:
+    return "Insane";
+  }
+  return "Normal";
+}
 
-    for (int i = 0; i < 4; i++)
+bool Bot::difficultyFromName(const char *name, BotDifficulty &level)
+{
+  for (int i = 0; i < Config::NUM_BOT_DIFFICULTIES; i++)
+  {
+    BotDifficulty candidate = static_cast<BotDifficulty>(i);
+    if (strcasecmp(name, difficultyName(candidate)) == 0)
     {
-      int nx = x + dx[i];
-      int ny = y + dy[i];
-
-      if (visited.find({nx, ny}) == visited.end() &&
-          isPositionSafe(nx, ny, opponent, width, height))
-      {
-        visited.insert({nx, ny});
-        q.push({nx, ny});
-      }
+      level = candidate;
+      return true;
     }
   }
-
-  return accessibleCells;
+  return false;
 }
@@ -0,0 +1,260 @@
+#include "../include/cast.h"
+#include "../include/engine.h"
+#include "../include/framebuffer.h"
+#include "../include/renderer.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Colour pairs of the default scheme, as terminal colour numbers.
+    const short CAST_PAIRS[][2] = {{Config::COLOR_PLAYER_HEAD, 6}, {Config::COLOR_PLAYER_TRAIL, 4}, {Config::COLOR_PLAYER2_HEAD, 1},
+                                   {Config::COLOR_PLAYER2_TRAIL, 3}, {Config::COLOR_BORDERS, 7}, {Config::COLOR_GAME_OVER, 1},
+                                   {Config::COLOR_HUD, 3}, {Config::COLOR_MESSAGES, 5}};
+
+    const char *const RESULTS[][3] = {{"Game over", "Game over", "Game over"},
+                                      {"Tie game", "Player 1 wins", "Player 2 wins"},
+                                      {"Tie game", "Player wins", "Bot wins"},
+                                      {"Tie game", "Bot 1 wins", "Bot 2 wins"}};
+
+    // Forwards one flush to the asciicast and, when there is one, the GIF.
+    class CastRenderer : public Renderer
+    {
+    private:
+        AnsiRenderer &cast;
+        GifRenderer *gif;
+
+    public:
+        CastRenderer(AnsiRenderer &cast, GifRenderer *gif) : cast(cast), gif(gif) {}
+
+        void begin(int width, int height, bool repaint) override
+        {
+            cast.begin(width, height, repaint);
+            if (gif)
+                gif->begin(width, height, repaint);
+        }
+
+        void run(int x, int y, const Cell *cells, int count) override
+        {
+            cast.run(x, y, cells, count);
+            if (gif)
+                gif->run(x, y, cells, count);
+        }
+
+        void end() override
+        {
+            cast.end();
+            if (gif)
+                gif->end();
+        }
+    };
+
+    class CastWriter
+    {
+    private:
+        const ReplayRound &round;
+        FILE *file;
+        GifRenderer *gif;
+        FrameBuffer frame;
+        AnsiRenderer ansi;
+        CastRenderer screen;
+        std::string event;
+        CastReport &report;
+
+        void escape(const std::string &data)
+        {
+            for (char c : data)
+            {
+                unsigned char byte = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\')
+                {
+                    event += '\\';
+                    event += c;
+                }
+                else if (byte < 0x20)
+                {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", byte);
+                    event += code;
+                }
+                else
+                {
+                    event += c;
+                }
+            }
+        }
+
+        void drawArena()
+        {
+            int width = round.width;
+            int height = round.height;
+            frame.clear();
+            frame.print(0, 0, Config::COLOR_BORDERS, "╔");
+            frame.print(width - 1, 0, Config::COLOR_BORDERS, "╗");
+            frame.print(0, height - 1, Config::COLOR_BORDERS, "╚");
+            frame.print(width - 1, height - 1, Config::COLOR_BORDERS, "╝");
+            for (int x = 1; x < width - 1; x++)
+            {
+                frame.print(x, 0, Config::COLOR_BORDERS, "═");
+                frame.print(x, height - 1, Config::COLOR_BORDERS, "═");
+            }
+            for (int y = 1; y < height - 1; y++)
+            {
+                frame.print(0, y, Config::COLOR_BORDERS, "║");
+                frame.print(width - 1, y, Config::COLOR_BORDERS, "║");
+                for (int x = 1; x < width - 1 && !round.map.empty(); x++)
+                {
+                    if (round.map.isWall(x, y))
+                        frame.print(x, y, Config::COLOR_BORDERS, "▓");
+                }
+            }
+        }
+
+    public:
+        CastWriter(const ReplayRound &recorded, FILE *cast, GifRenderer *gifOut, CastReport &out)
+            : round(recorded), file(cast), gif(gifOut), screen(ansi, gifOut), report(out)
+        {
+            frame.resize(round.width, round.height);
+            for (const auto &pair : CAST_PAIRS)
+            {
+                ansi.setPair(pair[0], pair[1], -1);
+                if (gif)
+                    gif->setPair(pair[0], pair[1]);
+            }
+            // The HUD sits on the top border; in the GIF it stays part of the border.
+            if (gif)
+                gif->setPair(Config::COLOR_HUD, CAST_PAIRS[4][1]);
+        }
+
+        bool header()
+        {
+            fprintf(file, "{\"version\": 2, \"width\": %d, \"height\": %d, \"title\": \"tron replay\", \"env\": {\"TERM\": \"xterm-256color\"}}\n",
+                    round.width, round.height);
+            return !ferror(file);
+        }
+
+        template <typename Engine>
+        void show(const Engine &engine, long micros, long holdMicros, const char *result)
+        {
+            drawArena();
+            for (int i = 0; i < engine.getPlayerCount(); i++)
+                engine.getPlayer(i)->draw(frame, 0, 0);
+            if (result)
+                frame.print(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Tick: %ld ║ %s ╠", engine.getTicks(), result);
+            else
+                frame.print(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Tick: %ld ╠", engine.getTicks());
+
+            if (gif)
+                gif->setDelay(static_cast<int>(holdMicros / 10000));
+            frame.flush(screen);
+
+            event.clear();
+            char stamp[32];
+            snprintf(stamp, sizeof(stamp), "[%.6f, \"o\", \"", micros / 1e6);
+            event += stamp;
+            // The cursor stays hidden for the whole recording.
+            if (report.frames == 0)
+                escape("\033[?25l");
+            escape(ansi.lastFrame());
+            event += "\"]\n";
+            fwrite(event.data(), 1, event.size(), file);
+            report.castBytes += static_cast<long>(event.size());
+            report.frames++;
+        }
+    };
+
+    template <typename Engine>
+    void play(Engine &engine, const ReplayRound &round, CastWriter &writer, CastReport &report)
+    {
+        std::pair<int, int> spawns[Config::REPLAY_MAX_PLAYERS];
+        Direction dirs[Config::REPLAY_MAX_PLAYERS];
+        for (int i = 0; i < round.players; i++)
+        {
+            spawns[i] = {round.spawns[i].x, round.spawns[i].y};
+            dirs[i] = round.spawns[i].dir;
+        }
+        engine.setObstacles(round.map);
+        engine.respawn(spawns, dirs);
+
+        const long interval = round.tickMicros;
+        writer.show(engine, 0, interval, nullptr);
+        TickResult result = {false, Config::WINNER_TIE};
+        long ticks = 0;
+        while (!result.finished && ticks < round.getTicks())
+        {
+            result = engine.tick();
+            ticks++;
+            if (!result.finished)
+                writer.show(engine, ticks * interval, interval, nullptr);
+        }
+
+        report.ticks = ticks;
+        report.winner = result.winner;
+        report.matches = result.finished && ticks == round.getTicks() && result.winner == round.winner;
+        const char *text = result.finished ? RESULTS[round.mode][result.winner == Config::WINNER_PLAYER1 || result.winner == Config::WINNER_PLAYER2 ? result.winner : 0]
+                                           : "Recording ends";
+        writer.show(engine, ticks * interval, Config::CAST_END_HOLD_MICROS, text);
+    }
+}
+
+bool exportCast(const ReplayRound &round, const std::string &castPath, const std::string &gifPath, CastReport &report,
+                std::string &error)
+{
+    report = CastReport();
+    if (round.players < 1 || round.players > 2)
+    {
+        error = "only rounds of one or two riders can be exported";
+        return false;
+    }
+
+    FILE *cast = fopen(castPath.c_str(), "wb");
+    if (!cast)
+    {
+        error = "cannot write " + castPath + ": " + strerror(errno);
+        return false;
+    }
+    FILE *gifFile = nullptr;
+    if (!gifPath.empty())
+    {
+        gifFile = fopen(gifPath.c_str(), "wb");
+        if (!gifFile)
+        {
+            error = "cannot write " + gifPath + ": " + strerror(errno);
+            fclose(cast);
+            return false;
+        }
+    }
+
+    GifRenderer gif(gifFile);
+    CastWriter writer(round, cast, gifFile ? &gif : nullptr, report);
+    bool ok = writer.header();
+
+    Player first(0, 0, Config::PLAYER_1_ID);
+    Player second(0, 0, Config::PLAYER_2_ID);
+    first.setTrailLimit(round.trailLength);
+    second.setTrailLimit(round.trailLength);
+    if (round.players == 1)
+    {
+        TickEngine<ReplayController> engine(round.width, round.height, ReplayController(first, round, 0));
+        play(engine, round, writer, report);
+    }
+    else
+    {
+        TickEngine<ReplayController, ReplayController> engine(round.width, round.height, ReplayController(first, round, 0),
+                                                              ReplayController(second, round, 1));
+        play(engine, round, writer, report);
+    }
+
+    if (gifFile)
+    {
+        ok = gif.finish() && ok;
+        report.gifBytes = gif.getBytes();
+        ok = fclose(gifFile) == 0 && ok;
+    }
+    ok = !ferror(cast) && ok;
+    ok = fclose(cast) == 0 && ok;
+    if (!ok)
+        error = "cannot write the exported files";
+    return ok;
+}
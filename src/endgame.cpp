@@ -0,0 +1,363 @@
+#include "../include/endgame.h"
+#include "../include/rng.h"
+#include <algorithm>
+
+namespace
+{
+    const Direction kDirections[] = {UP, DOWN, LEFT, RIGHT};
+    const uint64_t KEY_SEED = 0x9e3779b97f4a7c15ULL;
+}
+
+EndgameSolver::EndgameSolver()
+    : width(0), height(0), generation(0), hash(0), seenStamp(0), nodes(0), maxNodes(0), stopped(false), bestLength(0),
+      planNext(0), planFrom(-1)
+{
+}
+
+void EndgameSolver::reserve(int w, int h)
+{
+    if (w == width && h == height)
+        return;
+
+    size_t cells = static_cast<size_t>(w) * h;
+    width = w;
+    height = h;
+    board.assign(cells, Config::CELL_WALL);
+    shade.resize(cells);
+    cellKeys.resize(cells);
+    headKeys.resize(cells);
+
+    Rng keys(KEY_SEED);
+    for (size_t cell = 0; cell < cells; cell++)
+    {
+        shade[cell] = static_cast<uint8_t>((cell % w + cell / w) & 1);
+        cellKeys[cell] = keys.next();
+        headKeys[cell] = keys.next();
+    }
+
+    table.assign(Config::ENDGAME_TABLE_SIZE, Entry());
+    generation = 0;
+    seen.assign(cells, 0);
+    seenStamp = 0;
+    queue.resize(cells);
+    plan.clear();
+    plan.reserve(cells);
+    planFrom = -1;
+}
+
+int EndgameSolver::offset(Direction dir) const
+{
+    switch (dir)
+    {
+    case UP:
+        return -width;
+    case DOWN:
+        return width;
+    case LEFT:
+        return -1;
+    case RIGHT:
+        return 1;
+    }
+    return 0;
+}
+
+bool EndgameSolver::isChoke(int cell) const
+{
+    // Same ring test as RegionMap: free sides in separate runs of the ring may only meet through the cell.
+    const int ring[] = {-width, -width + 1, 1, width + 1, width, width - 1, -1, -width - 1};
+    int blocked = -1;
+    for (int k = 0; k < 8; k++)
+    {
+        if (board[cell + ring[k]] != Config::CELL_EMPTY)
+            blocked = k;
+    }
+    if (blocked < 0)
+        return false;
+
+    int runs = 0;
+    bool runHasSide = false;
+    for (int step = 1; step <= 8; step++)
+    {
+        int k = (blocked + step) % 8;
+        if (board[cell + ring[k]] != Config::CELL_EMPTY)
+        {
+            runHasSide = false;
+            continue;
+        }
+        if (k % 2 == 0 && !runHasSide)
+        {
+            runs++;
+            runHasSide = true;
+        }
+    }
+    return runs > 1;
+}
+
+int EndgameSolver::parityBound(const int counts[2], int from) const
+{
+    // Each step flips the checkerboard colour, so the path can use at most one more
+    // of the other colour than of the colour it starts on.
+    int other = counts[from ^ 1];
+    int same = counts[from];
+    return 2 * std::min(other, same) + (other > same ? 1 : 0);
+}
+
+EndgameSolver::Reach EndgameSolver::reachAround(int cell)
+{
+    Reach reach = {{0, 0}, 0, true};
+    if (++seenStamp == 0)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        seenStamp = 1;
+    }
+
+    int components = 0;
+    for (Direction dir : kDirections)
+    {
+        int start = cell + offset(dir);
+        if (board[start] != Config::CELL_EMPTY || seen[start] == seenStamp)
+            continue;
+
+        int counts[2] = {0, 0};
+        int head = 0, tail = 0;
+        queue[tail++] = start;
+        seen[start] = seenStamp;
+        while (head < tail)
+        {
+            int current = queue[head++];
+            counts[shade[current]]++;
+            const int neighbours[] = {current - width, current + width, current - 1, current + 1};
+            for (int next : neighbours)
+            {
+                if (board[next] == Config::CELL_EMPTY && seen[next] != seenStamp)
+                {
+                    seen[next] = seenStamp;
+                    queue[tail++] = next;
+                }
+            }
+        }
+
+        nodes += tail;
+        reach.counts[0] += counts[0];
+        reach.counts[1] += counts[1];
+        reach.bound = std::max(reach.bound, parityBound(counts, shade[cell]));
+        components++;
+    }
+    reach.connected = components <= 1;
+    return reach;
+}
+
+EndgameSolver::Reach EndgameSolver::rootReach(int head, const RegionMap &regions)
+{
+    // The caller's region map already knows the head's region unless the head sits on a split.
+    int label = 0, x = 0, y = 0;
+    for (Direction dir : kDirections)
+    {
+        int cell = head + offset(dir);
+        if (board[cell] != Config::CELL_EMPTY)
+            continue;
+        x = cell % width;
+        y = cell / width;
+        if (label != 0 && regions.labelAt(x, y) != label)
+            return reachAround(head);
+        label = regions.labelAt(x, y);
+    }
+
+    Reach reach = {{0, 0}, 0, true};
+    if (label != 0)
+    {
+        reach.counts[1] = regions.oddSizeAt(x, y);
+        reach.counts[0] = regions.sizeAt(x, y) - reach.counts[1];
+        reach.bound = parityBound(reach.counts, shade[head]);
+    }
+    return reach;
+}
+
+int EndgameSolver::expand(int head, const Reach &reach, Child children[4])
+{
+    int count = 0;
+    for (Direction dir : kDirections)
+    {
+        int cell = head + offset(dir);
+        if (board[cell] != Config::CELL_EMPTY)
+            continue;
+
+        Child &child = children[count++];
+        child.cell = cell;
+        child.dir = dir;
+
+        // Off a choke the region just loses this cell; otherwise it has to be measured again.
+        board[cell] = Config::CELL_SELF;
+        if (reach.connected && !isChoke(cell))
+        {
+            child.reach = reach;
+            child.reach.counts[shade[cell]]--;
+            child.reach.bound = parityBound(child.reach.counts, shade[cell]);
+        }
+        else
+        {
+            child.reach = reachAround(cell);
+        }
+
+        child.degree = 0;
+        for (Direction next : kDirections)
+            child.degree += board[cell + offset(next)] == Config::CELL_EMPTY;
+        board[cell] = Config::CELL_EMPTY;
+    }
+
+    std::sort(children, children + count, [](const Child &a, const Child &b)
+              { return a.reach.bound != b.reach.bound ? a.reach.bound > b.reach.bound : a.degree < b.degree; });
+    return count;
+}
+
+int EndgameSolver::longest(int head, const Reach &reach, int alpha)
+{
+    nodes++;
+    if (nodes >= maxNodes || (nodes % Config::BOT_DEADLINE_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline))
+        stopped = true;
+    if (stopped || reach.bound == 0)
+        return 0;
+
+    uint64_t key = hash ^ headKeys[head];
+    Entry &entry = table[key & (Config::ENDGAME_TABLE_SIZE - 1)];
+    if (entry.generation == generation && entry.key == key)
+        return entry.length;
+
+    Child children[4];
+    int count = expand(head, reach, children);
+
+    // Results at or below alpha are only upper bounds, so only longer ones are stored.
+    int best = 0;
+    int bestCell = -1;
+    for (int i = 0; i < count && best < reach.bound; i++)
+    {
+        const Child &child = children[i];
+        if (1 + child.reach.bound <= std::max(best, alpha))
+            break;
+
+        board[child.cell] = Config::CELL_SELF;
+        hash ^= cellKeys[child.cell];
+        int length = 1 + longest(child.cell, child.reach, std::max(best, alpha) - 1);
+        board[child.cell] = Config::CELL_EMPTY;
+        hash ^= cellKeys[child.cell];
+
+        if (length > best)
+        {
+            best = length;
+            bestCell = child.cell;
+        }
+        if (stopped)
+            return best;
+    }
+
+    if (best > alpha)
+    {
+        entry.key = key;
+        entry.generation = generation;
+        entry.length = best;
+        entry.move = bestCell;
+    }
+    return best;
+}
+
+void EndgameSolver::recordPlan(int head, int first)
+{
+    // Walks the stored best moves; the plan stops early where an entry was overwritten.
+    plan.clear();
+    planNext = 0;
+    planFrom = head;
+
+    uint64_t line = 0;
+    int cell = first;
+    while (cell >= 0)
+    {
+        plan.push_back(cell);
+        line ^= cellKeys[cell];
+        uint64_t key = line ^ headKeys[cell];
+        const Entry &entry = table[key & (Config::ENDGAME_TABLE_SIZE - 1)];
+        cell = entry.generation == generation && entry.key == key ? entry.move : -1;
+    }
+}
+
+bool EndgameSolver::followPlan(int head, Direction &dir)
+{
+    if (head != planFrom || planNext >= plan.size())
+        return false;
+    for (size_t i = planNext; i < plan.size(); i++)
+    {
+        if (board[plan[i]] != Config::CELL_EMPTY)
+            return false;
+    }
+
+    int next = plan[planNext++];
+    for (Direction candidate : kDirections)
+    {
+        if (head + offset(candidate) == next)
+            dir = candidate;
+    }
+    planFrom = next;
+    bestLength = static_cast<int>(plan.size() - planNext) + 1;
+    return true;
+}
+
+Direction EndgameSolver::bestMove(const Grid &grid, const RegionMap &regions, int selfX, int selfY, Direction selfDir, long nodeBudget,
+                                  std::chrono::steady_clock::time_point until)
+{
+    reserve(grid.getWidth(), grid.getHeight());
+    board = grid.getCells();
+    nodes = 0;
+    stopped = false;
+
+    int head = selfY * width + selfX;
+    Direction planned;
+    if (followPlan(head, planned))
+        return planned;
+    planFrom = -1;
+
+    maxNodes = nodeBudget;
+    deadline = until;
+    hash = 0;
+    if (++generation == 0)
+    {
+        std::fill(table.begin(), table.end(), Entry());
+        generation = 1;
+    }
+
+    board[head] = Config::CELL_SELF;
+    Reach reach = rootReach(head, regions);
+    Child children[4];
+    int count = expand(head, reach, children);
+
+    Direction bestDir = count > 0 ? children[0].dir : selfDir;
+    int bestCell = -1;
+    bestLength = 0;
+    for (int i = 0; i < count && bestLength < reach.bound; i++)
+    {
+        const Child &child = children[i];
+        if (1 + child.reach.bound <= bestLength)
+            break;
+
+        board[child.cell] = Config::CELL_SELF;
+        hash ^= cellKeys[child.cell];
+        int length = 1 + longest(child.cell, child.reach, bestLength - 1);
+        board[child.cell] = Config::CELL_EMPTY;
+        hash ^= cellKeys[child.cell];
+
+        if (length > bestLength)
+        {
+            bestLength = length;
+            bestDir = child.dir;
+            bestCell = child.cell;
+        }
+        if (stopped)
+            break;
+    }
+
+    if (!stopped && bestCell >= 0)
+    {
+        recordPlan(head, bestCell);
+        planNext = 1;
+        planFrom = bestCell;
+    }
+    return bestDir;
+}
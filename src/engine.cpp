@@ -0,0 +1,83 @@
+#include "../include/engine.h"
+#include <ncurses.h>
+
+bool HumanController::handleKey(int ch)
+{
+    Direction dir;
+    if (keys == KEYS_ARROWS)
+    {
+        switch (ch)
+        {
+        case KEY_UP:
+            dir = UP;
+            break;
+        case KEY_DOWN:
+            dir = DOWN;
+            break;
+        case KEY_LEFT:
+            dir = LEFT;
+            break;
+        case KEY_RIGHT:
+            dir = RIGHT;
+            break;
+        default:
+            return false;
+        }
+    }
+    else
+    {
+        switch (ch)
+        {
+        case 'w':
+        case 'W':
+            dir = UP;
+            break;
+        case 's':
+        case 'S':
+            dir = DOWN;
+            break;
+        case 'a':
+        case 'A':
+            dir = LEFT;
+            break;
+        case 'd':
+        case 'D':
+            dir = RIGHT;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    rider->setDirection(dir);
+    return true;
+}
+
+void HumanController::respawn(int x, int y, Direction dir)
+{
+    rider->respawn(x, y, dir);
+}
+
+void BotController::respawn(int x, int y, Direction dir)
+{
+    bot->respawn(x, y, dir);
+}
+
+void TickCore::occupy(const Player &player)
+{
+    for (const auto &segment : player.getTrail())
+        occupied.set(segment.x, segment.y, Config::CELL_WALL);
+}
+
+TickResult TickCore::outcome(int playerCount, int aliveCount, int survivorId)
+{
+    TickResult result = {false, Config::WINNER_TIE};
+    if (aliveCount == 0)
+        result.finished = true;
+    else if (playerCount > 1 && aliveCount == 1)
+    {
+        result.finished = true;
+        result.winner = survivorId;
+    }
+    return result;
+}
@@ -0,0 +1,336 @@
+#include "../include/evaluator.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace
+{
+    const int dx[] = {0, 0, -1, 1};
+    const int dy[] = {-1, 1, 0, 0};
+    const int LOOK_AHEAD_STEPS = 10;
+}
+
+void CandidateBatch::clear()
+{
+    x.clear();
+    y.clear();
+    dir.clear();
+}
+
+void CandidateBatch::reserve(size_t n)
+{
+    for (std::vector<int> *column : {&x, &y, &dir, &space, &wallDistance, &lookAhead, &exits, &opponentDistance, &learned, &score})
+        column->reserve(n);
+}
+
+void CandidateBatch::add(int cx, int cy, Direction d)
+{
+    x.push_back(cx);
+    y.push_back(cy);
+    dir.push_back(d);
+}
+
+BotEvaluator::BotEvaluator() : map(nullptr), synced(false), fading(false), now(0), visitStamp(0), nodes(0), outOfTime(false),
+                               network(nullptr) {}
+
+void BotEvaluator::reserve(int width, int height)
+{
+    if (grid.getWidth() == width && grid.getHeight() == height)
+        return;
+
+    grid.resize(width, height);
+    if (map)
+        grid.setObstacles(*map);
+    regions.reserve(width, height);
+    freeAt.assign(grid.getCells().size(), 0);
+    visited.assign(grid.getCells().size(), 0);
+    visitStamp = 0;
+    queue.resize(grid.getCells().size());
+    depth.resize(grid.getCells().size());
+    synced = false;
+}
+
+void BotEvaluator::setMap(const ArenaMap *newMap)
+{
+    if (newMap == map)
+        return;
+    map = newMap;
+    grid.resize(grid.getWidth(), grid.getHeight());
+    if (map)
+        grid.setObstacles(*map);
+    synced = false;
+}
+
+void BotEvaluator::setNetwork(const NnueNetwork *newNetwork)
+{
+    network = newNetwork && newNetwork->isLoaded() ? newNetwork : nullptr;
+    synced = false;
+}
+
+bool BotEvaluator::extends(const Trail &trail, const TrailMark &previous) const
+{
+    // One move since the last look: at most one cell retired and the old head still there.
+    if (previous.total == 0 || trail.getTotal() < previous.total || trail.getRetired() < previous.retired ||
+        trail.getRetired() > previous.retired + 1 || trail.getRetired() >= previous.total)
+        return false;
+    const TrailSegment &first = trail.front();
+    const TrailSegment &last = trail[previous.total - 1 - trail.getRetired()];
+    if (trail.getRetired() == 0 && first.y * grid.getWidth() + first.x != previous.first)
+        return false;
+    return last.y * grid.getWidth() + last.x == previous.last;
+}
+
+void BotEvaluator::mark(const Trail &trail, TrailMark &target) const
+{
+    target.total = trail.getTotal();
+    target.retired = trail.getRetired();
+    target.first = trail.empty() ? -1 : trail.front().y * grid.getWidth() + trail.front().x;
+    target.last = trail.empty() ? -1 : trail.back().y * grid.getWidth() + trail.back().x;
+}
+
+// Marks the trail cells from absolute index `from` on. A fading trail of limit L drops
+// cell a when its owner has made a + L + 1 cells; the bot can enter it one move later.
+void BotEvaluator::stamp(const Trail &trail, long from, uint8_t value, long clockOffset, bool fillRegions)
+{
+    long limit = static_cast<long>(trail.getLimit());
+    for (long a = std::max(from, trail.getRetired()); a < trail.getTotal(); a++)
+    {
+        const TrailSegment &segment = trail[a - trail.getRetired()];
+        bool wasFree = grid.isFree(segment.x, segment.y);
+        grid.set(segment.x, segment.y, value);
+        freeAt[segment.y * grid.getWidth() + segment.x] = limit > 0 ? a + limit + 2 + clockOffset : LONG_MAX;
+        if (wasFree && fillRegions)
+            regions.fill(segment.x, segment.y);
+        if (wasFree && network)
+        {
+            network->setCell(selfAccumulator, segment.x, segment.y, true);
+            network->setCell(opponentAccumulator, segment.x, segment.y, true);
+        }
+    }
+}
+
+void BotEvaluator::retire(const Trail &trail, const TrailMark &previous)
+{
+    if (trail.getRetired() > previous.retired)
+    {
+        grid.set(trail.getRetiredX(), trail.getRetiredY(), Config::CELL_EMPTY);
+        if (network)
+        {
+            network->setCell(selfAccumulator, trail.getRetiredX(), trail.getRetiredY(), false);
+            network->setCell(opponentAccumulator, trail.getRetiredX(), trail.getRetiredY(), false);
+        }
+    }
+}
+
+void BotEvaluator::prepare(const Player &self, const Player &opponent, int width, int height)
+{
+    if (grid.getWidth() != width || grid.getHeight() != height)
+        reserve(width, height);
+
+    const Trail &selfTrail = self.getTrail();
+    const Trail &opponentTrail = opponent.getTrail();
+    bool wasFading = fading;
+    fading = selfTrail.getLimit() > 0 || opponentTrail.getLimit() > 0;
+    now = selfTrail.getTotal();
+    // Both riders move every tick, so the opponent's clock runs at a fixed offset from ours.
+    long opponentOffset = selfTrail.getTotal() - opponentTrail.getTotal();
+
+    // Between ticks the trails only grow at the head (and shrink at a fading tail), so
+    // only those cells change.
+    if (synced && fading == wasFading && extends(selfTrail, selfMark) && extends(opponentTrail, opponentMark))
+    {
+        retire(selfTrail, selfMark);
+        retire(opponentTrail, opponentMark);
+        stamp(selfTrail, selfMark.total, Config::CELL_SELF, 0, !fading);
+        stamp(opponentTrail, opponentMark.total, Config::CELL_OPPONENT, opponentOffset, !fading);
+        if (network)
+        {
+            network->moveHeads(selfAccumulator, grid, self.getX(), self.getY(), opponent.getX(), opponent.getY());
+            network->moveHeads(opponentAccumulator, grid, opponent.getX(), opponent.getY(), self.getX(), self.getY());
+        }
+    }
+    else
+    {
+        grid.clear();
+        stamp(selfTrail, 0, Config::CELL_SELF, 0, false);
+        stamp(opponentTrail, 0, Config::CELL_OPPONENT, opponentOffset, false);
+        if (!fading)
+            regions.rebuild(grid);
+        if (network)
+        {
+            network->refresh(selfAccumulator, grid, self.getX(), self.getY(), opponent.getX(), opponent.getY());
+            network->refresh(opponentAccumulator, grid, opponent.getX(), opponent.getY(), self.getX(), self.getY());
+        }
+        synced = true;
+    }
+
+    mark(selfTrail, selfMark);
+    mark(opponentTrail, opponentMark);
+}
+
+bool BotEvaluator::separated(int selfX, int selfY, int opponentX, int opponentY) const
+{
+    // Fading trails reopen the gaps between regions.
+    if (fading)
+        return false;
+    for (int i = 0; i < 4; i++)
+    {
+        if (!grid.isFree(selfX + dx[i], selfY + dy[i]))
+            continue;
+        int label = regions.labelAt(selfX + dx[i], selfY + dy[i]);
+        for (int j = 0; j < 4; j++)
+        {
+            if (grid.isFree(opponentX + dx[j], opponentY + dy[j]) && regions.labelAt(opponentX + dx[j], opponentY + dy[j]) == label)
+                return false;
+        }
+    }
+    return true;
+}
+
+int BotEvaluator::floodFill(int startX, int startY, long maxNodes)
+{
+    if (++visitStamp == 0)
+    {
+        std::fill(visited.begin(), visited.end(), 0);
+        visitStamp = 1;
+    }
+
+    int width = grid.getWidth();
+    const std::vector<uint8_t> &cells = grid.getCells();
+
+    int head = 0, tail = 0;
+    int start = startY * width + startX;
+    queue[tail] = start;
+    depth[tail++] = 1;
+    visited[start] = visitStamp;
+
+    int accessibleCells = 0;
+    while (head < tail && accessibleCells < maxNodes)
+    {
+        if (!outOfTime && nodes % Config::BOT_DEADLINE_CHECK_INTERVAL == 0)
+            outOfTime = std::chrono::steady_clock::now() >= deadline;
+        if (outOfTime)
+            break;
+
+        int cell = queue[head];
+        int arrival = depth[head++] + 1;
+        accessibleCells++;
+        nodes++;
+
+        // A fading trail cell counts once the rider could only reach it after it has gone.
+        const int neighbours[] = {cell - width, cell + width, cell - 1, cell + 1};
+        for (int next : neighbours)
+        {
+            if (visited[next] != visitStamp &&
+                (cells[next] == Config::CELL_EMPTY || (fading && cells[next] != Config::CELL_WALL && freeAt[next] <= now + arrival)))
+            {
+                visited[next] = visitStamp;
+                queue[tail] = next;
+                depth[tail++] = arrival;
+            }
+        }
+    }
+
+    return accessibleCells;
+}
+
+long BotEvaluator::evaluate(CandidateBatch &batch, const BotWeights &weights, Direction currentDir, int opponentX, int opponentY,
+                            long maxNodesPerCandidate, std::chrono::steady_clock::time_point until)
+{
+    const int n = static_cast<int>(batch.size());
+    batch.space.resize(n);
+    batch.wallDistance.resize(n);
+    batch.lookAhead.resize(n);
+    batch.exits.resize(n);
+    batch.opponentDistance.resize(n);
+    batch.learned.resize(n);
+    batch.score.resize(n);
+
+    nodes = regions.takeWork();
+    outOfTime = false;
+    deadline = until;
+
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+
+    for (int i = 0; i < n; i++)
+    {
+        if (!fading && grid.isFree(batch.x[i], batch.y[i]))
+        {
+            batch.space[i] = static_cast<int>(std::min<long>(regions.sizeAt(batch.x[i], batch.y[i]), maxNodesPerCandidate));
+            nodes++;
+        }
+        else
+        {
+            batch.space[i] = floodFill(batch.x[i], batch.y[i], maxNodesPerCandidate);
+        }
+
+        int steps = 0;
+        int checkX = batch.x[i], checkY = batch.y[i];
+        for (int step = 0; step < LOOK_AHEAD_STEPS; step++)
+        {
+            checkX += dx[batch.dir[i]];
+            checkY += dy[batch.dir[i]];
+            if (!grid.isFree(checkX, checkY))
+                break;
+            steps++;
+        }
+        batch.lookAhead[i] = steps;
+
+        int exits = 0;
+        for (int j = 0; j < 4; j++)
+            exits += grid.isFree(batch.x[i] + dx[j], batch.y[i] + dy[j]);
+        batch.exits[i] = exits;
+
+        batch.learned[i] = 0;
+        if (network && weights.network != 0)
+        {
+            NnueAccumulator self = selfAccumulator;
+            NnueAccumulator other = opponentAccumulator;
+            grid.set(batch.x[i], batch.y[i], Config::CELL_SELF);
+            network->setCell(self, batch.x[i], batch.y[i], true);
+            network->setCell(other, batch.x[i], batch.y[i], true);
+            network->moveHeads(self, grid, batch.x[i], batch.y[i], opponentX, opponentY);
+            network->moveHeads(other, grid, opponentX, opponentY, batch.x[i], batch.y[i]);
+            batch.learned[i] = network->evaluate(self, other);
+            grid.set(batch.x[i], batch.y[i], Config::CELL_EMPTY);
+        }
+    }
+
+    // Branch-free scoring over the feature arrays; these loops vectorize.
+    const int *xs = batch.x.data();
+    const int *ys = batch.y.data();
+    int *wall = batch.wallDistance.data();
+    int *opponentDist = batch.opponentDistance.data();
+    for (int i = 0; i < n; i++)
+    {
+        int fromLeft = xs[i], fromRight = width - 1 - xs[i];
+        int fromTop = ys[i], fromBottom = height - 1 - ys[i];
+        wall[i] = std::min(std::min(fromLeft, fromRight), std::min(fromTop, fromBottom));
+        opponentDist[i] = std::abs(xs[i] - opponentX) + std::abs(ys[i] - opponentY);
+    }
+
+    const int *space = batch.space.data();
+    int maxSpace = 0;
+    for (int i = 0; i < n; i++)
+        maxSpace = std::max(maxSpace, space[i]);
+
+    const int *dirs = batch.dir.data();
+    const int *look = batch.lookAhead.data();
+    const int *exits = batch.exits.data();
+    const int *learned = batch.learned.data();
+    int *score = batch.score.data();
+    const BotWeights w = weights;
+    for (int i = 0; i < n; i++)
+    {
+        int straight = dirs[i] == currentDir;
+        int nearMax = space[i] * 10 >= maxSpace * 9;
+        int closeToMax = space[i] * 4 >= maxSpace * 3;
+        int keepBonus = straight * (nearMax ? w.keepStraight : (closeToMax ? w.keepNear : 0));
+
+        score[i] = space[i] * w.space + wall[i] * w.wallDistance + keepBonus + look[i] * w.lookAhead +
+                   exits[i] * w.exits + (opponentDist[i] > 5 ? w.opponentDistance : 0) + learned[i] * w.network;
+    }
+
+    return nodes;
+}
@@ -0,0 +1,135 @@
+#include "../include/framebuffer.h"
+#include "../include/renderer.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    int utf8Length(unsigned char lead)
+    {
+        if (lead < 0x80)
+            return 1;
+        if ((lead >> 5) == 0x6)
+            return 2;
+        if ((lead >> 4) == 0xe)
+            return 3;
+        if ((lead >> 3) == 0x1e)
+            return 4;
+        return 1;
+    }
+}
+
+bool Cell::operator==(const Cell &other) const
+{
+    return length == other.length && color == other.color && memcmp(glyph, other.glyph, length) == 0;
+}
+
+FrameBuffer::FrameBuffer() : width(0), height(0), capacityWidth(0), capacityHeight(0), fullRepaint(true) {}
+
+void FrameBuffer::resize(int w, int h)
+{
+    if (w > capacityWidth || h > capacityHeight)
+    {
+        capacityWidth = w > capacityWidth ? w : capacityWidth;
+        capacityHeight = h > capacityHeight ? h : capacityHeight;
+        back.assign(static_cast<size_t>(capacityWidth) * capacityHeight, BLANK_CELL);
+        front.assign(back.size(), BLANK_CELL);
+    }
+
+    width = w;
+    height = h;
+    fullRepaint = true;
+}
+
+void FrameBuffer::clear()
+{
+    for (int y = 0; y < height; y++)
+    {
+        Cell *row = &back[y * capacityWidth];
+        for (int x = 0; x < width; x++)
+            row[x] = BLANK_CELL;
+    }
+}
+
+void FrameBuffer::put(int x, int y, const char *glyph, int length, int color)
+{
+    if (x < 0 || x >= width || y < 0 || y >= height || length <= 0 || length > 4)
+        return;
+
+    Cell &cell = at(back, x, y);
+    memcpy(cell.glyph, glyph, length);
+    cell.length = static_cast<uint8_t>(length);
+    cell.color = static_cast<short>(color);
+}
+
+void FrameBuffer::print(int x, int y, int color, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprint(x, y, color, format, args);
+    va_end(args);
+}
+
+void FrameBuffer::vprint(int x, int y, int color, const char *format, va_list args)
+{
+    char text[512];
+    vsnprintf(text, sizeof(text), format, args);
+
+    for (const char *p = text; *p;)
+    {
+        int length = utf8Length(static_cast<unsigned char>(*p));
+        if (static_cast<int>(strnlen(p, length)) < length)
+            break;
+        put(x++, y, p, length, color);
+        p += length;
+    }
+}
+
+int FrameBuffer::flush(Renderer &out)
+{
+    bool repaint = fullRepaint;
+    if (fullRepaint)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+                at(front, x, y).length = 0;
+        }
+        fullRepaint = false;
+    }
+
+    // Changed cells go out as runs that share one colour, so a backend sets the
+    // attribute once per run rather than once per cell.
+    out.begin(width, height, repaint);
+    int written = 0;
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        while (x < width)
+        {
+            if (at(back, x, y) == at(front, x, y))
+            {
+                x++;
+                continue;
+            }
+
+            int runStart = x;
+            short color = at(back, x, y).color;
+            while (x < width && x - runStart < MAX_RUN)
+            {
+                const Cell &cell = at(back, x, y);
+                Cell &shown = at(front, x, y);
+                if (cell == shown || cell.color != color)
+                    break;
+                shown = cell;
+                x++;
+            }
+
+            out.run(runStart, y, &at(back, runStart, y), x - runStart);
+            written += x - runStart;
+        }
+    }
+    out.end();
+    return written;
+}
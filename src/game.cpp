@@ -1,11 +1,15 @@
 #include "../include/game.h"
 #include "../include/player.h"
+#include "../include/alloccount.h"
+#include "../include/stats.h"
 #include <unistd.h>
+#include <algorithm>
+#include <cstdarg>
 #include <cstdio>
 #include <random>
 #include <ctime>
 
-Game::Game(int w, int h) : width(w), height(h), running(false), state(PLAYING), currentGameSpeed(NORMAL), currentGameMode(SINGLE_PLAYER), currentColorScheme(0), firstStart(true), gameBot(nullptr), score(0), winner(Config::WINNER_TIE) {}
+Game::Game(int w, int h) : width(w), height(h), running(false), state(PLAYING), currentGameSpeed(NORMAL), currentGameMode(SINGLE_PLAYER), currentColorScheme(0), botDifficulty(static_cast<BotDifficulty>(Config::DEFAULT_BOT_DIFFICULTY)), network(nullptr), trailLength(Config::TRAIL_LENGTH_FULL), searchThreads(Config::BOT_SEARCH_THREADS), battleSpeed(0), firstStart(true), recordStats(true), arena(Config::MATCH_PLAYER_SLOTS, Config::MATCH_BOT_SLOTS), spawner(static_cast<uint64_t>(time(nullptr))), resuming(false), snapshotPath(MatchSnapshot::defaultPath()), suspended(false), initialized(false), viewX(0), viewY(0), score(0), winner(Config::WINNER_TIE) {}
 
 Game::~Game()
 {
@@ -29,11 +33,18 @@ void Game::init()
 
     initColors();
 
-    int termHeight, termWidth;
-    getmaxyx(stdscr, termHeight, termWidth);
-    height = termHeight;
-    width = termWidth;
+    // A loaded map or a resumed match fixes the arena size; otherwise the arena fills the terminal.
+    if (map.empty() && !resuming)
+    {
+        int termHeight, termWidth;
+        getmaxyx(stdscr, termHeight, termWidth);
+        height = termHeight;
+        width = termWidth;
+    }
     running = true;
+    suspended = false;
+    initialized = true;
+    firstStart = !resuming;
     startGame();
 }
 
@@ -52,20 +63,22 @@ void Game::startGame()
 
 void Game::showWelcomeMessage()
 {
-    clear();
+    layout();
+    frame.clear();
     drawBorders();
+    drawObstacles();
 
     int centerX = width / 2;
     int centerY = height / 2;
 
-    mvprintw(centerY - Config::WELCOME_BOX_VERTICAL_OFFSET, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-    mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║      TRON GAME       ║");
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Use ⇠⇡⇢⇣ to move   ║");
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ Avoid walls & trails ║");
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY - Config::WELCOME_BOX_VERTICAL_OFFSET, 0, "╔══════════════════════╗");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY - 2, 0, "║      TRON GAME       ║");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY - 1, 0, "╠══════════════════════╣");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY, 0, "║   Use ⇠⇡⇢⇣ to move   ║");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY + 1, 0, "║ Avoid walls & trails ║");
+    drawText(centerX - Config::MENU_BOX_HALF_WIDTH, centerY + 2, 0, "╚══════════════════════╝");
 
-    refresh();
+    present();
     sleep(Config::WELCOME_MESSAGE_DELAY_SEC);
 }
 
@@ -79,6 +92,30 @@ void Game::updateScore()
     }
 }
 
+// Reading the terminal counts as input, like the key handling in control.
+int Game::readKey()
+{
+    TickProfiler::Scope scope(STAGE_INPUT);
+    return getch();
+}
+
+// The clock stands still while paused: resuming moves the start forward by the pause.
+void Game::pause(bool paused)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (paused && state == PLAYING)
+    {
+        currentTime = now;
+        state = PAUSED;
+    }
+    else if (!paused && state == PAUSED)
+    {
+        gameStartTime += now - currentTime;
+        state = PLAYING;
+        snapshotError.clear();
+    }
+}
+
 int Game::getGameTime() const
 {
     if (state == PLAYING)
@@ -94,107 +131,250 @@ int Game::getGameTime() const
     }
 }
 
-void Game::run()
+template <typename Engine>
+void Game::respawn(Engine &engine)
 {
-    int actualWidth, actualHeight;
-    getmaxyx(stdscr, actualHeight, actualWidth);
+    std::pair<int, int> spawns[Config::NUM_SIDES];
+    Direction dirs[Config::NUM_SIDES];
 
-    width = actualWidth;
-    height = actualHeight;
-
-    if (currentGameMode == SINGLE_PLAYER)
+    // Map spawns are shared out evenly from a random starting point.
+    const std::vector<MapSpawn> &mapSpawns = map.getSpawns();
+    if (static_cast<int>(mapSpawns.size()) >= engine.getPlayerCount())
     {
-        int randomSide = rand() % Config::NUM_SIDES;
-        auto spawnPos = getRandomPositionOnSide(randomSide, actualWidth, actualHeight);
-        Direction safeDir = getSafeDirection(randomSide);
-        Player player(spawnPos.first, spawnPos.second, Config::PLAYER_1_ID, safeDir);
-        player.initializeTrail();
-
-        while (running)
+        int count = static_cast<int>(mapSpawns.size());
+        int start = static_cast<int>(spawner.next() % static_cast<uint64_t>(count));
+        for (int i = 0; i < engine.getPlayerCount(); i++)
         {
-            handleInput(player);
-            update(player);
-            render(player);
-            usleep(currentGameSpeed);
+            const MapSpawn &spawn = mapSpawns[(start + i * count / engine.getPlayerCount()) % count];
+            spawns[i] = {spawn.x, spawn.y};
+            dirs[i] = spawn.dir;
         }
     }
-    else if (currentGameMode == TWO_PLAYER)
+    else
     {
-        int side1 = rand() % Config::NUM_SIDES;
-        int side2 = (side1 + 2) % Config::NUM_SIDES;
+        // Opposite sides first, then the remaining two.
+        int first = static_cast<int>(spawner.next() % Config::NUM_SIDES);
+        for (int i = 0; i < engine.getPlayerCount() && i < Config::NUM_SIDES; i++)
+        {
+            int side = (first + (i % 2) * 2 + i / 2) % Config::NUM_SIDES;
+            spawns[i] = getRandomPositionOnSide(side, width, height);
+            dirs[i] = getSafeDirection(side);
+        }
+    }
+    engine.respawn(spawns, dirs);
+    beginRecording(engine);
+}
 
-        auto p1_pos = getRandomPositionOnSide(side1, actualWidth, actualHeight);
-        auto p2_pos = getRandomPositionOnSide(side2, actualWidth, actualHeight);
+template <typename Engine>
+void Game::beginRecording(const Engine &engine)
+{
+    if (!recorder.isOpen())
+        return;
+    const Player *riders[Config::REPLAY_MAX_PLAYERS];
+    for (int i = 0; i < engine.getPlayerCount() && i < Config::REPLAY_MAX_PLAYERS; i++)
+        riders[i] = engine.getPlayer(i);
+    recorder.begin(currentGameMode, width, height, currentGameSpeed, trailLength, map, engine.getPlayerCount(), riders);
+}
 
-        Direction safeDir1 = getSafeDirection(side1);
-        Direction safeDir2 = getSafeDirection(side2);
-        Player player1(p1_pos.first, p1_pos.second, Config::PLAYER_1_ID, safeDir1);
-        Player player2(p2_pos.first, p2_pos.second, Config::PLAYER_2_ID, safeDir2);
+// The directions every rider moved in this tick; the round is written once it ends.
+template <typename Engine>
+void Game::record(const Engine &engine, const TickResult &result)
+{
+    if (!recorder.isOpen())
+        return;
+    const Player *riders[Config::REPLAY_MAX_PLAYERS];
+    for (int i = 0; i < engine.getPlayerCount() && i < Config::REPLAY_MAX_PLAYERS; i++)
+        riders[i] = engine.getPlayer(i);
+    recorder.tick(riders);
+    if (result.finished)
+        recorder.end(result.winner);
+}
 
-        player1.initializeTrail();
-        player2.initializeTrail();
+// Puts a loaded snapshot in place of a fresh round. The match comes back paused, on the
+// tick it was saved at, with the spawn generator where it was.
+template <typename Engine>
+bool Game::resume(Engine &engine)
+{
+    if (!resuming)
+        return false;
+    resuming = false;
+    if (!resumed.restore(engine))
+        return false;
+    spawner.seed(resumed.spawner);
+    score = resumed.score;
+    state = PAUSED;
+    currentTime = std::chrono::steady_clock::now();
+    gameStartTime = currentTime - std::chrono::microseconds(resumed.elapsedMicros);
+    return true;
+}
 
-        while (running)
+// Saves the paused match and leaves the game.
+template <typename Engine>
+void Game::suspend(Engine &engine)
+{
+    MatchSnapshot snapshot;
+    snapshot.mode = currentGameMode;
+    snapshot.tickMicros = currentGameSpeed;
+    snapshot.trailLength = trailLength;
+    snapshot.battleSpeed = battleSpeed;
+    snapshot.score = score;
+    snapshot.elapsedMicros = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - gameStartTime).count();
+    snapshot.spawner = spawner.getState();
+    snapshot.map = map;
+    snapshot.capture(engine);
+    if (snapshot.save(snapshotPath, snapshotError))
+    {
+        suspended = true;
+        stop();
+    }
+}
+
+// Ticks fall due at the game speed whatever the terminal does: ticks that came due while
+// a frame was going out run back to back without drawing, and the pacer spaces frames
+// out (and drops to ASCII trails) while output cannot keep up.
+template <typename Engine>
+void Game::play(Engine &engine)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::microseconds(currentGameSpeed);
+
+    if (!resume(engine))
+        respawn(engine);
+    pacer.reset(currentGameSpeed);
+    Clock::time_point nextTick = Clock::now();
+
+    while (running)
+    {
+        // After a long stall, such as a suspended terminal, start again from now.
+        Clock::time_point now = Clock::now();
+        if (nextTick + interval * Config::PACER_CATCH_UP_TICKS < now)
+            nextTick = now;
+
+        bool draw = false;
+        while (running && nextTick <= now)
         {
-            handleInputTwoPlayer(player1, player2);
-            updateTwoPlayer(player1, player2);
-            renderTwoPlayer(player1, player2);
-            usleep(currentGameSpeed);
+            draw = step(engine, readKey()) || draw;
+            nextTick += interval;
         }
+        if (draw)
+            render(engine);
+
+        auto idle = std::chrono::duration_cast<std::chrono::microseconds>(nextTick - Clock::now()).count();
+        if (idle > 0)
+            usleep(static_cast<useconds_t>(idle));
     }
-    else if (currentGameMode == VS_BOT)
+}
+
+// Bot battles keep two clocks: ticks fall due at the game speed times the battle speed
+// (back to back when uncapped) and frames at most every BATTLE_FRAME_MICROS, so a fast
+// battle skips frames instead of slowing down. The pacer stretches the frame interval
+// on a slow terminal. The tick that ends a round is always drawn.
+template <typename Engine>
+void Game::watch(Engine &engine)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto frameInterval = std::chrono::microseconds(Config::BATTLE_FRAME_MICROS);
+
+    if (!resume(engine))
+        respawn(engine);
+    pacer.reset(Config::BATTLE_FRAME_MICROS);
+    Clock::time_point nextTick = Clock::now();
+    Clock::time_point nextFrame = nextTick;
+
+    while (running)
     {
-        int side1 = rand() % Config::NUM_SIDES;
-        int side2 = (side1 + 2) % Config::NUM_SIDES;
-        if (!gameBot)
+        control(engine, readKey());
+
+        Clock::time_point now = Clock::now();
+        int speed = Config::BATTLE_SPEEDS[battleSpeed];
+        bool ended = false;
+        if (state == PLAYING && speed == 0)
         {
-            auto bot_pos = getRandomPositionOnSide(side2, actualWidth, actualHeight);
-            Direction safeDir2 = getSafeDirection(side2);
-            gameBot = new Bot(bot_pos.first, bot_pos.second, safeDir2);
-            gameBot->getPlayer()->initializeTrail();
+            do
+                ended = advance(engine);
+            while (!ended && Clock::now() < nextFrame);
+            now = Clock::now();
+        }
+        else if (state == PLAYING)
+        {
+            // After a restart or a stall, start again from now rather than racing to catch up.
+            auto interval = std::chrono::microseconds(currentGameSpeed / speed);
+            if (nextTick + frameInterval < now)
+                nextTick = now;
+            while (!ended && nextTick <= now)
+            {
+                ended = advance(engine);
+                nextTick += interval;
+            }
         }
 
-        auto p1_pos = getRandomPositionOnSide(side1, actualWidth, actualHeight);
-        Direction safeDir1 = getSafeDirection(side1);
-        Player player(p1_pos.first, p1_pos.second, Config::PLAYER_1_ID, safeDir1);
-        player.initializeTrail();
-
-        while (running)
+        if (ended || now >= nextFrame)
         {
-            handleInputVsBot(player, *gameBot);
-            updateVsBot(player, *gameBot);
-            renderVsBot(player, *gameBot);
-            usleep(currentGameSpeed);
+            render(engine);
+            nextFrame = now + frameInterval * pacer.getTicksPerFrame();
         }
+
+        if (state == PLAYING && speed == 0)
+            continue;
+        Clock::time_point wake = state == PLAYING ? std::min(nextTick, nextFrame) : nextFrame;
+        auto idle = std::chrono::duration_cast<std::chrono::microseconds>(wake - Clock::now()).count();
+        if (idle > 0)
+            usleep(static_cast<useconds_t>(idle));
+    }
+}
+
+// One battle tick; the score counts ticks rather than seconds.
+template <typename Engine>
+bool Game::advance(Engine &engine)
+{
+    TickProfiler::Scope scope(STAGE_SIMULATION);
+    updateScore();
+    TickResult result = engine.tick();
+    TickProfiler::countTick();
+    record(engine, result);
+    score = static_cast<int>(engine.getTicks());
+    if (result.finished)
+        gameOver(result.winner);
+    return result.finished;
+}
+
+// One tick of play; true when a frame is due. A round ending or restarting is drawn at once.
+template <typename Engine>
+bool Game::step(Engine &engine, int ch)
+{
+    GameState before = state;
+    control(engine, ch);
+
+    if (state == PLAYING)
+    {
+        TickProfiler::Scope scope(STAGE_SIMULATION);
+        updateScore();
+        TickResult result = engine.tick();
+        TickProfiler::countTick();
+        record(engine, result);
+        if (result.finished)
+            gameOver(result.winner);
     }
+
+    return pacer.tick() || state != before || ch == KEY_RESIZE;
 }
 
-void Game::handleInput(Player &player)
+template <typename Engine>
+void Game::control(Engine &engine, int ch)
 {
-    int ch = getch();
+    TickProfiler::Scope scope(STAGE_INPUT);
     switch (ch)
     {
-    case KEY_UP:
-        if (state == PLAYING)
-            player.setDirection(UP);
-        break;
-    case KEY_DOWN:
-        if (state == PLAYING)
-            player.setDirection(DOWN);
-        break;
-    case KEY_LEFT:
-        if (state == PLAYING)
-            player.setDirection(LEFT);
-        break;
-    case KEY_RIGHT:
-        if (state == PLAYING)
-            player.setDirection(RIGHT);
+    case KEY_RESIZE:
+        layout();
         break;
     case 'r':
     case 'R':
         if (state == GAME_OVER)
         {
-            restart(&player);
+            startGame();
+            winner = Config::WINNER_TIE;
+            respawn(engine);
         }
         break;
     case 'q':
@@ -202,186 +382,344 @@ void Game::handleInput(Player &player)
     case 27:
         stop();
         break;
+    case '+':
+    case '=':
+        if (currentGameMode == BOT_BATTLE && battleSpeed < Config::NUM_BATTLE_SPEEDS - 1)
+            battleSpeed++;
+        break;
+    case '-':
+        if (currentGameMode == BOT_BATTLE && battleSpeed > 0)
+            battleSpeed--;
+        break;
+    case 'p':
+    case 'P':
+        pause(state == PLAYING);
+        break;
+    default:
+        // S is player 2's down key while playing.
+        if (state == PLAYING)
+            engine.handleKey(ch);
+        else if (state == PAUSED && (ch == 's' || ch == 'S'))
+            suspend(engine);
+        break;
     }
 }
 
-void Game::update(Player &player)
+template <typename Engine>
+void Game::render(const Engine &engine)
 {
-    if (state != PLAYING)
-        return;
-
-    updateScore();
-
-    int nextX = player.getNextX();
-    int nextY = player.getNextY();
+    TickProfiler::Scope scope(STAGE_RENDER);
+    frame.clear();
+    drawBorders();
+    drawObstacles();
 
-    if (checkWallCollision(nextX, nextY))
+    // A finished battle stays on screen under the result.
+    if (state != GAME_OVER || currentGameMode == BOT_BATTLE)
     {
-        gameOver();
-        return;
+        for (int i = 0; i < engine.getPlayerCount(); i++)
+            engine.getPlayer(i)->draw(frame, viewX, viewY, pacer.useAscii());
+        renderHUD();
     }
-
-    if (checkTrailCollision(nextX, nextY, player))
+    if (state == GAME_OVER)
     {
-        gameOver();
-        return;
+        renderGameOver();
+    }
+    else if (state == PAUSED)
+    {
+        renderPaused();
     }
 
-    player.move();
+    present();
 }
 
-void Game::render(Player &player)
+template <typename Match>
+void Game::withEngine(Match &&match)
 {
-    clear();
+    layout();
+    arena.reset();
+    arena.reserve(width, height);
 
-    drawBorders();
-    if (state == PLAYING)
+    if (currentGameMode == SINGLE_PLAYER)
     {
-        player.draw();
-
-        attron(COLOR_PAIR(Config::COLOR_HUD));
-        mvprintw(0, Config::HUD_HORIZONTAL_OFFSET, "╣ Score: %d ║ Time: %ds ╠", score, getGameTime());
-        int bottomY = height - 1;
-        mvprintw(bottomY, Config::HUD_HORIZONTAL_OFFSET, "╣ ⇠⇡⇢⇣ Move ║ Q Quit ║ R Restart ╠");
-        attroff(COLOR_PAIR(Config::COLOR_HUD));
+        Player &player = *arena.acquirePlayer(0, 0, RIGHT);
+        player.setTrailLimit(trailLength);
+        TickEngine<HumanController> engine(width, height, HumanController(player, KEYS_ARROWS));
+        engine.setObstacles(map);
+        match(engine);
     }
-    else if (state == GAME_OVER)
+    else if (currentGameMode == TWO_PLAYER)
     {
-        int centerX = width / 2;
-        int centerY = height / 2;
-
-        attron(COLOR_PAIR(Config::COLOR_GAME_OVER));
-        mvprintw(centerY - Config::GAMEOVER_BOX_VERTICAL_OFFSET, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-        mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║      GAME OVER!      ║");
-        mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-        mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║ Score:%3d   Time:%2ds ║", score, getGameTime());
-        mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-        attroff(COLOR_PAIR(Config::COLOR_GAME_OVER));
-
-        attron(COLOR_PAIR(Config::COLOR_MESSAGES));
-        mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║   R-Restart  Q-Quit  ║");
-        mvprintw(centerY + 3, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-        attroff(COLOR_PAIR(Config::COLOR_MESSAGES));
+        Player &player1 = *arena.acquirePlayer(0, 0, RIGHT);
+        Player &player2 = *arena.acquirePlayer(0, 0, LEFT);
+        player1.setTrailLimit(trailLength);
+        player2.setTrailLimit(trailLength);
+        TickEngine<HumanController, HumanController> engine(width, height, HumanController(player1, KEYS_ARROWS),
+                                                            HumanController(player2, KEYS_WASD));
+        engine.setObstacles(map);
+        match(engine);
     }
+    else if (currentGameMode == VS_BOT)
+    {
+        Player &player = *arena.acquirePlayer(0, 0, RIGHT);
+        Bot &bot = *arena.acquireBot(0, 0, LEFT);
+        bot.setDifficulty(botDifficulty);
+        bot.setWeights(botWeights);
+        bot.setNetwork(network);
+        bot.setSearchThreads(searchThreads);
+        bot.setMap(&map);
+        player.setTrailLimit(trailLength);
+        bot.getPlayer()->setTrailLimit(trailLength);
+
+        TickEngine<HumanController, BotController> engine(width, height, HumanController(player, KEYS_ARROWS),
+                                                          BotController(bot, player, width, height));
+        engine.setObstacles(map);
+        match(engine);
+    }
+    else if (currentGameMode == BOT_BATTLE)
+    {
+        Bot &second = *arena.acquireBot(0, 0, LEFT);
+        Bot &first = *arena.acquireBot(0, 0, RIGHT);
+        for (Bot *bot : {&first, &second})
+        {
+            bot->setDifficulty(botDifficulty);
+            bot->setWeights(botWeights);
+            bot->setNetwork(network);
+            bot->setSearchThreads(searchThreads);
+            bot->setMap(&map);
+            bot->seedNoise(spawner.next());
+            bot->getPlayer()->setTrailLimit(trailLength);
+        }
 
-    refresh();
+        TickEngine<BotController, BotController> engine(width, height, BotController(first, *second.getPlayer(), width, height),
+                                                        BotController(second, *first.getPlayer(), width, height));
+        engine.setObstacles(map);
+        match(engine);
+    }
 }
 
-void Game::cleanup()
+void Game::run()
 {
-    endwin();
-
-    printf("\033[?1049l");
-    fflush(stdout);
+    withEngine([this](auto &engine)
+               {
+                   if (currentGameMode == BOT_BATTLE)
+                       watch(engine);
+                   else
+                       play(engine);
+               });
 }
 
-bool Game::checkWallCollision(int x, int y)
+// Runs the current mode without input or pacing: keys are fed one per tick in turn and
+// finished rounds restart. Returns the heap allocations made after the warm-up ticks,
+// which stays zero unless the build counts allocations (make alloccheck).
+long Game::playScripted(const std::vector<int> &keys, int warmupTicks, int ticks)
 {
-    return (x <= 0 || x >= width - 1 || y <= 0 || y >= height - 1);
+    long allocations = 0;
+    firstStart = false;
+    recordStats = false;
+    pacer.setAdaptive(false);
+    startGame();
+    auto script = [&](auto &engine)
+    {
+        respawn(engine);
+        for (int t = 0; t < warmupTicks + ticks; t++)
+        {
+            if (t == warmupTicks)
+                allocations = AllocationCounter::count();
+            if (step(engine, state == GAME_OVER ? 'r' : keys[t % keys.size()]))
+                render(engine);
+        }
+        allocations = AllocationCounter::count() - allocations;
+    };
+    withEngine(script);
+    return allocations;
 }
 
-void Game::gameOver(int winnerPlayer)
+void Game::renderHUD()
 {
-    winner = winnerPlayer;
-    state = GAME_OVER;
+    int bottomY = height - 1;
+    switch (currentGameMode)
+    {
+    case SINGLE_PLAYER:
+        drawText(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Score: %d ║ Time: %ds ╠", score, getGameTime());
+        drawText(Config::HUD_HORIZONTAL_OFFSET, bottomY, Config::COLOR_HUD, "╣ ⇠⇡⇢⇣ Move ║ P Pause ║ Q Quit ║ R Restart ╠");
+        break;
+    case TWO_PLAYER:
+        drawText(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Player 1 vs Player 2 ║ Time: %ds ╠", getGameTime());
+        drawText(Config::HUD_HORIZONTAL_OFFSET, bottomY, Config::COLOR_HUD, "╣ Arrows=P1 ║ WASD=P2 ║ P=Pause ║ Q=Quit ║ R=Restart ╠");
+        break;
+    case VS_BOT:
+        drawText(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Player vs Bot ║ Time: %ds ╠", getGameTime());
+        drawText(Config::HUD_HORIZONTAL_OFFSET, bottomY, Config::COLOR_HUD, "╣ Arrows=Move ║ P=Pause ║ Q=Quit ║ R=Restart ╠");
+        break;
+    case BOT_BATTLE:
+    {
+        char speed[8];
+        if (Config::BATTLE_SPEEDS[battleSpeed] == 0)
+            snprintf(speed, sizeof(speed), "max");
+        else
+            snprintf(speed, sizeof(speed), "%dx", Config::BATTLE_SPEEDS[battleSpeed]);
+        drawText(Config::HUD_HORIZONTAL_OFFSET, 0, Config::COLOR_HUD, "╣ Bot vs Bot ║ Speed: %s ║ Tick: %d ╠", speed, score);
+        drawText(Config::HUD_HORIZONTAL_OFFSET, bottomY, Config::COLOR_HUD, "╣ +/-=Speed ║ P=Pause ║ Q=Quit ║ R=Restart ╠");
+        break;
+    }
+    }
 }
 
-void Game::restart(Player *player1, Player *player2, Bot *bot)
+void Game::renderGameOver()
 {
-    int actualWidth, actualHeight;
-    getmaxyx(stdscr, actualHeight, actualWidth);
-
-    startGame();
-    winner = Config::WINNER_TIE;
+    static const char *const TWO_PLAYER_RESULTS[] = {
+        "║           TIE GAME!           ║",
+        "║        PLAYER 1 WINS!         ║",
+        "║        PLAYER 2 WINS!         ║"};
+    static const char *const VS_BOT_RESULTS[] = {
+        "║         TIE GAME!             ║",
+        "║        PLAYER WINS!           ║",
+        "║         BOT WINS!             ║"};
+    static const char *const BATTLE_RESULTS[] = {
+        "║           TIE GAME!           ║",
+        "║          BOT 1 WINS!          ║",
+        "║          BOT 2 WINS!          ║"};
 
-    if (currentGameMode == SINGLE_PLAYER && player1)
-    {
-        int randomSide = rand() % Config::NUM_SIDES;
-        auto spawnPos = getRandomPositionOnSide(randomSide, actualWidth, actualHeight);
-        Direction safeDir = getSafeDirection(randomSide);
+    int centerX = width / 2;
+    int centerY = height / 2;
 
-        player1->reset(spawnPos.first, spawnPos.second);
-        player1->setDirection(safeDir);
-    }
-    else if (currentGameMode == TWO_PLAYER && player1 && player2)
+    if (currentGameMode == SINGLE_PLAYER)
     {
-        int side1 = rand() % Config::NUM_SIDES;
-        int side2 = (side1 + 2) % Config::NUM_SIDES;
-
-        auto p1_pos = getRandomPositionOnSide(side1, actualWidth, actualHeight);
-        auto p2_pos = getRandomPositionOnSide(side2, actualWidth, actualHeight);
+        int left = centerX - Config::MENU_BOX_HALF_WIDTH;
 
-        Direction safeDir1 = getSafeDirection(side1);
-        Direction safeDir2 = getSafeDirection(side2);
+        drawText(left, centerY - Config::GAMEOVER_BOX_VERTICAL_OFFSET, Config::COLOR_GAME_OVER, "╔══════════════════════╗");
+        drawText(left, centerY - 2, Config::COLOR_GAME_OVER, "║      GAME OVER!      ║");
+        drawText(left, centerY - 1, Config::COLOR_GAME_OVER, "╠══════════════════════╣");
+        drawText(left, centerY, Config::COLOR_GAME_OVER, "║ Score:%3d   Time:%2ds ║", score, getGameTime());
+        drawText(left, centerY + 1, Config::COLOR_GAME_OVER, "╠══════════════════════╣");
 
-        player1->reset(p1_pos.first, p1_pos.second);
-        player1->setDirection(safeDir1);
-        player2->reset(p2_pos.first, p2_pos.second);
-        player2->setDirection(safeDir2);
+        drawText(left, centerY + 2, Config::COLOR_MESSAGES, "║   R-Restart  Q-Quit  ║");
+        drawText(left, centerY + 3, Config::COLOR_MESSAGES, "╚══════════════════════╝");
+        return;
     }
-    else if (currentGameMode == VS_BOT && player1 && bot)
-    {
-        int side1 = rand() % Config::NUM_SIDES;
-        int side2 = (side1 + 2) % Config::NUM_SIDES;
 
-        auto p_pos = getRandomPositionOnSide(side1, actualWidth, actualHeight);
-        auto b_pos = getRandomPositionOnSide(side2, actualWidth, actualHeight);
+    int left = centerX - Config::MENU_BOX_LARGE_HALF_WIDTH;
+    const char *const *results = currentGameMode == VS_BOT ? VS_BOT_RESULTS : currentGameMode == BOT_BATTLE ? BATTLE_RESULTS : TWO_PLAYER_RESULTS;
+    int result = (winner == Config::WINNER_PLAYER1 || winner == Config::WINNER_PLAYER2) ? winner : Config::WINNER_TIE;
 
-        Direction safeDir1 = getSafeDirection(side1);
-        Direction safeDir2 = getSafeDirection(side2);
+    drawText(left, centerY - Config::GAMEOVER_BOX_VERTICAL_OFFSET, Config::COLOR_GAME_OVER, "╔═══════════════════════════════╗");
+    drawText(left, centerY - 2, Config::COLOR_GAME_OVER, "%s", results[result]);
+    drawText(left, centerY - 1, Config::COLOR_GAME_OVER, "╠═══════════════════════════════╣");
+    if (currentGameMode == BOT_BATTLE)
+        drawText(left, centerY, Config::COLOR_GAME_OVER, "║ Ticks: %-5d║  Time: %3ds     ║", score, getGameTime());
+    else
+        drawText(left, centerY, Config::COLOR_GAME_OVER, "║ Time: %2ds   ║  Score: %3d     ║", getGameTime(), score);
+    drawText(left, centerY + 1, Config::COLOR_GAME_OVER, "╠═══════════════════════════════╣");
 
-        player1->reset(p_pos.first, p_pos.second);
-        player1->setDirection(safeDir1);
-        bot->reset(b_pos.first, b_pos.second);
-        bot->getPlayer()->setDirection(safeDir2);
-    }
+    drawText(left, centerY + 2, Config::COLOR_MESSAGES, "║     R-Restart    Q-Quit       ║");
+    drawText(left, centerY + 3, Config::COLOR_MESSAGES, "╚═══════════════════════════════╝");
 }
 
-bool Game::checkTrailCollision(int x, int y, const Player &player)
+void Game::renderPaused()
 {
-    const auto &trail = player.getTrail();
+    int left = width / 2 - Config::MENU_BOX_HALF_WIDTH;
+    int centerY = height / 2;
 
-    if (trail.size() <= Config::COLLISION_TRAIL_MIN_LENGTH)
-    {
-        return false;
-    }
+    drawText(left, centerY - 2, Config::COLOR_MESSAGES, "╔══════════════════════╗");
+    drawText(left, centerY - 1, Config::COLOR_MESSAGES, "║        PAUSED        ║");
+    drawText(left, centerY, Config::COLOR_MESSAGES, "╠══════════════════════╣");
+    drawText(left, centerY + 1, Config::COLOR_MESSAGES, "║ P-Resume  S-Save+Quit║");
+    drawText(left, centerY + 2, Config::COLOR_MESSAGES, "║        Q-Quit        ║");
+    drawText(left, centerY + 3, Config::COLOR_MESSAGES, "╚══════════════════════╝");
+    if (!snapshotError.empty())
+        drawText(left, centerY + 4, Config::COLOR_GAME_OVER, "%s", snapshotError.c_str());
+}
 
-    for (size_t i = 0; i < trail.size() - Config::COLLISION_TRAIL_MIN_LENGTH; i++)
-    {
-        if (trail[i].x == x && trail[i].y == y)
-        {
-            return true;
-        }
-    }
+// Only undoes init(), so headless games (benches) and a second call leave the terminal alone.
+void Game::cleanup()
+{
+    if (!initialized)
+        return;
+    initialized = false;
+    endwin();
 
-    return false;
+    printf("\033[?1049l");
+    fflush(stdout);
 }
 
-void Game::drawBorders()
+void Game::gameOver(int winnerPlayer)
 {
-    attron(COLOR_PAIR(Config::COLOR_BORDERS));
+    winner = winnerPlayer;
+    state = GAME_OVER;
+    if (recordStats && currentGameMode != BOT_BATTLE)
+        StatsStore::instance().record(currentGameMode, botDifficulty, winner, score);
+}
 
-    mvprintw(0, 0, "╔");
+void Game::drawBorders()
+{
+    drawText(0, 0, Config::COLOR_BORDERS, "╔");
     for (int x = 1; x < width - 1; x++)
     {
-        mvprintw(0, x, "═");
+        drawText(x, 0, Config::COLOR_BORDERS, "═");
     }
-    mvprintw(0, width - 1, "╗");
+    drawText(width - 1, 0, Config::COLOR_BORDERS, "╗");
 
     for (int y = 1; y < height - 1; y++)
     {
-        mvprintw(y, 0, "║");
-        mvprintw(y, width - 1, "║");
+        drawText(0, y, Config::COLOR_BORDERS, "║");
+        drawText(width - 1, y, Config::COLOR_BORDERS, "║");
     }
 
-    mvprintw(height - 1, 0, "╚");
+    drawText(0, height - 1, Config::COLOR_BORDERS, "╚");
     for (int x = 1; x < width - 1; x++)
     {
-        mvprintw(height - 1, x, "═");
+        drawText(x, height - 1, Config::COLOR_BORDERS, "═");
+    }
+    drawText(width - 1, height - 1, Config::COLOR_BORDERS, "╝");
+}
+
+void Game::drawObstacles()
+{
+    for (const auto &cell : obstacles)
+        drawText(cell.first, cell.second, Config::COLOR_BORDERS, "▓");
+}
+
+void Game::setMap(const ArenaMap &arenaMap)
+{
+    map = arenaMap;
+    width = map.getWidth();
+    height = map.getHeight();
+    obstacles.clear();
+    for (int y = 1; y < height - 1; y++)
+    {
+        for (int x = 1; x < width - 1; x++)
+        {
+            if (map.isWall(x, y))
+                obstacles.push_back({x, y});
+        }
     }
-    mvprintw(height - 1, width - 1, "╝");
+}
+
+void Game::layout()
+{
+    int termHeight, termWidth;
+    getmaxyx(stdscr, termHeight, termWidth);
 
-    attroff(COLOR_PAIR(Config::COLOR_BORDERS));
+    viewX = termWidth > width ? (termWidth - width) / 2 : 0;
+    viewY = termHeight > height ? (termHeight - height) / 2 : 0;
+    frame.resize(termWidth, termHeight);
+}
+
+void Game::drawText(int x, int y, int color, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    frame.vprint(viewX + x, viewY + y, color, format, args);
+    va_end(args);
+}
+
+void Game::present()
+{
+    auto start = std::chrono::steady_clock::now();
+    long sent = screen.getBytes();
+    frame.flush(screen);
+    long blocked = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    pacer.presented(screen.getBytes() - sent, blocked, RenderPacer::outputQueued(STDOUT_FILENO));
 }
 
 int Game::getScore() const
@@ -433,6 +771,35 @@ void Game::initColors()
     }
 }
 
+bool Game::loadSnapshot(const std::string &path, std::string &error)
+{
+    if (!resumed.load(path, error))
+        return false;
+
+    currentGameMode = resumed.mode;
+    currentGameSpeed = static_cast<GameSpeed>(resumed.tickMicros);
+    trailLength = resumed.trailLength;
+    battleSpeed = resumed.battleSpeed >= 0 && resumed.battleSpeed < Config::NUM_BATTLE_SPEEDS ? resumed.battleSpeed : 0;
+    for (const SnapshotRider &rider : resumed.riders)
+    {
+        if (rider.bot)
+            botDifficulty = rider.difficulty;
+    }
+    if (resumed.map.empty())
+    {
+        map = ArenaMap();
+        obstacles.clear();
+    }
+    else
+    {
+        setMap(resumed.map);
+    }
+    width = resumed.width;
+    height = resumed.height;
+    resuming = true;
+    return true;
+}
+
 void Game::setGameSpeed(GameSpeed speed)
 {
     currentGameSpeed = speed;
@@ -446,15 +813,8 @@ void Game::setColorScheme(int scheme)
 
 std::pair<int, int> Game::getRandomSpawnPosition(int width, int height)
 {
-    static bool seeded = false;
-    if (!seeded)
-    {
-        srand(time(nullptr));
-        seeded = true;
-    }
-
-    int x = Config::SPAWN_MARGIN + rand() % (width - 2 * Config::SPAWN_MARGIN);
-    int y = Config::SPAWN_MARGIN + rand() % (height - 2 * Config::SPAWN_MARGIN);
+    int x = spawner.range(Config::SPAWN_MARGIN, width - Config::SPAWN_MARGIN - 1);
+    int y = spawner.range(Config::SPAWN_MARGIN, height - Config::SPAWN_MARGIN - 1);
 
     return std::make_pair(x, y);
 }
@@ -464,27 +824,77 @@ void Game::setGameMode(GameMode mode)
     currentGameMode = mode;
 }
 
+void Game::setBotWeights(const BotWeights &weights)
+{
+    botWeights = weights;
+}
+
+void Game::setNetwork(const NnueNetwork *learned)
+{
+    network = learned;
+}
+
+void Game::setBotDifficulty(BotDifficulty difficulty)
+{
+    botDifficulty = difficulty;
+}
+
+void Game::setTrailLength(int cells)
+{
+    trailLength = cells;
+}
+
+void Game::setSearchThreads(int threads)
+{
+    searchThreads = threads;
+}
+
 std::pair<int, int> Game::getRandomPositionOnSide(int side, int width, int height)
+{
+    // On a map, walk on from the random pick to the first spot with open floor ahead.
+    int span = getSideSpan(side, width, height);
+    int offset = static_cast<int>(spawner.next() % static_cast<uint64_t>(span));
+    Direction dir = getSafeDirection(side);
+    for (int tries = 0; tries < span && !map.empty(); tries++)
+    {
+        std::pair<int, int> spot = getPositionOnSide(side, (offset + tries) % span, width, height);
+        int aheadX = spot.first + (dir == RIGHT) - (dir == LEFT);
+        int aheadY = spot.second + (dir == DOWN) - (dir == UP);
+        if (!map.isWall(spot.first, spot.second) && !map.isWall(aheadX, aheadY))
+            return spot;
+    }
+    return getPositionOnSide(side, offset, width, height);
+}
+
+int Game::getSideSpan(int side, int width, int height)
+{
+    if (side == Config::SIDE_TOP || side == Config::SIDE_BOTTOM)
+        return width - 2 * Config::SPAWN_MARGIN;
+    return height - 2 * Config::SPAWN_MARGIN;
+}
+
+std::pair<int, int> Game::getPositionOnSide(int side, int offset, int width, int height)
 {
     int x, y;
 
     switch (side)
     {
     case Config::SIDE_TOP:
-        x = Config::SPAWN_MARGIN + rand() % (width - 2 * Config::SPAWN_MARGIN);
+        x = Config::SPAWN_MARGIN + offset;
         y = Config::SPAWN_MARGIN;
         break;
     case Config::SIDE_RIGHT:
         x = width - Config::SPAWN_MARGIN;
-        y = Config::SPAWN_MARGIN + rand() % (height - 2 * Config::SPAWN_MARGIN);
+        y = Config::SPAWN_MARGIN + offset;
         break;
     case Config::SIDE_BOTTOM:
-        x = Config::SPAWN_MARGIN + rand() % (width - 2 * Config::SPAWN_MARGIN);
+        x = Config::SPAWN_MARGIN + offset;
         y = height - Config::SPAWN_MARGIN;
         break;
     case Config::SIDE_LEFT:
+    default:
         x = Config::SPAWN_MARGIN;
-        y = Config::SPAWN_MARGIN + rand() % (height - 2 * Config::SPAWN_MARGIN);
+        y = Config::SPAWN_MARGIN + offset;
         break;
     }
 
@@ -510,310 +920,11 @@ Direction Game::getSafeDirection(int side)
 
 std::pair<std::pair<int, int>, std::pair<int, int>> Game::getTwoPlayerSpawnPositions(int width, int height)
 {
-    static bool seeded = false;
-    if (!seeded)
-    {
-        srand(time(nullptr));
-        seeded = true;
-    }
-
-    int side1 = rand() % Config::NUM_SIDES;
+    int side1 = spawner.range(0, Config::NUM_SIDES - 1);
     int side2 = (side1 + 2) % Config::NUM_SIDES;
 
     auto p1_pos = getRandomPositionOnSide(side1, width, height);
     auto p2_pos = getRandomPositionOnSide(side2, width, height);
 
     return std::make_pair(p1_pos, p2_pos);
-}
-
-void Game::handleInputTwoPlayer(Player &player1, Player &player2)
-{
-    int ch = getch();
-    switch (ch)
-    {
-    case KEY_UP:
-        if (state == PLAYING)
-            player1.setDirection(UP);
-        break;
-    case KEY_DOWN:
-        if (state == PLAYING)
-            player1.setDirection(DOWN);
-        break;
-    case KEY_LEFT:
-        if (state == PLAYING)
-            player1.setDirection(LEFT);
-        break;
-    case KEY_RIGHT:
-        if (state == PLAYING)
-            player1.setDirection(RIGHT);
-        break;
-
-    case 'w':
-    case 'W':
-        if (state == PLAYING)
-            player2.setDirection(UP);
-        break;
-    case 's':
-    case 'S':
-        if (state == PLAYING)
-            player2.setDirection(DOWN);
-        break;
-    case 'a':
-    case 'A':
-        if (state == PLAYING)
-            player2.setDirection(LEFT);
-        break;
-    case 'd':
-    case 'D':
-        if (state == PLAYING)
-            player2.setDirection(RIGHT);
-        break;
-
-    case 'r':
-    case 'R':
-        if (state == GAME_OVER)
-        {
-            restart(&player1, &player2);
-        }
-        break;
-    case 'q':
-    case 'Q':
-    case 27:
-        stop();
-        break;
-    }
-}
-
-void Game::updateTwoPlayer(Player &player1, Player &player2)
-{
-    if (state != PLAYING)
-        return;
-
-    updateScore();
-
-    int p1_nextX = player1.getNextX();
-    int p1_nextY = player1.getNextY();
-    int p2_nextX = player2.getNextX();
-    int p2_nextY = player2.getNextY();
-
-    bool p1_wallHit = checkWallCollision(p1_nextX, p1_nextY);
-    bool p2_wallHit = checkWallCollision(p2_nextX, p2_nextY);
-
-    bool p1_trailHit = checkTrailCollision(p1_nextX, p1_nextY, player1);
-    bool p2_trailHit = checkTrailCollision(p2_nextX, p2_nextY, player2);
-
-    bool p1_hitP2Trail = checkTrailCollision(p1_nextX, p1_nextY, player2);
-    bool p2_hitP1Trail = checkTrailCollision(p2_nextX, p2_nextY, player1);
-
-    bool headToHead = (p1_nextX == p2_nextX && p1_nextY == p2_nextY);
-
-    bool p1_loses = p1_wallHit || p1_trailHit || p1_hitP2Trail;
-    bool p2_loses = p2_wallHit || p2_trailHit || p2_hitP1Trail;
-
-    if (headToHead)
-    {
-        gameOver(Config::WINNER_TIE);
-    }
-    else if (p1_loses && p2_loses)
-    {
-        gameOver(Config::WINNER_TIE);
-    }
-    else if (p1_loses)
-    {
-        gameOver(Config::WINNER_PLAYER2);
-    }
-    else if (p2_loses)
-    {
-        gameOver(Config::WINNER_PLAYER1);
-    }
-    else
-    {
-        player1.move();
-        player2.move();
-    }
-}
-
-void Game::renderTwoPlayer(Player &player1, Player &player2)
-{
-    clear();
-    drawBorders();
-
-    if (state == PLAYING)
-    {
-        player1.draw();
-        player2.draw();
-
-        attron(COLOR_PAIR(Config::COLOR_HUD));
-        mvprintw(0, Config::HUD_HORIZONTAL_OFFSET, "╣ Player 1 vs Player 2 ║ Time: %ds ╠", getGameTime());
-        int bottomY = height - 1;
-        mvprintw(bottomY, Config::HUD_HORIZONTAL_OFFSET, "╣ Arrows=P1 ║ WASD=P2 ║ Q=Quit ║ R=Restart ╠");
-        attroff(COLOR_PAIR(Config::COLOR_HUD));
-    }
-    else if (state == GAME_OVER)
-    {
-        int centerX = width / 2;
-        int centerY = height / 2;
-
-        attron(COLOR_PAIR(Config::COLOR_GAME_OVER));
-        mvprintw(centerY - Config::GAMEOVER_BOX_VERTICAL_OFFSET, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╔═══════════════════════════════╗");
-
-        if (winner == Config::WINNER_PLAYER1)
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║        PLAYER 1 WINS!         ║");
-        }
-        else if (winner == Config::WINNER_PLAYER2)
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║        PLAYER 2 WINS!         ║");
-        }
-        else
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║           TIE GAME!           ║");
-        }
-
-        mvprintw(centerY - 1, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╠═══════════════════════════════╣");
-        mvprintw(centerY, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║ Time: %2ds   ║  Score: %3d     ║", getGameTime(), score);
-        mvprintw(centerY + 1, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╠═══════════════════════════════╣");
-        attroff(COLOR_PAIR(Config::COLOR_GAME_OVER));
-
-        attron(COLOR_PAIR(Config::COLOR_MESSAGES));
-        mvprintw(centerY + 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║     R-Restart    Q-Quit       ║");
-        mvprintw(centerY + 3, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╚═══════════════════════════════╝");
-        attroff(COLOR_PAIR(Config::COLOR_MESSAGES));
-    }
-
-    refresh();
-}
-
-void Game::handleInputVsBot(Player &player, Bot &bot)
-{
-    int ch = getch();
-    switch (ch)
-    {
-    case KEY_UP:
-        if (state == PLAYING)
-            player.setDirection(UP);
-        break;
-    case KEY_DOWN:
-        if (state == PLAYING)
-            player.setDirection(DOWN);
-        break;
-    case KEY_LEFT:
-        if (state == PLAYING)
-            player.setDirection(LEFT);
-        break;
-    case KEY_RIGHT:
-        if (state == PLAYING)
-            player.setDirection(RIGHT);
-        break;
-    case 'r':
-    case 'R':
-        if (state == GAME_OVER)
-        {
-            restart(&player, nullptr, &bot);
-        }
-        break;
-    case 'q':
-    case 'Q':
-    case 27:
-        stop();
-        break;
-    }
-}
-
-void Game::updateVsBot(Player &player, Bot &bot)
-{
-    if (state != PLAYING)
-        return;
-
-    updateScore();
-
-    bot.update(player, width, height);
-
-    int p_nextX = player.getNextX();
-    int p_nextY = player.getNextY();
-    int b_nextX = bot.getPlayer()->getNextX();
-    int b_nextY = bot.getPlayer()->getNextY();
-
-    bool p_wallHit = checkWallCollision(p_nextX, p_nextY);
-    bool b_wallHit = checkWallCollision(b_nextX, b_nextY);
-
-    bool p_trailHit = checkTrailCollision(p_nextX, p_nextY, player);
-    bool b_trailHit = checkTrailCollision(b_nextX, b_nextY, *bot.getPlayer());
-
-    bool p_hitBotTrail = checkTrailCollision(p_nextX, p_nextY, *bot.getPlayer());
-    bool b_hitPlayerTrail = checkTrailCollision(b_nextX, b_nextY, player);
-
-    bool headToHead = (p_nextX == b_nextX && p_nextY == b_nextY);
-
-    bool p_loses = p_wallHit || p_trailHit || p_hitBotTrail;
-    bool b_loses = b_wallHit || b_trailHit || b_hitPlayerTrail;
-
-    if (headToHead || (p_loses && b_loses))
-    {
-        gameOver(Config::WINNER_TIE);
-    }
-    else if (p_loses)
-    {
-        gameOver(Config::WINNER_PLAYER2);
-    }
-    else if (b_loses)
-    {
-        gameOver(Config::WINNER_PLAYER1);
-    }
-    else
-    {
-        player.move();
-        bot.getPlayer()->move();
-    }
-}
-
-void Game::renderVsBot(Player &player, Bot &bot)
-{
-    clear();
-    drawBorders();
-
-    if (state == PLAYING)
-    {
-        player.draw();
-        bot.getPlayer()->draw();
-
-        attron(COLOR_PAIR(Config::COLOR_HUD));
-        mvprintw(0, Config::HUD_HORIZONTAL_OFFSET, "╣ Player vs Bot ║ Time: %ds ╠", getGameTime());
-        int bottomY = height - 1;
-        mvprintw(bottomY, Config::HUD_HORIZONTAL_OFFSET, "╣ Arrows=Move ║ Q=Quit ║ R=Restart ╠");
-        attroff(COLOR_PAIR(Config::COLOR_HUD));
-    }
-    else if (state == GAME_OVER)
-    {
-        int centerX = width / 2;
-        int centerY = height / 2;
-
-        attron(COLOR_PAIR(Config::COLOR_GAME_OVER));
-        mvprintw(centerY - Config::GAMEOVER_BOX_VERTICAL_OFFSET, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╔═══════════════════════════════╗");
-
-        if (winner == Config::WINNER_PLAYER1)
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║        PLAYER WINS!           ║");
-        }
-        else if (winner == Config::WINNER_PLAYER2)
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║         BOT WINS!             ║");
-        }
-        else
-        {
-            mvprintw(centerY - 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║         TIE GAME!             ║");
-        }
-
-        mvprintw(centerY - 1, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╠═══════════════════════════════╣");
-        mvprintw(centerY, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║ Time: %2ds   ║  Score: %3d     ║", getGameTime(), score);
-        mvprintw(centerY + 1, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╠═══════════════════════════════╣");
-        attroff(COLOR_PAIR(Config::COLOR_GAME_OVER));
-
-        attron(COLOR_PAIR(Config::COLOR_MESSAGES));
-        mvprintw(centerY + 2, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "║     R-Restart    Q-Quit       ║");
-        mvprintw(centerY + 3, centerX - Config::MENU_BOX_LARGE_HALF_WIDTH, "╚═══════════════════════════════╝");
-        attroff(COLOR_PAIR(Config::COLOR_MESSAGES));
-    }
-
-    refresh();
 }
\ No newline at end of file
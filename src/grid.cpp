@@ -0,0 +1,56 @@
+#include "../include/grid.h"
+#include "../include/arenamap.h"
+#include <algorithm>
+#include <cstddef>
+
+Grid::Grid(int w, int h) : width(0), height(0)
+{
+    resize(w, h);
+}
+
+void Grid::resize(int w, int h)
+{
+    width = w;
+    height = h;
+    base.assign(static_cast<size_t>(w > 0 ? w : 0) * (h > 0 ? h : 0), Config::CELL_EMPTY);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool border = (x == 0 || x == width - 1 || y == 0 || y == height - 1);
+            base[y * width + x] = border ? Config::CELL_WALL : Config::CELL_EMPTY;
+        }
+    }
+    cells = base;
+}
+
+void Grid::clear()
+{
+    std::copy(base.begin(), base.end(), cells.begin());
+}
+
+void Grid::setObstacles(const ArenaMap &map)
+{
+    for (int y = 1; y < height - 1 && y < map.getHeight() - 1; y++)
+    {
+        for (int x = 1; x < width - 1 && x < map.getWidth() - 1; x++)
+        {
+            if (map.isWall(x, y))
+                base[y * width + x] = Config::CELL_WALL;
+        }
+    }
+    clear();
+}
+
+void Grid::assign(const uint8_t *values)
+{
+    std::copy(values, values + cells.size(), cells.begin());
+}
+
+void Grid::set(int x, int y, uint8_t value)
+{
+    if (inBounds(x, y))
+    {
+        cells[y * width + x] = value;
+    }
+}
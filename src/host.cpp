@@ -0,0 +1,287 @@
+#include "../include/host.h"
+#include "../include/game.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+    const GameSpeed HOST_SPEEDS[] = {SLOW, NORMAL, FAST};
+    const int HOST_SPEED_COUNT = 3;
+
+    int bucketFor(long micros)
+    {
+        int bucket = 0;
+        while (micros > 1 && bucket < Config::HOST_LATENCY_BUCKETS - 1)
+        {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    const char *speedName(GameSpeed speed)
+    {
+        switch (speed)
+        {
+        case SLOW:
+            return "slow";
+        case FAST:
+            return "fast";
+        default:
+            return "normal";
+        }
+    }
+}
+
+void LatencyStats::record(long micros)
+{
+    micros = std::max(0L, micros);
+    ticks++;
+    totalMicros += micros;
+    maxMicros = std::max(maxMicros, micros);
+    buckets[bucketFor(micros)]++;
+}
+
+void LatencyStats::merge(const LatencyStats &other)
+{
+    ticks += other.ticks;
+    totalMicros += other.totalMicros;
+    maxMicros = std::max(maxMicros, other.maxMicros);
+    for (int i = 0; i < Config::HOST_LATENCY_BUCKETS; i++)
+        buckets[i] += other.buckets[i];
+}
+
+long LatencyStats::percentile(double fraction) const
+{
+    long target = static_cast<long>(fraction * ticks);
+    long seen = 0;
+    for (int i = 0; i < Config::HOST_LATENCY_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen > target)
+            return std::min(1L << i, maxMicros);
+    }
+    return maxMicros;
+}
+
+TimerWheel::TimerWheel(int slots, long resolutionMicros, int capacity)
+    : heads(slots, -1), next(capacity, -1), dueSlot(capacity, 0), resolution(resolutionMicros), cursor(0)
+{
+}
+
+void TimerWheel::schedule(int entry, long dueMicros)
+{
+    long slot = std::max((dueMicros + resolution - 1) / resolution, cursor);
+    int index = static_cast<int>(slot % static_cast<long>(heads.size()));
+    dueSlot[entry] = slot;
+    next[entry] = heads[index];
+    heads[index] = entry;
+}
+
+long TimerWheel::nextDueMicros() const
+{
+    long slotCount = static_cast<long>(heads.size());
+    for (long slot = cursor; slot < cursor + slotCount; slot++)
+    {
+        if (heads[slot % slotCount] >= 0)
+            return slot * resolution;
+    }
+    return (cursor + slotCount) * resolution;
+}
+
+HostedMatch::HostedMatch(const HostSettings &settings, GameSpeed matchSpeed, uint64_t seed)
+    : arena(0, 2), rng(seed), speed(matchSpeed), dueMicros(0), rounds(0)
+{
+    arena.reserve(settings.width, settings.height);
+    Bot &first = *arena.acquireBot(0, 0, RIGHT);
+    Bot &second = *arena.acquireBot(0, 0, LEFT);
+    first.setDifficulty(settings.difficulty);
+    second.setDifficulty(settings.difficulty);
+    first.seedNoise(rng.next());
+    second.seedNoise(rng.next());
+    engine.reset(new TickEngine<BotController, BotController>(settings.width, settings.height,
+                                                               BotController(first, *second.getPlayer(), settings.width, settings.height),
+                                                               BotController(second, *first.getPlayer(), settings.width, settings.height)));
+    startRound(settings.width, settings.height);
+}
+
+void HostedMatch::startRound(int width, int height)
+{
+    int side1 = rng.range(0, Config::NUM_SIDES - 1);
+    int side2 = (side1 + 2) % Config::NUM_SIDES;
+    auto pos1 = Game::getPositionOnSide(side1, rng.range(0, Game::getSideSpan(side1, width, height) - 1), width, height);
+    auto pos2 = Game::getPositionOnSide(side2, rng.range(0, Game::getSideSpan(side2, width, height) - 1), width, height);
+
+    arena.reset();
+    arena.acquireBot(pos1.first, pos1.second, Game::getSafeDirection(side1));
+    arena.acquireBot(pos2.first, pos2.second, Game::getSafeDirection(side2));
+    engine->reset();
+}
+
+MatchHost::MatchHost(const HostSettings &hostSettings) : settings(hostSettings), elapsedSeconds(0)
+{
+    threadCount = settings.threads > 0 ? settings.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+
+    Rng seeder(settings.seed);
+    matches.reserve(settings.matches);
+    for (int i = 0; i < settings.matches; i++)
+        matches.emplace_back(new HostedMatch(settings, HOST_SPEEDS[i % HOST_SPEED_COUNT], seeder.next()));
+}
+
+void MatchHost::runShard(int shard)
+{
+    std::vector<int> owned;
+    for (int i = shard; i < static_cast<int>(matches.size()); i += threadCount)
+        owned.push_back(i);
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMicros = [&start]()
+    {
+        return static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    };
+    const long stopMicros = static_cast<long>(settings.seconds * 1e6);
+
+    auto tickMatch = [this](HostedMatch &match)
+    {
+        TickResult result = match.engine->tick();
+        if (result.finished)
+        {
+            match.rounds++;
+            match.startRound(settings.width, settings.height);
+        }
+    };
+
+    if (settings.unthrottled)
+    {
+        while (elapsedMicros() < stopMicros)
+        {
+            for (int id : owned)
+            {
+                HostedMatch &match = *matches[id];
+                long begin = elapsedMicros();
+                tickMatch(match);
+                match.latency.record(elapsedMicros() - begin);
+            }
+        }
+        return;
+    }
+
+    // Spread first deadlines over each match's period so the shard's load stays level.
+    TimerWheel wheel(Config::HOST_WHEEL_SLOTS, Config::HOST_WHEEL_RESOLUTION_MICROS, static_cast<int>(matches.size()));
+    for (size_t k = 0; k < owned.size(); k++)
+    {
+        HostedMatch &match = *matches[owned[k]];
+        match.dueMicros = static_cast<long>(match.speed) * static_cast<long>(k) / static_cast<long>(owned.size());
+        wheel.schedule(owned[k], match.dueMicros);
+    }
+
+    std::vector<int> expired;
+    expired.reserve(owned.size());
+    while (true)
+    {
+        long now = elapsedMicros();
+        if (now >= stopMicros)
+            break;
+
+        expired.clear();
+        wheel.advance(now, [&expired](int id) { expired.push_back(id); });
+
+        for (int id : expired)
+        {
+            HostedMatch &match = *matches[id];
+            tickMatch(match);
+
+            long done = elapsedMicros();
+            match.latency.record(done - match.dueMicros);
+            match.dueMicros += match.speed;
+            if (match.dueMicros < done)
+                match.dueMicros = done;
+            wheel.schedule(id, match.dueMicros);
+        }
+
+        if (expired.empty())
+        {
+            long wake = std::min(wheel.nextDueMicros(), stopMicros);
+            std::this_thread::sleep_until(start + std::chrono::microseconds(wake));
+        }
+    }
+}
+
+void MatchHost::run()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int shard = 1; shard < threadCount; shard++)
+        workers.emplace_back(&MatchHost::runShard, this, shard);
+    runShard(0);
+    for (auto &worker : workers)
+        worker.join();
+
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+LatencyStats MatchHost::aggregate() const
+{
+    LatencyStats total;
+    for (const auto &match : matches)
+        total.merge(match->latency);
+    return total;
+}
+
+long MatchHost::totalRounds() const
+{
+    long rounds = 0;
+    for (const auto &match : matches)
+        rounds += match->rounds;
+    return rounds;
+}
+
+int runHost(int argc, char **argv)
+{
+    HostSettings settings;
+    if (argc > 2)
+        settings.matches = atoi(argv[2]);
+    if (argc > 3)
+        settings.threads = atoi(argv[3]);
+    if (argc > 4)
+        settings.seconds = atof(argv[4]);
+    if (settings.matches <= 0 || settings.seconds <= 0)
+    {
+        fprintf(stderr, "Usage: %s --host MATCHES [THREADS [SECONDS]]\n", argv[0]);
+        return 1;
+    }
+
+    MatchHost host(settings);
+    printf("Hosting %d matches on %d threads for %.1fs (%dx%d, %s bots)\n", host.getMatchCount(), host.getThreadCount(),
+           settings.seconds, settings.width, settings.height, Bot::difficultyName(settings.difficulty));
+    fflush(stdout);
+    host.run();
+
+    LatencyStats total = host.aggregate();
+    double ticksPerSecond = total.ticks / host.getElapsedSeconds();
+    printf("ticks %ld  rounds %ld  %.0f ticks/s  %.0f ticks/s/thread\n", total.ticks, host.totalRounds(), ticksPerSecond,
+           ticksPerSecond / host.getThreadCount());
+    printf("latency us: mean %.1f  p50 %ld  p99 %ld  max %ld\n", total.mean(), total.percentile(0.5), total.percentile(0.99),
+           total.maxMicros);
+
+    std::vector<int> order(host.getMatchCount());
+    for (int i = 0; i < host.getMatchCount(); i++)
+        order[i] = i;
+    int shown = std::min(Config::HOST_REPORT_SLOWEST, host.getMatchCount());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&host](int a, int b)
+                      { return host.getMatch(a).latency.percentile(0.99) > host.getMatch(b).latency.percentile(0.99); });
+
+    printf("slowest matches:\n");
+    for (int i = 0; i < shown; i++)
+    {
+        const HostedMatch &match = host.getMatch(order[i]);
+        printf("  #%-5d %-6s ticks %-6ld rounds %-4ld mean %.1f  p99 %ld  max %ld\n", order[i], speedName(match.speed),
+               match.latency.ticks, match.rounds, match.latency.mean(), match.latency.percentile(0.99), match.latency.maxMicros);
+    }
+    return 0;
+}
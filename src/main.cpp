@@ -1,10 +1,279 @@
 #include "../include/game.h"
 #include "../include/menu.h"
+#include "../include/book.h"
+#include "../include/bench.h"
+#include "../include/tuner.h"
+#include "../include/host.h"
+#include "../include/weights.h"
+#include "../include/arenamap.h"
+#include "../include/nnue.h"
+#include "../include/cast.h"
+#include "../include/analysis.h"
 #include <ncurses.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 using namespace std;
 
+static int generateBook(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s --gen-book FILE [WIDTHxHEIGHT ...]\n", argv[0]);
+        return 1;
+    }
+
+    vector<pair<int, int>> sizes;
+    for (int i = 3; i < argc; i++)
+    {
+        int w, h;
+        if (sscanf(argv[i], "%dx%d", &w, &h) != 2)
+        {
+            fprintf(stderr, "Invalid arena size: %s\n", argv[i]);
+            return 1;
+        }
+        sizes.push_back({w, h});
+    }
+    if (sizes.empty())
+    {
+        sizes.push_back({Config::OPENING_BOOK_DEFAULT_WIDTH, Config::OPENING_BOOK_DEFAULT_HEIGHT});
+    }
+
+    return OpeningBook::generate(argv[2], sizes) ? 0 : 1;
+}
+
+static int packMap(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s --pack-map MAP.txt MAP.bin\n", argv[0]);
+        return 1;
+    }
+
+    ArenaMap map;
+    string error;
+    if (!map.load(argv[2], error))
+    {
+        fprintf(stderr, "%s: %s\n", argv[2], error.c_str());
+        return 1;
+    }
+    if (!map.save(argv[3]))
+        return 1;
+    fprintf(stderr, "Packed %dx%d map with %d walls and %zu spawns into %s\n", map.getWidth(), map.getHeight(),
+            map.getInteriorWalls(), map.getSpawns().size(), argv[3]);
+    return 0;
+}
+
+static int trainNetwork(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s --train-nnue FILE [GAMES]\n", argv[0]);
+        return 1;
+    }
+    int games = argc == 4 ? atoi(argv[3]) : Config::NNUE_TRAIN_GAMES;
+    if (games <= 0)
+    {
+        fprintf(stderr, "Invalid game count: %s\n", argv[3]);
+        return 1;
+    }
+    return NnueNetwork::train(argv[2], games) ? 0 : 1;
+}
+
+static int exportReplay(int argc, char **argv)
+{
+    if (argc < 4 || argc > 6)
+    {
+        fprintf(stderr, "Usage: %s --export-cast REPLAY OUT.cast [ROUND [OUT.gif]]\n", argv[0]);
+        return 1;
+    }
+    long index = argc >= 5 ? atol(argv[4]) : 1;
+    if (index < 1)
+    {
+        fprintf(stderr, "Invalid round: %s (rounds count from 1)\n", argv[4]);
+        return 1;
+    }
+
+    ReplayRound round;
+    string error;
+    if (!ReplayReader::readRound(argv[2], index - 1, round, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    CastReport report;
+    if (!exportCast(round, argv[3], argc == 6 ? argv[5] : "", report, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "Exported round %ld: %ld ticks, %ld frames, %ld bytes of asciicast", index, report.ticks, report.frames, report.castBytes);
+    if (argc == 6)
+        fprintf(stderr, ", %ld bytes of GIF", report.gifBytes);
+    fprintf(stderr, "\n");
+    if (!report.matches)
+        fprintf(stderr, "Warning: the replayed round did not end as recorded\n");
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--gen-book") == 0)
+    {
+        return generateBook(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--pack-map") == 0)
+    {
+        return packMap(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--train-nnue") == 0)
+    {
+        return trainNetwork(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--export-cast") == 0)
+    {
+        return exportReplay(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0)
+    {
+        return runAnalysis(argc, argv);
+    }
+    if (argc > 2 && strcmp(argv[1], "--bench") == 0)
+    {
+        return runBenchmark(argv[2]);
+    }
+    if (argc > 2 && strcmp(argv[1], "--tune") == 0)
+    {
+        return runTuner(argv[2]);
+    }
+    if (argc > 2 && strcmp(argv[1], "--host") == 0)
+    {
+        return runHost(argc, argv);
+    }
+
+    BotDifficulty difficulty = static_cast<BotDifficulty>(Config::DEFAULT_BOT_DIFFICULTY);
+    BotWeights weights;
+    ArenaMap map;
+    NnueNetwork network;
+    int trailLength = Config::TRAIL_LENGTH_FULL;
+    int searchThreads = Config::DEFAULT_SEARCH_THREADS;
+    const char *replayPath = nullptr;
+    const char *resumePath = nullptr;
+    const char *snapshotPath = nullptr;
+    bool profile = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc)
+        {
+            if (!Bot::difficultyFromName(argv[++i], difficulty))
+            {
+                fprintf(stderr, "Unknown difficulty: %s (easy, normal, hard, insane)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc)
+        {
+            if (!weights.load(argv[++i]))
+            {
+                fprintf(stderr, "Cannot read bot weights from %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc)
+        {
+            string error;
+            if (!map.load(argv[++i], error))
+            {
+                fprintf(stderr, "Cannot load map %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc)
+        {
+            string error;
+            if (!network.load(argv[++i], error))
+            {
+                fprintf(stderr, "Cannot load network %s: %s\n", argv[i], error.c_str());
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--trail") == 0 && i + 1 < argc)
+        {
+            trailLength = atoi(argv[++i]);
+            if (trailLength != Config::TRAIL_LENGTH_FULL && trailLength < Config::TRAIL_MIN_LENGTH)
+            {
+                fprintf(stderr, "Trail length must be 0 (full) or at least %d cells\n", Config::TRAIL_MIN_LENGTH);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            searchThreads = atoi(argv[++i]);
+            if (searchThreads < 0 || searchThreads > Config::SEARCH_MAX_THREADS)
+            {
+                fprintf(stderr, "Threads must be 0 (all cores) to %d\n", Config::SEARCH_MAX_THREADS);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc)
+        {
+            resumePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+        {
+            snapshotPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--profile") == 0)
+        {
+            profile = true;
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--difficulty easy|normal|hard|insane] [--weights FILE] [--map FILE] [--trail CELLS] [--nnue FILE] [--threads N] [--record FILE] [--snapshot FILE] [--resume FILE] [--profile]\n", argv[0]);
+            fprintf(stderr, "       %s --gen-book FILE [WIDTHxHEIGHT ...]\n", argv[0]);
+            fprintf(stderr, "       %s --pack-map MAP.txt MAP.bin\n", argv[0]);
+            fprintf(stderr, "       %s --train-nnue FILE [GAMES]\n", argv[0]);
+            fprintf(stderr, "       %s --export-cast REPLAY OUT.cast [ROUND [OUT.gif]]\n", argv[0]);
+            fprintf(stderr, "       %s --analyze REPLAY PREFIX [THREADS [VISITOR,...]]\n", argv[0]);
+            fprintf(stderr, "       %s --bench NAME\n", argv[0]);
+            fprintf(stderr, "       %s --tune CONFIG\n", argv[0]);
+            fprintf(stderr, "       %s --host MATCHES [THREADS [SECONDS]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Game game(80, 24);
+    if (!map.empty())
+        game.setMap(map);
+    string error;
+    if (replayPath && !game.setReplayFile(replayPath, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    // A resumed match is saved back where it came from unless --snapshot says otherwise.
+    if (resumePath && !game.loadSnapshot(resumePath, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (snapshotPath || resumePath)
+        game.setSnapshotFile(snapshotPath ? snapshotPath : resumePath);
+
+    // Every tick played from here on is charged to its stages and reported at exit.
+    TickProfiler profiler;
+    if (profile)
+    {
+        profiler.open();
+        profiler.install();
+    }
+
     setlocale(LC_ALL, "");
 
     printf("\033[?1049h\033[H");
@@ -18,8 +287,23 @@ int main(int argc, char **argv)
 
     Menu menu;
     menu.init();
+    menu.setBotDifficulty(difficulty);
+    menu.setTrailLength(trailLength);
+    menu.setSearchThreads(searchThreads);
+
+    if (resumePath)
+    {
+        game.init();
+        game.setColorScheme(menu.getColorScheme());
+        game.setSearchThreads(menu.getSearchThreads());
+        game.setNetwork(&network);
+        game.run();
+        game.cleanup();
+        menu.redraw();
+        nodelay(stdscr, FALSE);
+    }
 
-    while (true)
+    while (!game.wasSuspended())
     {
         menu.render();
 
@@ -31,18 +315,30 @@ int main(int argc, char **argv)
             }
             else if (menu.shouldStartGame())
             {
-                Game game(80, 24);
                 game.init();
                 game.setGameSpeed(menu.getGameSpeed());
                 game.setColorScheme(menu.getColorScheme());
                 game.setGameMode(menu.getGameMode());
+                game.setBotDifficulty(menu.getBotDifficulty());
+                game.setTrailLength(menu.getTrailLength());
+                game.setSearchThreads(menu.getSearchThreads());
+                game.setBotWeights(weights);
+                game.setNetwork(&network);
                 game.run();
+                game.cleanup();
+                if (game.wasSuspended())
+                    break;
                 menu.setState(MAIN_MENU);
+                menu.redraw();
                 nodelay(stdscr, FALSE);
             }
         }
     }
 
     endwin();
+    if (game.wasSuspended())
+        printf("Match saved to %s; continue it with --resume %s\n", game.getSnapshotFile().c_str(), game.getSnapshotFile().c_str());
+    if (profile)
+        profiler.report(stderr);
     return 0;
 }
\ No newline at end of file
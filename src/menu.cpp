@@ -1,21 +1,60 @@
 #include "../include/menu.h"
+#include "../include/bot.h"
+#include "../include/stats.h"
+#include <ctime>
+#include <cstdio>
 
-Menu::Menu() : currentState(MAIN_MENU), selectedOption(0), currentGameSpeed(NORMAL), currentColorScheme(0), currentGameMode(SINGLE_PLAYER)
+Menu::Menu() : currentState(MAIN_MENU), selectedOption(0), menuWidth(0), menuHeight(0), currentGameSpeed(NORMAL), currentColorScheme(0), currentGameMode(SINGLE_PLAYER), currentBotDifficulty(static_cast<BotDifficulty>(Config::DEFAULT_BOT_DIFFICULTY)), currentTrailLength(Config::TRAIL_LENGTH_FULL), currentSearchThreads(Config::DEFAULT_SEARCH_THREADS)
 {
-  mainMenuOptions = {
-      "Start Game",
-      "Game Mode",
-      "Settings",
-      "Quit"};
-  gameModeOptions = {
-      "Single Player",
-      "Two Player",
-      "vs Bot",
-      "Back"};
-  settingsOptions = {
-      "Game Speed",
-      "Colors",
-      "Back"};
+  // Indexed by MenuState. A next selection of -1 selects the entry for the current setting.
+  screens.resize(IN_GAME);
+  screens[MAIN_MENU] = {"      TRON GAME       ",
+                        {{"Start Game", MENU_START, 0, MAIN_MENU, 0},
+                         {"Game Mode", MENU_OPEN, 0, GAME_MODE_MENU, 0},
+                         {"Settings", MENU_OPEN, 0, SETTINGS_MENU, 0},
+                         {"Stats", MENU_OPEN, 0, STATS_MENU, 0},
+                         {"Quit", MENU_QUIT, 0, MAIN_MENU, 4}}};
+  screens[GAME_MODE_MENU] = {"    GAME MODE MENU    ",
+                             {{"Single Player", MENU_SET_MODE, SINGLE_PLAYER, MAIN_MENU, 0},
+                              {"Two Player", MENU_SET_MODE, TWO_PLAYER, MAIN_MENU, 0},
+                              {"vs Bot", MENU_SET_MODE, VS_BOT, MAIN_MENU, 0},
+                              {"Bot Battle", MENU_SET_MODE, BOT_BATTLE, MAIN_MENU, 0},
+                              {"Back", MENU_OPEN, 0, MAIN_MENU, 1}}};
+  screens[SETTINGS_MENU] = {"     SETTINGS MENU    ",
+                            {{"Game Speed", MENU_OPEN, 0, GAME_SPEED_MENU, 0},
+                             {"Colors", MENU_OPEN, 0, COLOR_SCHEME_MENU, 0},
+                             {"Difficulty", MENU_OPEN, 0, DIFFICULTY_MENU, -1},
+                             {"Trail", MENU_OPEN, 0, TRAIL_MENU, -1},
+                             {"Threads", MENU_OPEN, 0, THREADS_MENU, -1},
+                             {"Back", MENU_OPEN, 0, MAIN_MENU, 2}}};
+  screens[GAME_SPEED_MENU] = {"     GAME SPEED       ",
+                              {{"Slow", MENU_SET_SPEED, SLOW, SETTINGS_MENU, 0},
+                               {"Normal", MENU_SET_SPEED, NORMAL, SETTINGS_MENU, 0},
+                               {"Fast", MENU_SET_SPEED, FAST, SETTINGS_MENU, 0},
+                               {"Back", MENU_OPEN, 0, SETTINGS_MENU, 0}}};
+  screens[COLOR_SCHEME_MENU] = {"     COLOR SCHEME     ",
+                                {{"Color Scheme 1", MENU_SET_COLORS, 0, SETTINGS_MENU, 1},
+                                 {"Color Scheme 2", MENU_SET_COLORS, 1, SETTINGS_MENU, 1},
+                                 {"Color Scheme 3", MENU_SET_COLORS, 2, SETTINGS_MENU, 1},
+                                 {"Back", MENU_OPEN, 0, SETTINGS_MENU, 1}}};
+  screens[DIFFICULTY_MENU].title = "    BOT DIFFICULTY    ";
+  for (int i = 0; i < Config::NUM_BOT_DIFFICULTIES; i++)
+    screens[DIFFICULTY_MENU].items.push_back({"", MENU_SET_DIFFICULTY, i, SETTINGS_MENU, 2});
+  screens[DIFFICULTY_MENU].items.push_back({"Back", MENU_OPEN, 0, SETTINGS_MENU, 2});
+  screens[TRAIL_MENU] = {"     TRAIL LENGTH     ",
+                         {{"Full", MENU_SET_TRAIL, Config::TRAIL_LENGTH_FULL, SETTINGS_MENU, 3},
+                          {"Long", MENU_SET_TRAIL, Config::TRAIL_LENGTH_LONG, SETTINGS_MENU, 3},
+                          {"Short", MENU_SET_TRAIL, Config::TRAIL_LENGTH_SHORT, SETTINGS_MENU, 3},
+                          {"Back", MENU_OPEN, 0, SETTINGS_MENU, 3}}};
+  // Threads the Insane bot searches with.
+  screens[THREADS_MENU] = {"    SEARCH THREADS    ",
+                           {{"1 Thread", MENU_SET_THREADS, 1, SETTINGS_MENU, 4},
+                            {"2 Threads", MENU_SET_THREADS, 2, SETTINGS_MENU, 4},
+                            {"4 Threads", MENU_SET_THREADS, 4, SETTINGS_MENU, 4},
+                            {"All Cores", MENU_SET_THREADS, 0, SETTINGS_MENU, 4},
+                            {"Back", MENU_OPEN, 0, SETTINGS_MENU, 4}}};
+  screens[STATS_MENU] = {"      STATISTICS      ",
+                         {{"Back", MENU_OPEN, 0, MAIN_MENU, 3}}};
 }
 
 Menu::~Menu()
@@ -44,103 +83,226 @@ void Menu::initColors()
 
 void Menu::render()
 {
-  clear();
-
   int termHeight, termWidth;
   getmaxyx(stdscr, termHeight, termWidth);
-  (void)termHeight;
 
-  switch (currentState)
+  // Only the cells that differ from the last frame reach the terminal.
+  compose(termWidth, termHeight);
+  frame.flush(screen);
+}
+
+void Menu::compose(int width, int height)
+{
+  if (width != menuWidth || height != menuHeight)
   {
-  case MAIN_MENU:
-    showMainMenu();
-    break;
-  case GAME_MODE_MENU:
-    showGameModeMenu();
-    break;
-  case SETTINGS_MENU:
-    showSettingsMenu();
-    break;
-  case GAME_SPEED_MENU:
-    showGameSpeedMenu();
-    break;
-  case COLOR_SCHEME_MENU:
-    showColorSchemeMenu();
-    break;
-  case IN_GAME:
-    break;
+    menuWidth = width;
+    menuHeight = height;
+    frame.resize(width, height);
   }
 
-  refresh();
+  frame.clear();
+  if (currentState == STATS_MENU)
+    drawStats();
+  else if (currentState < IN_GAME)
+    drawScreen(screens[currentState]);
 }
 
-void Menu::showMainMenu()
+void Menu::describe(const MenuItem &item, char *text, int size) const
 {
-  int termHeight, termWidth;
-  getmaxyx(stdscr, termHeight, termWidth);
-
-  int centerX = termWidth / 2;
-  int centerY = termHeight / 2;
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-  mvprintw(centerY - 4, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-  mvprintw(centerY - 3, centerX - Config::MENU_BOX_HALF_WIDTH, "║      TRON GAME       ║");
-  mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-
-  if (selectedOption == 0)
+  if (item.action == MENU_SET_DIFFICULTY)
   {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Start Game         ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
+    snprintf(text, size, "%-16s %c", Bot::difficultyName(static_cast<BotDifficulty>(item.value)), isCurrent(item) ? '*' : ' ');
   }
-  else
+  else if (item.action == MENU_OPEN && item.next == DIFFICULTY_MENU)
   {
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Start Game         ║");
+    snprintf(text, size, "%s: %-6s", item.label, Bot::difficultyName(currentBotDifficulty));
   }
-
-  if (selectedOption == 1)
+  else if (item.action == MENU_SET_TRAIL || item.action == MENU_SET_THREADS)
+  {
+    snprintf(text, size, "%-16s %c", item.label, isCurrent(item) ? '*' : ' ');
+  }
+  else if (item.action == MENU_OPEN && item.next == TRAIL_MENU)
+  {
+    if (currentTrailLength == Config::TRAIL_LENGTH_FULL)
+      snprintf(text, size, "%s: Full", item.label);
+    else
+      snprintf(text, size, "%s: %d", item.label, currentTrailLength);
+  }
+  else if (item.action == MENU_OPEN && item.next == THREADS_MENU)
   {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Game Mode          ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
+    if (currentSearchThreads <= 0)
+      snprintf(text, size, "%s: All", item.label);
+    else
+      snprintf(text, size, "%s: %d", item.label, currentSearchThreads);
   }
   else
   {
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Game Mode          ║");
+    snprintf(text, size, "%s", item.label);
   }
+}
 
-  if (selectedOption == 2)
+void Menu::drawScreen(const MenuScreen &menu)
+{
+  int left = menuWidth / 2 - Config::MENU_BOX_HALF_WIDTH;
+  int y = menuHeight / 2 - 4;
+
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "╔══════════════════════╗");
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "║%s║", menu.title);
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "╠══════════════════════╣");
+
+  char text[64];
+  for (size_t i = 0; i < menu.items.size(); i++)
   {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Settings           ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
+    describe(menu.items[i], text, sizeof(text));
+    bool selected = static_cast<int>(i) == selectedOption;
+    frame.print(left, y++, selected ? Config::COLOR_MENU_SELECTED : Config::COLOR_MENU_TEXT, "║ %c %-18s ║", selected ? '>' : ' ', text);
   }
-  else
+  frame.print(left, y, Config::COLOR_MENU_TEXT, "╚══════════════════════╝");
+}
+
+void Menu::drawStats()
+{
+  static const char *const modeNames[Config::NUM_GAME_MODES] = {"Single Player", "Two Player", "vs Bot"};
+
+  int left = menuWidth / 2 - Config::STATS_BOX_HALF_WIDTH;
+  int y = menuHeight / 2 - 11;
+  int text = Config::COLOR_MENU_TEXT;
+  char line[64];
+
+  // Only reads what was appended since the screen was last shown.
+  StatsIndex stats = StatsStore::instance().snapshot();
+
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "╔══════════════════════════════════════╗");
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "║              STATISTICS              ║");
+  frame.print(left, y++, Config::COLOR_MENU_TITLE, "╠══════════════════════════════════════╣");
+
+  frame.print(left, y++, text, "║ %-36s ║", "Mode               Games   Longest");
+  for (int mode = 0; mode < Config::NUM_GAME_MODES; mode++)
   {
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Settings           ║");
+    snprintf(line, sizeof(line), "%-15s %8ld %8ds", modeNames[mode], stats.modes[mode].matches, stats.modes[mode].bestSeconds);
+    frame.print(left, y++, text, "║ %-36s ║", line);
   }
 
-  if (selectedOption == 3)
+  frame.print(left, y++, text, "╠══════════════════════════════════════╣");
+  frame.print(left, y++, text, "║ %-36s ║", "vs Bot         Won  Lost   Tie  Win%");
+  for (int level = 0; level < Config::NUM_BOT_DIFFICULTIES; level++)
   {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Quit               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
+    const ModeTotals &bot = stats.bots[level];
+    long rate = bot.matches > 0 ? bot.wins * 100 / bot.matches : 0;
+    snprintf(line, sizeof(line), "%-12s %5ld %5ld %5ld %4ld%%", Bot::difficultyName(static_cast<BotDifficulty>(level)), bot.wins,
+             bot.losses, bot.ties, rate);
+    frame.print(left, y++, text, "║ %-36s ║", line);
   }
-  else
+
+  frame.print(left, y++, text, "╠══════════════════════════════════════╣");
+  for (int i = 0; i < Config::STATS_RECENT_MATCHES; i++)
+  {
+    line[0] = '\0';
+    if (i == 0 && stats.recent.empty())
+    {
+      snprintf(line, sizeof(line), "No matches recorded yet");
+    }
+    else if (i < static_cast<int>(stats.recent.size()))
+    {
+      const MatchSummary &match = stats.recent[stats.recent.size() - 1 - i];
+      time_t when = static_cast<time_t>(match.time);
+      char date[16];
+      strftime(date, sizeof(date), "%m-%d %H:%M", localtime(&when));
+
+      char mode[16];
+      const char *result = "-";
+      if (match.mode == VS_BOT)
+      {
+        snprintf(mode, sizeof(mode), "Bot %s", Bot::difficultyName(match.difficulty));
+        result = match.winner == Config::WINNER_PLAYER1 ? "Won" : match.winner == Config::WINNER_PLAYER2 ? "Lost" : "Tie";
+      }
+      else if (match.mode == TWO_PLAYER)
+      {
+        snprintf(mode, sizeof(mode), "Two Player");
+        result = match.winner == Config::WINNER_PLAYER1 ? "P1 won" : match.winner == Config::WINNER_PLAYER2 ? "P2 won" : "Tie";
+      }
+      else
+      {
+        snprintf(mode, sizeof(mode), "Single");
+      }
+      snprintf(line, sizeof(line), "%s %-10s %-7s %4ds", date, mode, result, match.seconds);
+    }
+    frame.print(left, y++, text, "║ %-36s ║", line);
+  }
+
+  frame.print(left, y++, text, "╠══════════════════════════════════════╣");
+  frame.print(left, y++, Config::COLOR_MENU_SELECTED, "║ > Back                               ║");
+  frame.print(left, y++, text, "╚══════════════════════════════════════╝");
+}
+
+bool Menu::isCurrent(const MenuItem &item) const
+{
+  if (item.action == MENU_SET_DIFFICULTY)
+    return item.value == currentBotDifficulty;
+  if (item.action == MENU_SET_TRAIL)
+    return item.value == currentTrailLength;
+  if (item.action == MENU_SET_THREADS)
+    return item.value == currentSearchThreads;
+  return false;
+}
+
+const MenuItem *Menu::selectedItem() const
+{
+  if (currentState >= IN_GAME)
+    return nullptr;
+  const std::vector<MenuItem> &items = screens[currentState].items;
+  return selectedOption >= 0 && selectedOption < static_cast<int>(items.size()) ? &items[selectedOption] : nullptr;
+}
+
+void Menu::apply(const MenuItem &item)
+{
+  switch (item.action)
   {
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Quit               ║");
+  case MENU_SET_MODE:
+    currentGameMode = static_cast<GameMode>(item.value);
+    break;
+  case MENU_SET_SPEED:
+    currentGameSpeed = static_cast<GameSpeed>(item.value);
+    break;
+  case MENU_SET_COLORS:
+    currentColorScheme = item.value;
+    break;
+  case MENU_SET_DIFFICULTY:
+    currentBotDifficulty = static_cast<BotDifficulty>(item.value);
+    break;
+  case MENU_SET_TRAIL:
+    currentTrailLength = item.value;
+    break;
+  case MENU_SET_THREADS:
+    currentSearchThreads = item.value;
+    break;
+  case MENU_OPEN:
+  case MENU_START:
+  case MENU_QUIT:
+    break;
   }
 
-  mvprintw(centerY + 3, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TEXT));
+  currentState = item.next;
+  selectedOption = item.nextSelection;
+  if (selectedOption < 0)
+  {
+    const std::vector<MenuItem> &items = screens[currentState].items;
+    selectedOption = 0;
+    for (size_t i = 0; i < items.size(); i++)
+    {
+      if (isCurrent(items[i]))
+        selectedOption = static_cast<int>(i);
+    }
+  }
 }
 
 bool Menu::handleInput()
 {
-  int ch = getch();
+  return handleKey(getch());
+}
+
+bool Menu::handleKey(int ch)
+{
   switch (ch)
   {
   case KEY_UP:
@@ -150,134 +312,21 @@ bool Menu::handleInput()
     }
     break;
   case KEY_DOWN:
-  {
-    int maxOptions = 0;
-    if (currentState == MAIN_MENU)
-      maxOptions = mainMenuOptions.size();
-    else if (currentState == GAME_MODE_MENU)
-      maxOptions = gameModeOptions.size();
-    else if (currentState == SETTINGS_MENU)
-      maxOptions = settingsOptions.size();
-    else if (currentState == GAME_SPEED_MENU)
-      maxOptions = 4;
-    else if (currentState == COLOR_SCHEME_MENU)
-      maxOptions = 4;
-
-    if (selectedOption < maxOptions - 1)
+    if (currentState < IN_GAME && selectedOption < static_cast<int>(screens[currentState].items.size()) - 1)
     {
       selectedOption++;
     }
     break;
-  }
   case '\n':
   case ' ':
-    if (currentState == MAIN_MENU)
-    {
-      if (selectedOption == 1)
-      {
-        currentState = GAME_MODE_MENU;
-        resetSelection();
-      }
-      else if (selectedOption == 2)
-      {
-        currentState = SETTINGS_MENU;
-        resetSelection();
-      }
-    }
-    else if (currentState == GAME_MODE_MENU)
-    {
-      if (selectedOption == 0)
-      {
-        currentGameMode = SINGLE_PLAYER;
-        currentState = MAIN_MENU;
-        selectedOption = 0;
-        resetSelection();
-      }
-      else if (selectedOption == 1)
-      {
-        currentGameMode = TWO_PLAYER;
-        currentState = MAIN_MENU;
-        selectedOption = 0;
-        resetSelection();
-      }
-      else if (selectedOption == 2)
-      {
-        currentGameMode = VS_BOT;
-        currentState = MAIN_MENU;
-        selectedOption = 0;
-        resetSelection();
-      }
-      else if (selectedOption == 3)
-      {
-        currentState = MAIN_MENU;
-        selectedOption = 1;
-      }
-    }
-    else if (currentState == SETTINGS_MENU)
-    {
-      if (selectedOption == 0)
-      {
-        currentState = GAME_SPEED_MENU;
-        resetSelection();
-      }
-      else if (selectedOption == 1)
-      {
-        currentState = COLOR_SCHEME_MENU;
-        resetSelection();
-      }
-      else if (selectedOption == 2)
-      {
-        currentState = MAIN_MENU;
-        selectedOption = 2;
-      }
-    }
-    else if (currentState == GAME_SPEED_MENU)
-    {
-      if (selectedOption == 0)
-      {
-        currentGameSpeed = SLOW;
-        currentState = SETTINGS_MENU;
-        selectedOption = 0;
-      }
-      else if (selectedOption == 1)
-      {
-        currentGameSpeed = NORMAL;
-        currentState = SETTINGS_MENU;
-        selectedOption = 0;
-      }
-      else if (selectedOption == 2)
-      {
-        currentGameSpeed = FAST;
-        currentState = SETTINGS_MENU;
-        selectedOption = 0;
-      }
-      else if (selectedOption == 3)
-      {
-        currentState = SETTINGS_MENU;
-        selectedOption = 0;
-      }
-    }
-    else if (currentState == COLOR_SCHEME_MENU)
-    {
-      if (selectedOption >= 0 && selectedOption < 3)
-      {
-        currentColorScheme = selectedOption;
-        currentState = SETTINGS_MENU;
-        selectedOption = 1;
-      }
-      else if (selectedOption == 3)
-      {
-        currentState = SETTINGS_MENU;
-        selectedOption = 1;
-      }
-    }
-
+    if (const MenuItem *item = selectedItem())
+      apply(*item);
     return true;
   case 'q':
   case 'Q':
   case 27:
     currentState = MAIN_MENU;
-    selectedOption = 3;
+    selectedOption = static_cast<int>(screens[MAIN_MENU].items.size()) - 1;
     return true;
   }
   return false;
@@ -285,12 +334,14 @@ bool Menu::handleInput()
 
 bool Menu::shouldStartGame() const
 {
-  return (currentState == MAIN_MENU && selectedOption == 0);
+  const MenuItem *item = selectedItem();
+  return currentState == MAIN_MENU && item && item->action == MENU_START;
 }
 
 bool Menu::shouldQuit() const
 {
-  return (currentState == MAIN_MENU && selectedOption == 3);
+  const MenuItem *item = selectedItem();
+  return currentState == MAIN_MENU && item && item->action == MENU_QUIT;
 }
 
 void Menu::setState(MenuState newState)
@@ -303,228 +354,3 @@ void Menu::resetSelection()
 {
   selectedOption = 0;
 }
-
-void Menu::showGameModeMenu()
-{
-  int termHeight, termWidth;
-  getmaxyx(stdscr, termHeight, termWidth);
-
-  int centerX = termWidth / 2;
-  int centerY = termHeight / 2;
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-  mvprintw(centerY - 4, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-  mvprintw(centerY - 3, centerX - Config::MENU_BOX_HALF_WIDTH, "║    GAME MODE MENU    ║");
-  mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-
-  if (selectedOption == 0)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Single Player      ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Single Player      ║");
-  }
-
-  if (selectedOption == 1)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Two Player         ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Two Player         ║");
-  }
-
-  if (selectedOption == 2)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > vs Bot             ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   vs Bot             ║");
-  }
-
-  if (selectedOption == 3)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Back               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Back               ║");
-  }
-
-  mvprintw(centerY + 3, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-}
-
-void Menu::showSettingsMenu()
-{
-  int termHeight, termWidth;
-  getmaxyx(stdscr, termHeight, termWidth);
-
-  int centerX = termWidth / 2;
-  int centerY = termHeight / 2;
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-  mvprintw(centerY - 4, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-  mvprintw(centerY - 3, centerX - Config::MENU_BOX_HALF_WIDTH, "║     SETTINGS MENU    ║");
-  mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-
-  if (selectedOption == 0)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Game Speed         ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Game Speed         ║");
-  }
-
-  if (selectedOption == 1)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Colors             ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Colors             ║");
-  }
-
-  if (selectedOption == 2)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Back               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Back               ║");
-  }
-
-  mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-}
-
-void Menu::showGameSpeedMenu()
-{
-  int termHeight, termWidth;
-  getmaxyx(stdscr, termHeight, termWidth);
-
-  int centerX = termWidth / 2;
-  int centerY = termHeight / 2;
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-  mvprintw(centerY - 4, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-  mvprintw(centerY - 3, centerX - Config::MENU_BOX_HALF_WIDTH, "║     GAME SPEED       ║");
-  mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-
-  if (selectedOption == 0)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Slow               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY - 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Slow               ║");
-  }
-
-  if (selectedOption == 1)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Normal             ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Normal             ║");
-  }
-
-  if (selectedOption == 2)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Fast               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 1, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Fast               ║");
-  }
-
-  if (selectedOption == 3)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Back               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Back               ║");
-  }
-  mvprintw(centerY + 3, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-}
-
-void Menu::showColorSchemeMenu()
-{
-  int termHeight, termWidth;
-  getmaxyx(stdscr, termHeight, termWidth);
-
-  int centerX = termWidth / 2;
-  int centerY = termHeight / 2;
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-  mvprintw(centerY - 4, centerX - Config::MENU_BOX_HALF_WIDTH, "╔══════════════════════╗");
-  mvprintw(centerY - 3, centerX - Config::MENU_BOX_HALF_WIDTH, "║     COLOR SCHEME     ║");
-  mvprintw(centerY - 2, centerX - Config::MENU_BOX_HALF_WIDTH, "╠══════════════════════╣");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TITLE));
-
-  attron(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-
-  for (int i = 0; i < 3; ++i)
-  {
-    if (selectedOption == i)
-    {
-      attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-      mvprintw(centerY - 1 + i, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Color Scheme %d     ║", i + 1);
-      attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    }
-    else
-    {
-      mvprintw(centerY - 1 + i, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Color Scheme %d     ║", i + 1);
-    }
-  }
-
-  if (selectedOption == 3)
-  {
-    attron(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║ > Back               ║");
-    attroff(COLOR_PAIR(Config::COLOR_MENU_SELECTED));
-  }
-  else
-  {
-    mvprintw(centerY + 2, centerX - Config::MENU_BOX_HALF_WIDTH, "║   Back               ║");
-  }
-
-  mvprintw(centerY + 3, centerX - Config::MENU_BOX_HALF_WIDTH, "╚══════════════════════╝");
-  attroff(COLOR_PAIR(Config::COLOR_MENU_TEXT));
-}
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "../include/nnue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const char NNUE_MAGIC[8] = {'T', 'R', 'O', 'N', 'N', 'N', 'U', 'E'};
+    const uint32_t NNUE_VERSION = 1;
+    const int INPUT_SCALE = 127;
+    const int WEIGHT_SCALE = 64;
+    const int WEIGHT_SHIFT = 6;
+    const int HEAD_FEATURES = 2 * Config::NNUE_PATCH_CELLS;
+
+    struct NnueHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t patchRadius;
+        uint32_t anchorStep;
+        uint32_t hidden;
+        uint32_t layer2;
+    };
+
+    int anchorCenter(int coordinate)
+    {
+        return coordinate - coordinate % Config::NNUE_ANCHOR_STEP + Config::NNUE_ANCHOR_STEP / 2;
+    }
+
+    int clampActivation(int value)
+    {
+        return std::min(std::max(value, 0), INPUT_SCALE);
+    }
+
+    template <typename T>
+    T quantized(float value, float scale)
+    {
+        float limit = static_cast<float>(std::numeric_limits<T>::max());
+        return static_cast<T>(std::lround(std::min(std::max(value * scale, -limit), limit)));
+    }
+
+    template <typename T>
+    bool readArray(FILE *file, std::vector<T> &values, size_t count)
+    {
+        values.resize(count);
+        return fread(values.data(), sizeof(T), count, file) == count;
+    }
+
+    template <typename T>
+    bool writeArray(FILE *file, const std::vector<T> &values)
+    {
+        return fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+    }
+}
+
+NnueFloatWeights::NnueFloatWeights()
+    : input(static_cast<size_t>(Config::NNUE_FEATURES) * Config::NNUE_HIDDEN), inputBias(Config::NNUE_HIDDEN),
+      hidden(static_cast<size_t>(2 * Config::NNUE_HIDDEN) * Config::NNUE_LAYER2), hiddenBias(Config::NNUE_LAYER2),
+      output(Config::NNUE_LAYER2)
+{
+}
+
+NnueNetwork::NnueNetwork() : outputBias(0) {}
+
+int NnueNetwork::patchIndex(const NnueAccumulator &acc, int x, int y)
+{
+    int px = x - acc.centerX + Config::NNUE_PATCH_RADIUS;
+    int py = y - acc.centerY + Config::NNUE_PATCH_RADIUS;
+    if (px < 0 || py < 0 || px >= Config::NNUE_PATCH || py >= Config::NNUE_PATCH)
+        return -1;
+    return py * Config::NNUE_PATCH + px;
+}
+
+int NnueNetwork::headFeature(int x, int y)
+{
+    return HEAD_FEATURES + (y % Config::NNUE_ANCHOR_STEP) * Config::NNUE_ANCHOR_STEP + x % Config::NNUE_ANCHOR_STEP;
+}
+
+// Fixed-width int16 adds into a local row (which cannot alias the weights), so the
+// compiler turns them into vector adds.
+void NnueNetwork::apply(NnueAccumulator &acc, int feature, int sign) const
+{
+    const int16_t *row = &inputWeights[static_cast<size_t>(feature) * Config::NNUE_HIDDEN];
+    int16_t sums[Config::NNUE_HIDDEN];
+    if (sign > 0)
+    {
+        for (int k = 0; k < Config::NNUE_HIDDEN; k++)
+            sums[k] = static_cast<int16_t>(acc.values[k] + row[k]);
+    }
+    else
+    {
+        for (int k = 0; k < Config::NNUE_HIDDEN; k++)
+            sums[k] = static_cast<int16_t>(acc.values[k] - row[k]);
+    }
+    std::copy(sums, sums + Config::NNUE_HIDDEN, acc.values);
+}
+
+void NnueNetwork::refresh(NnueAccumulator &acc, const Grid &grid, int headX, int headY, int otherX, int otherY) const
+{
+    acc.centerX = anchorCenter(headX);
+    acc.centerY = anchorCenter(headY);
+    acc.headX = headX;
+    acc.headY = headY;
+    acc.otherX = otherX;
+    acc.otherY = otherY;
+    std::copy(inputBias.begin(), inputBias.end(), acc.values);
+
+    for (int py = 0; py < Config::NNUE_PATCH; py++)
+    {
+        int y = acc.centerY - Config::NNUE_PATCH_RADIUS + py;
+        for (int px = 0; px < Config::NNUE_PATCH; px++)
+        {
+            if (grid.get(acc.centerX - Config::NNUE_PATCH_RADIUS + px, y) != Config::CELL_EMPTY)
+                apply(acc, py * Config::NNUE_PATCH + px, 1);
+        }
+    }
+
+    int other = patchIndex(acc, otherX, otherY);
+    if (other >= 0)
+        apply(acc, Config::NNUE_PATCH_CELLS + other, 1);
+    apply(acc, headFeature(headX, headY), 1);
+}
+
+void NnueNetwork::setCell(NnueAccumulator &acc, int x, int y, bool blocked) const
+{
+    int index = patchIndex(acc, x, y);
+    if (index >= 0)
+        apply(acc, index, blocked ? 1 : -1);
+}
+
+// A head that stays inside its anchor block only swaps one feature; leaving the block
+// moves the whole patch, which is a refresh.
+void NnueNetwork::moveHeads(NnueAccumulator &acc, const Grid &grid, int headX, int headY, int otherX, int otherY) const
+{
+    if (anchorCenter(headX) != acc.centerX || anchorCenter(headY) != acc.centerY)
+    {
+        refresh(acc, grid, headX, headY, otherX, otherY);
+        return;
+    }
+
+    if (headX != acc.headX || headY != acc.headY)
+    {
+        apply(acc, headFeature(acc.headX, acc.headY), -1);
+        apply(acc, headFeature(headX, headY), 1);
+        acc.headX = headX;
+        acc.headY = headY;
+    }
+
+    if (otherX != acc.otherX || otherY != acc.otherY)
+    {
+        int before = patchIndex(acc, acc.otherX, acc.otherY);
+        int after = patchIndex(acc, otherX, otherY);
+        if (before >= 0)
+            apply(acc, Config::NNUE_PATCH_CELLS + before, -1);
+        if (after >= 0)
+            apply(acc, Config::NNUE_PATCH_CELLS + after, 1);
+        acc.otherX = otherX;
+        acc.otherY = otherY;
+    }
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator &self, const NnueAccumulator &other) const
+{
+    int32_t hidden[Config::NNUE_LAYER2];
+    std::copy(hiddenBias.begin(), hiddenBias.end(), hidden);
+
+    const NnueAccumulator *views[2] = {&self, &other};
+    for (int v = 0; v < 2; v++)
+    {
+        for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+        {
+            int input = clampActivation(views[v]->values[j]);
+            if (input == 0)
+                continue;
+            const int8_t *row = &hiddenWeights[static_cast<size_t>(v * Config::NNUE_HIDDEN + j) * Config::NNUE_LAYER2];
+            for (int k = 0; k < Config::NNUE_LAYER2; k++)
+                hidden[k] += input * row[k];
+        }
+    }
+
+    int32_t out = outputBias;
+    for (int k = 0; k < Config::NNUE_LAYER2; k++)
+        out += clampActivation(hidden[k] >> WEIGHT_SHIFT) * outputWeights[k];
+    return static_cast<int>(static_cast<int64_t>(out) * Config::NNUE_LABEL_CELLS / (INPUT_SCALE * WEIGHT_SCALE));
+}
+
+int NnueNetwork::features(const Grid &grid, int headX, int headY, int otherX, int otherY, int *out)
+{
+    NnueAccumulator view;
+    view.centerX = anchorCenter(headX);
+    view.centerY = anchorCenter(headY);
+
+    int count = 0;
+    for (int py = 0; py < Config::NNUE_PATCH; py++)
+    {
+        int y = view.centerY - Config::NNUE_PATCH_RADIUS + py;
+        for (int px = 0; px < Config::NNUE_PATCH; px++)
+        {
+            if (grid.get(view.centerX - Config::NNUE_PATCH_RADIUS + px, y) != Config::CELL_EMPTY)
+                out[count++] = py * Config::NNUE_PATCH + px;
+        }
+    }
+    int other = patchIndex(view, otherX, otherY);
+    if (other >= 0)
+        out[count++] = Config::NNUE_PATCH_CELLS + other;
+    out[count++] = headFeature(headX, headY);
+    return count;
+}
+
+// Activations are scaled by 127 and weights by 64: an int16 accumulator holds at most
+// NNUE_PATCH_CELLS + 2 inputs of |w| <= 127, and each layer shifts the 64 back out.
+void NnueNetwork::quantize(const NnueFloatWeights &weights)
+{
+    inputWeights.resize(weights.input.size());
+    for (size_t i = 0; i < weights.input.size(); i++)
+        inputWeights[i] = quantized<int16_t>(std::min(std::max(weights.input[i], -1.0f), 1.0f), INPUT_SCALE);
+    inputBias.resize(weights.inputBias.size());
+    for (size_t i = 0; i < weights.inputBias.size(); i++)
+        inputBias[i] = quantized<int16_t>(std::min(std::max(weights.inputBias[i], -1.0f), 1.0f), INPUT_SCALE);
+    hiddenWeights.resize(weights.hidden.size());
+    for (size_t i = 0; i < weights.hidden.size(); i++)
+        hiddenWeights[i] = quantized<int8_t>(weights.hidden[i], WEIGHT_SCALE);
+    hiddenBias.resize(weights.hiddenBias.size());
+    for (size_t i = 0; i < weights.hiddenBias.size(); i++)
+        hiddenBias[i] = quantized<int32_t>(weights.hiddenBias[i], INPUT_SCALE * WEIGHT_SCALE);
+    outputWeights.resize(weights.output.size());
+    for (size_t i = 0; i < weights.output.size(); i++)
+        outputWeights[i] = quantized<int8_t>(weights.output[i], WEIGHT_SCALE);
+    outputBias = quantized<int32_t>(weights.outputBias, INPUT_SCALE * WEIGHT_SCALE);
+}
+
+bool NnueNetwork::load(const std::string &path, std::string &error)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    NnueHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC)) == 0 &&
+              header.version == NNUE_VERSION;
+    if (ok && (header.patchRadius != Config::NNUE_PATCH_RADIUS || header.anchorStep != Config::NNUE_ANCHOR_STEP ||
+               header.hidden != Config::NNUE_HIDDEN || header.layer2 != Config::NNUE_LAYER2))
+    {
+        fclose(file);
+        error = "network was built for a different layout";
+        return false;
+    }
+
+    ok = ok && readArray(file, inputWeights, static_cast<size_t>(Config::NNUE_FEATURES) * Config::NNUE_HIDDEN) &&
+         readArray(file, inputBias, Config::NNUE_HIDDEN) &&
+         readArray(file, hiddenWeights, static_cast<size_t>(2 * Config::NNUE_HIDDEN) * Config::NNUE_LAYER2) &&
+         readArray(file, hiddenBias, Config::NNUE_LAYER2) && readArray(file, outputWeights, Config::NNUE_LAYER2) &&
+         fread(&outputBias, sizeof(outputBias), 1, file) == 1;
+    fclose(file);
+    if (!ok)
+    {
+        inputWeights.clear();
+        error = "not a network file, or truncated";
+    }
+    return ok;
+}
+
+bool NnueNetwork::save(const std::string &path) const
+{
+    NnueHeader header;
+    memcpy(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC));
+    header.version = NNUE_VERSION;
+    header.patchRadius = Config::NNUE_PATCH_RADIUS;
+    header.anchorStep = Config::NNUE_ANCHOR_STEP;
+    header.hidden = Config::NNUE_HIDDEN;
+    header.layer2 = Config::NNUE_LAYER2;
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        perror(path.c_str());
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && writeArray(file, inputWeights) && writeArray(file, inputBias) &&
+              writeArray(file, hiddenWeights) && writeArray(file, hiddenBias) && writeArray(file, outputWeights) &&
+              fwrite(&outputBias, sizeof(outputBias), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+        fprintf(stderr, "Failed to write network to %s\n", path.c_str());
+    return ok;
+}
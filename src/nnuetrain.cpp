@@ -0,0 +1,287 @@
+#include "../include/nnue.h"
+#include "../include/arena.h"
+#include "../include/engine.h"
+#include "../include/game.h"
+#include "../include/search.h"
+#include "../include/rng.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const long TRAINER_MICROS_PER_TICK = 3600L * 1000 * 1000;
+    const float LEARNING_RATE = 0.0005f;
+    const float LEARNING_DECAY = 0.8f;
+    const float HIDDEN_WEIGHT_LIMIT = 127.0f / 64.0f;
+    const int VALIDATION_SHARE = 20;
+
+    // Both views of one position as active feature indexes in the shared pool.
+    struct NnueSample
+    {
+        uint32_t selfBegin;
+        uint32_t otherBegin;
+        uint32_t end;
+        float label;
+    };
+
+    struct NnueSet
+    {
+        std::vector<uint16_t> features;
+        std::vector<NnueSample> samples;
+    };
+
+    struct NnueTrainer
+    {
+        NnueFloatWeights w;
+        float acc[2][Config::NNUE_HIDDEN];
+        float h1[2][Config::NNUE_HIDDEN];
+        float z2[Config::NNUE_LAYER2];
+        float h2[Config::NNUE_LAYER2];
+
+        float forward(const NnueSet &set, const NnueSample &sample)
+        {
+            const uint32_t bounds[3] = {sample.selfBegin, sample.otherBegin, sample.end};
+            for (int v = 0; v < 2; v++)
+            {
+                std::copy(w.inputBias.begin(), w.inputBias.end(), acc[v]);
+                for (uint32_t f = bounds[v]; f < bounds[v + 1]; f++)
+                {
+                    const float *row = &w.input[static_cast<size_t>(set.features[f]) * Config::NNUE_HIDDEN];
+                    for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+                        acc[v][j] += row[j];
+                }
+                for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+                    h1[v][j] = std::min(std::max(acc[v][j], 0.0f), 1.0f);
+            }
+
+            std::copy(w.hiddenBias.begin(), w.hiddenBias.end(), z2);
+            for (int v = 0; v < 2; v++)
+            {
+                for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+                {
+                    const float *row = &w.hidden[static_cast<size_t>(v * Config::NNUE_HIDDEN + j) * Config::NNUE_LAYER2];
+                    for (int k = 0; k < Config::NNUE_LAYER2; k++)
+                        z2[k] += h1[v][j] * row[k];
+                }
+            }
+
+            float y = w.outputBias;
+            for (int k = 0; k < Config::NNUE_LAYER2; k++)
+            {
+                h2[k] = std::min(std::max(z2[k], 0.0f), 1.0f);
+                y += h2[k] * w.output[k];
+            }
+            return y;
+        }
+
+        // One SGD step on the squared error; weights stay inside what quantize() can hold.
+        void backward(const NnueSet &set, const NnueSample &sample, float error, float rate)
+        {
+            float dz2[Config::NNUE_LAYER2];
+            for (int k = 0; k < Config::NNUE_LAYER2; k++)
+            {
+                dz2[k] = (z2[k] > 0.0f && z2[k] < 1.0f) ? error * w.output[k] : 0.0f;
+                w.output[k] = std::min(std::max(w.output[k] - rate * error * h2[k], -HIDDEN_WEIGHT_LIMIT), HIDDEN_WEIGHT_LIMIT);
+            }
+            w.outputBias -= rate * error;
+
+            const uint32_t bounds[3] = {sample.selfBegin, sample.otherBegin, sample.end};
+            for (int v = 0; v < 2; v++)
+            {
+                float dacc[Config::NNUE_HIDDEN];
+                for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+                {
+                    float *row = &w.hidden[static_cast<size_t>(v * Config::NNUE_HIDDEN + j) * Config::NNUE_LAYER2];
+                    float dh = 0.0f;
+                    for (int k = 0; k < Config::NNUE_LAYER2; k++)
+                    {
+                        dh += dz2[k] * row[k];
+                        row[k] = std::min(std::max(row[k] - rate * dz2[k] * h1[v][j], -HIDDEN_WEIGHT_LIMIT), HIDDEN_WEIGHT_LIMIT);
+                    }
+                    dacc[j] = (acc[v][j] > 0.0f && acc[v][j] < 1.0f) ? dh : 0.0f;
+                    w.inputBias[j] = std::min(std::max(w.inputBias[j] - rate * dacc[j], -1.0f), 1.0f);
+                }
+                for (uint32_t f = bounds[v]; f < bounds[v + 1]; f++)
+                {
+                    float *row = &w.input[static_cast<size_t>(set.features[f]) * Config::NNUE_HIDDEN];
+                    for (int j = 0; j < Config::NNUE_HIDDEN; j++)
+                        row[j] = std::min(std::max(row[j] - rate * dacc[j], -1.0f), 1.0f);
+                }
+            }
+            for (int k = 0; k < Config::NNUE_LAYER2; k++)
+                w.hiddenBias[k] -= rate * dz2[k];
+        }
+    };
+
+    float uniform(Rng &rng, float limit)
+    {
+        return (static_cast<float>(rng.next() >> 40) / static_cast<float>(1 << 24) * 2.0f - 1.0f) * limit;
+    }
+
+    void initialize(NnueFloatWeights &w, Rng &rng)
+    {
+        for (float &value : w.input)
+            value = uniform(rng, 0.05f);
+        std::fill(w.inputBias.begin(), w.inputBias.end(), 0.5f);
+        for (float &value : w.hidden)
+            value = uniform(rng, 0.2f);
+        std::fill(w.hiddenBias.begin(), w.hiddenBias.end(), 0.1f);
+        for (float &value : w.output)
+            value = uniform(rng, 0.2f);
+        w.outputBias = 0.0f;
+    }
+
+    // Labels every free move of both riders: the move is made, then the territory split
+    // of the resulting position is scored in hundreds of cells.
+    void sample(NnueSet &set, Grid &scratch, Search &search, const TickCore &engine, const Player &first, const Player &second)
+    {
+        static const int dx[] = {0, 0, -1, 1};
+        static const int dy[] = {-1, 1, 0, 0};
+        int buffer[Config::NNUE_PATCH_CELLS + 2];
+
+        scratch = engine.getGrid();
+        const Player *riders[2] = {&first, &second};
+        for (int r = 0; r < 2; r++)
+        {
+            const Player &self = *riders[r];
+            const Player &other = *riders[1 - r];
+            for (int d = 0; d < 4; d++)
+            {
+                int x = self.getX() + dx[d];
+                int y = self.getY() + dy[d];
+                if (!scratch.isFree(x, y))
+                    continue;
+
+                scratch.set(x, y, Config::CELL_WALL);
+                NnueSample entry;
+                entry.selfBegin = static_cast<uint32_t>(set.features.size());
+                int count = NnueNetwork::features(scratch, x, y, other.getX(), other.getY(), buffer);
+                set.features.insert(set.features.end(), buffer, buffer + count);
+                entry.otherBegin = static_cast<uint32_t>(set.features.size());
+                count = NnueNetwork::features(scratch, other.getX(), other.getY(), x, y, buffer);
+                set.features.insert(set.features.end(), buffer, buffer + count);
+                entry.end = static_cast<uint32_t>(set.features.size());
+
+                float cells = static_cast<float>(search.territory(scratch, x, y, other.getX(), other.getY()));
+                float limit = static_cast<float>(Config::NNUE_LABEL_LIMIT);
+                entry.label = std::min(std::max(cells / Config::NNUE_LABEL_CELLS, -limit), limit);
+                set.samples.push_back(entry);
+                scratch.set(x, y, Config::CELL_EMPTY);
+            }
+        }
+    }
+
+    // Self-play between Easy and Normal bots, laid out like the tuner's table.
+    void collect(NnueSet &set, int games, uint64_t seed, bool verbose)
+    {
+        const int width = Config::NNUE_TRAIN_WIDTH;
+        const int height = Config::NNUE_TRAIN_HEIGHT;
+        MatchArena arena(0, 2);
+        arena.reserve(width, height);
+        Bot &bot1 = *arena.acquireBot(0, 0, RIGHT);
+        Bot &bot2 = *arena.acquireBot(0, 0, LEFT);
+        TickEngine<BotController, BotController> engine(width, height, BotController(bot1, *bot2.getPlayer(), width, height),
+                                                        BotController(bot2, *bot1.getPlayer(), width, height));
+        Grid scratch(width, height);
+        Search search;
+        Rng rng(seed);
+
+        for (int game = 0; game < games; game++)
+        {
+            int side1 = rng.range(0, Config::NUM_SIDES - 1);
+            int side2 = (side1 + 2) % Config::NUM_SIDES;
+            auto pos1 = Game::getPositionOnSide(side1, rng.range(0, Game::getSideSpan(side1, width, height) - 1), width, height);
+            auto pos2 = Game::getPositionOnSide(side2, rng.range(0, Game::getSideSpan(side2, width, height) - 1), width, height);
+
+            arena.reset();
+            Bot &first = *arena.acquireBot(pos1.first, pos1.second, Game::getSafeDirection(side1));
+            Bot &second = *arena.acquireBot(pos2.first, pos2.second, Game::getSafeDirection(side2));
+            Bot *bots[2] = {&first, &second};
+            for (int b = 0; b < 2; b++)
+            {
+                BotBudget budget = Bot::budgetFor(rng.range(0, 1) ? BOT_NORMAL : BOT_EASY);
+                budget.maxMicros = TRAINER_MICROS_PER_TICK;
+                bots[b]->setBudget(budget);
+                bots[b]->seedNoise(rng.next());
+            }
+            engine.reset();
+
+            for (int tick = 0; tick < width * height; tick++)
+            {
+                if (engine.tick().finished)
+                    break;
+                if (rng.range(0, Config::NNUE_SAMPLE_ODDS - 1) == 0)
+                    sample(set, scratch, search, engine, *first.getPlayer(), *second.getPlayer());
+            }
+
+            if (verbose && (game + 1) % 50 == 0)
+                printf("  %d/%d games, %zu positions\n", game + 1, games, set.samples.size());
+        }
+    }
+}
+
+bool NnueNetwork::train(NnueNetwork &network, int games, uint64_t seed, bool verbose)
+{
+    NnueSet set;
+    collect(set, games, seed, verbose);
+    if (set.samples.size() < static_cast<size_t>(VALIDATION_SHARE) * 2)
+    {
+        fprintf(stderr, "Self-play produced too few positions to train on\n");
+        return false;
+    }
+
+    Rng rng(seed ^ 0x9e3779b97f4a7c15ULL);
+    for (size_t i = set.samples.size() - 1; i > 0; i--)
+        std::swap(set.samples[i], set.samples[rng.next() % (i + 1)]);
+    size_t held = set.samples.size() / VALIDATION_SHARE;
+    size_t trainCount = set.samples.size() - held;
+
+    double mean = 0.0;
+    for (size_t i = 0; i < trainCount; i++)
+        mean += set.samples[i].label;
+    mean /= trainCount;
+    double baseline = 0.0;
+    for (size_t i = trainCount; i < set.samples.size(); i++)
+        baseline += std::fabs(mean - set.samples[i].label);
+    if (verbose)
+        printf("%zu positions; guessing the mean is off by %.1f cells\n", set.samples.size(), baseline / held * Config::NNUE_LABEL_CELLS);
+
+    NnueTrainer trainer;
+    initialize(trainer.w, rng);
+    float rate = LEARNING_RATE;
+    for (int epoch = 0; epoch < Config::NNUE_TRAIN_EPOCHS; epoch++)
+    {
+        double loss = 0.0;
+        for (size_t i = 0; i < trainCount; i++)
+        {
+            size_t pick = rng.next() % trainCount;
+            const NnueSample &entry = set.samples[pick];
+            float error = trainer.forward(set, entry) - entry.label;
+            loss += error * error;
+            trainer.backward(set, entry, error, rate);
+        }
+
+        double absolute = 0.0;
+        for (size_t i = trainCount; i < set.samples.size(); i++)
+            absolute += std::fabs(trainer.forward(set, set.samples[i]) - set.samples[i].label);
+        if (verbose)
+            printf("Epoch %d: training loss %.4f, validation error %.1f cells\n", epoch + 1, loss / trainCount,
+                   absolute / held * Config::NNUE_LABEL_CELLS);
+        rate *= LEARNING_DECAY;
+    }
+
+    network.quantize(trainer.w);
+    return true;
+}
+
+bool NnueNetwork::train(const std::string &path, int games, uint64_t seed)
+{
+    printf("Collecting positions from %d self-play games on %dx%d...\n", games, Config::NNUE_TRAIN_WIDTH, Config::NNUE_TRAIN_HEIGHT);
+    NnueNetwork network;
+    if (!train(network, games, seed, true) || !network.save(path))
+        return false;
+    printf("Saved network to %s\n", path.c_str());
+    return true;
+}
@@ -0,0 +1,89 @@
+#include "../include/pacer.h"
+#include <sys/ioctl.h>
+#include <termios.h>
+
+RenderPacer::RenderPacer()
+    : unitMicros(1), level(0), sinceFrame(0), settleFrames(0), calmFrames(0), adaptive(true), load(0), throughput(0), lastPending(0),
+      frames(0), changes(0)
+{
+}
+
+void RenderPacer::reset(long micros)
+{
+    unitMicros = micros > 0 ? micros : 1;
+    level = 0;
+    sinceFrame = 0;
+    // The first frames repaint the whole screen.
+    settleFrames = Config::PACER_SETTLE_FRAMES;
+    calmFrames = 0;
+    load = 0;
+    lastPending = 0;
+}
+
+void RenderPacer::setAdaptive(bool enabled)
+{
+    adaptive = enabled;
+    if (!adaptive)
+        level = 0;
+}
+
+void RenderPacer::setLevel(int next)
+{
+    if (next < 0 || next >= Config::NUM_PACER_LEVELS || next == level)
+        return;
+    level = next;
+    changes++;
+    // The first frames at a new level include its repaint; judge the level after them.
+    settleFrames = Config::PACER_SETTLE_FRAMES;
+    calmFrames = 0;
+}
+
+bool RenderPacer::tick()
+{
+    return ++sinceFrame >= getTicksPerFrame();
+}
+
+void RenderPacer::presented(long bytes, long blockedMicros, long pendingBytes)
+{
+    frames++;
+    int covered = sinceFrame > getTicksPerFrame() ? sinceFrame : getTicksPerFrame();
+    sinceFrame = 0;
+    long previous = lastPending;
+    lastPending = pendingBytes;
+    if (blockedMicros > 0)
+        throughput += (bytes * 1e6 / blockedMicros - throughput) * Config::PACER_AVERAGE_WEIGHT;
+
+    // The share of the covered ticks' time this frame spent blocked in output.
+    double share = static_cast<double>(blockedMicros) / (static_cast<double>(unitMicros) * covered);
+    load += (share - load) * Config::PACER_AVERAGE_WEIGHT;
+    if (!adaptive)
+        return;
+
+    if (settleFrames > 0)
+    {
+        settleFrames--;
+        return;
+    }
+    // A backlog that is still growing means the terminal falls further behind every frame.
+    bool backlog = pendingBytes > Config::PACER_QUEUE_BYTES && pendingBytes > previous;
+    if (load > Config::PACER_BUSY_SHARE || backlog)
+    {
+        setLevel(level + 1);
+        return;
+    }
+    calmFrames = load < Config::PACER_CALM_SHARE && pendingBytes == 0 ? calmFrames + 1 : 0;
+    if (calmFrames >= Config::PACER_CALM_FRAMES)
+        setLevel(level - 1);
+}
+
+long RenderPacer::outputQueued(int fd)
+{
+#ifdef TIOCOUTQ
+    int queued = 0;
+    if (ioctl(fd, TIOCOUTQ, &queued) == 0 && queued > 0)
+        return queued;
+#else
+    (void)fd;
+#endif
+    return 0;
+}
@@ -1,86 +1,100 @@
 #include "../include/player.h"
-#include <ncurses.h>
+#include "../include/glyphs.h"
 
 char TrailSegment::getChar() const
 {
-    if (from == to)
-    {
-        switch (from)
-        {
-        case UP:
-        case DOWN:
-            return '|';
-        case LEFT:
-        case RIGHT:
-            return '-';
-        default:
-            return '-';
-        }
-    }
-    else
-    {
-        return '+';
-    }
+    return Glyphs::asciiTrail(from, to, false).bytes[0];
 }
 
 const char *TrailSegment::getUnicodeChar() const
 {
-    if (isHead)
-    {
-        switch (to)
-        {
-        case UP:
-            return "⇡";
-        case DOWN:
-            return "⇣";
-        case LEFT:
-            return "⇠";
-        case RIGHT:
-            return "⇢";
-        default:
-            return "*";
-        }
-    }
+    return Glyphs::trail(from, to, isHead).bytes;
+}
 
-    if (from == to)
-    {
-        switch (from)
-        {
-        case UP:
-        case DOWN:
-            return "┆";
-        case LEFT:
-        case RIGHT:
-            return "┄";
-        default:
-            return "┄";
-        }
-    }
-    else
+bool Trail::push(const TrailSegment &segment)
+{
+    if (limit == 0 || ring.size() < limit)
     {
-        if ((from == LEFT && to == DOWN) || (from == UP && to == RIGHT))
-            return "┌";
-        if ((from == RIGHT && to == DOWN) || (from == UP && to == LEFT))
-            return "┐";
-        if ((from == LEFT && to == UP) || (from == DOWN && to == RIGHT))
-            return "└";
-        if ((from == RIGHT && to == UP) || (from == DOWN && to == LEFT))
-            return "┘";
+        ring.push_back(segment);
+        return false;
     }
 
-    return "┄";
+    TrailSegment &tail = ring[start];
+    retiredX = tail.x;
+    retiredY = tail.y;
+    tail = segment;
+    start = start + 1 == ring.size() ? 0 : start + 1;
+    retired++;
+    return true;
+}
+
+void Trail::clear()
+{
+    ring.clear();
+    start = 0;
+    retired = 0;
+    retiredX = -1;
+    retiredY = -1;
+}
+
+void Trail::setLimit(size_t cells)
+{
+    limit = cells;
+    clear();
+}
+
+void Trail::restore(const TrailSegment *cells, size_t count, long retiredCells, int lastRetiredX, int lastRetiredY)
+{
+    ring.assign(cells, cells + count);
+    start = 0;
+    retired = retiredCells;
+    retiredX = lastRetiredX;
+    retiredY = lastRetiredY;
 }
 
 Player::Player(int startX, int startY, int id, Direction startDirection)
     : x(startX), y(startY), startX(startX), startY(startY),
-      direction(startDirection), lastDirection(startDirection), playerId(id)
+      direction(startDirection), lastDirection(startDirection), tailRetired(false), playerId(id)
 {
 }
 
 void Player::initializeTrail()
 {
     trail.clear();
-    trail.push_back(TrailSegment(x, y, direction, direction, true));
+    trail.push(TrailSegment(x, y, direction, direction, true));
+    tailRetired = false;
+}
+
+void Player::setTrailLimit(size_t cells)
+{
+    trail.setLimit(cells);
+    initializeTrail();
+}
+
+void Player::capture(RiderState &state) const
+{
+    state.x = x;
+    state.y = y;
+    state.direction = direction;
+    state.lastDirection = lastDirection;
+    state.tailRetired = tailRetired;
+    state.limit = trail.getLimit();
+    state.retired = trail.getRetired();
+    state.retiredX = trail.getRetiredX();
+    state.retiredY = trail.getRetiredY();
+}
+
+void Player::restore(const RiderState &state, const TrailSegment *cells, size_t count)
+{
+    x = state.x;
+    y = state.y;
+    startX = state.x;
+    startY = state.y;
+    direction = state.direction;
+    lastDirection = state.lastDirection;
+    tailRetired = state.tailRetired;
+    trail.setLimit(state.limit);
+    trail.restore(cells, count, state.retired, state.retiredX, state.retiredY);
 }
 
 void Player::move()
@@ -107,7 +121,7 @@ void Player::move()
         break;
     }
 
-    trail.push_back(TrailSegment(x, y, direction, direction, true));
+    tailRetired = trail.push(TrailSegment(x, y, direction, direction, true));
 
     lastDirection = direction;
 }
@@ -164,32 +178,16 @@ const char *Player::getPlayerUnicodeChar() const
     return "*";
 }
 
-void Player::draw()
+void Player::draw(FrameBuffer &frame, int originX, int originY, bool ascii) const
 {
-    int maxY, maxX;
-    getmaxyx(stdscr, maxY, maxX);
+    int headColor = (playerId == Config::PLAYER_1_ID) ? Config::COLOR_PLAYER_HEAD : Config::COLOR_PLAYER2_HEAD;
+    int trailColor = (playerId == Config::PLAYER_1_ID) ? Config::COLOR_PLAYER_TRAIL : Config::COLOR_PLAYER2_TRAIL;
+    const Glyphs::TrailTable &table = ascii ? Glyphs::ASCII_TRAIL : Glyphs::UNICODE_TRAIL;
 
-    for (size_t i = 0; i < trail.size(); i++)
+    for (const auto &segment : trail)
     {
-        const auto &segment = trail[i];
-
-        int headColor = (playerId == Config::PLAYER_1_ID) ? Config::COLOR_PLAYER_HEAD : Config::COLOR_PLAYER2_HEAD;
-        int trailColor = (playerId == Config::PLAYER_1_ID) ? Config::COLOR_PLAYER_TRAIL : Config::COLOR_PLAYER2_TRAIL;
-
-        if (segment.isHead)
-        {
-            attron(COLOR_PAIR(headColor));
-        }
-        else
-        {
-            attron(COLOR_PAIR(trailColor));
-        }
-        if (segment.y >= 0 && segment.y < maxY &&
-            segment.x >= 0 && segment.x < maxX)
-        {
-            mvprintw(segment.y, segment.x, "%s", segment.getUnicodeChar());
-            attroff(COLOR_PAIR(segment.isHead ? headColor : trailColor));
-        }
+        const Glyph &glyph = table.cells[segment.from][segment.to][segment.isHead];
+        frame.put(originX + segment.x, originY + segment.y, glyph, segment.isHead ? headColor : trailColor);
     }
 }
 
@@ -234,6 +232,12 @@ void Player::reset(int newX, int newY)
         y = startY;
     }
 
-    trail.clear();
-    trail.push_back(TrailSegment(x, y, direction, direction, true));
+    initializeTrail();
+}
+
+void Player::respawn(int newX, int newY, Direction newDir)
+{
+    direction = newDir;
+    lastDirection = newDir;
+    reset(newX, newY);
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "../include/profiler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    const char *const STAGE_NAMES[Config::NUM_PROFILE_STAGES] = {"input", "simulation", "bot", "render"};
+    const char *const COUNTER_NAMES[Config::NUM_PROFILE_COUNTERS] = {"cycles", "instructions", "cache misses", "branch misses"};
+
+#ifdef __linux__
+    const uint64_t COUNTER_CONFIGS[Config::NUM_PROFILE_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                                    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    // User-space counts of the calling thread only, so an unprivileged process may open them.
+    int openCounter(uint64_t config, int group)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+    void printPerTick(FILE *out, bool available, uint64_t value, long ticks)
+    {
+        if (available)
+            fprintf(out, "  %12.1f", static_cast<double>(value) / ticks);
+        else
+            fprintf(out, "  %12s", "-");
+    }
+}
+
+TickProfiler::TickProfiler() : leader(-1), opened(0), current(-1), markCounters(), ticks(0), switches(0), timeEnabled(0), timeRunning(0)
+{
+    for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+    {
+        fds[c] = -1;
+        slots[c] = -1;
+    }
+}
+
+TickProfiler::~TickProfiler()
+{
+    if (active == this)
+        active = nullptr;
+    close();
+}
+
+void TickProfiler::close()
+{
+    for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+    {
+        if (fds[c] >= 0)
+            ::close(fds[c]);
+        fds[c] = -1;
+        slots[c] = -1;
+    }
+    leader = -1;
+    opened = 0;
+}
+
+bool TickProfiler::open()
+{
+    close();
+    unavailable.clear();
+#ifdef __linux__
+    // The first counter that opens leads the group; a machine without, say, cache events
+    // still reports the others.
+    for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+    {
+        int fd = openCounter(COUNTER_CONFIGS[c], leader);
+        if (fd < 0)
+        {
+            if (unavailable.empty())
+                unavailable = std::string("perf_event_open: ") + strerror(errno);
+            continue;
+        }
+        fds[c] = fd;
+        slots[c] = opened++;
+        if (leader < 0)
+            leader = fd;
+    }
+    if (leader >= 0)
+    {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    unavailable = "no perf_event support on this system";
+#endif
+    return opened > 0;
+}
+
+void TickProfiler::sample(Clock::time_point &now, uint64_t *counters)
+{
+    now = Clock::now();
+    if (leader < 0)
+        return;
+    // nr, time enabled, time running, then one value per open counter.
+    uint64_t values[3 + Config::NUM_PROFILE_COUNTERS];
+    ssize_t expected = static_cast<ssize_t>((3 + opened) * sizeof(uint64_t));
+    if (read(leader, values, sizeof(values)) != expected)
+        return;
+    timeEnabled = values[1];
+    timeRunning = values[2];
+    for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+    {
+        if (slots[c] >= 0)
+            counters[c] = values[3 + slots[c]];
+    }
+}
+
+int TickProfiler::switchTo(int stage)
+{
+    Clock::time_point now;
+    uint64_t counters[Config::NUM_PROFILE_COUNTERS];
+    std::copy(markCounters, markCounters + Config::NUM_PROFILE_COUNTERS, counters);
+    sample(now, counters);
+    if (current >= 0)
+    {
+        StageTotals &totals = stages[current];
+        totals.seconds += std::chrono::duration<double>(now - mark).count();
+        for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+            totals.counters[c] += counters[c] - markCounters[c];
+    }
+    int previous = current;
+    current = stage;
+    mark = now;
+    std::copy(counters, counters + Config::NUM_PROFILE_COUNTERS, markCounters);
+    switches++;
+    return previous;
+}
+
+void TickProfiler::report(FILE *out) const
+{
+    if (ticks == 0)
+    {
+        fprintf(out, "Profile: no ticks played\n");
+        return;
+    }
+    bool cycles = hasCounter(COUNTER_CYCLES), instructions = hasCounter(COUNTER_INSTRUCTIONS);
+    if (opened > 0)
+    {
+        fprintf(out, "Profile: %ld ticks on the main thread, counting", ticks);
+        for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+        {
+            if (hasCounter(static_cast<ProfileCounter>(c)))
+                fprintf(out, " %s", COUNTER_NAMES[c]);
+        }
+        fprintf(out, "\n");
+    }
+    else
+    {
+        fprintf(out, "Profile: %ld ticks on the main thread, timing only (%s)\n", ticks, unavailable.c_str());
+    }
+
+    StageTotals total;
+    for (const StageTotals &stage : stages)
+    {
+        total.seconds += stage.seconds;
+        for (int c = 0; c < Config::NUM_PROFILE_COUNTERS; c++)
+            total.counters[c] += stage.counters[c];
+    }
+
+    fprintf(out, "  %-10s  %10s  %6s  %12s  %6s  %12s  %12s\n", "stage", "us/tick", "share", "instr/tick", "IPC", "cache miss", "branch miss");
+    for (int s = 0; s <= Config::NUM_PROFILE_STAGES; s++)
+    {
+        const StageTotals &stage = s < Config::NUM_PROFILE_STAGES ? stages[s] : total;
+        fprintf(out, "  %-10s  %10.1f  %5.1f%%", s < Config::NUM_PROFILE_STAGES ? STAGE_NAMES[s] : "total", stage.seconds * 1e6 / ticks,
+                total.seconds > 0 ? 100.0 * stage.seconds / total.seconds : 0.0);
+        printPerTick(out, instructions, stage.counters[COUNTER_INSTRUCTIONS], ticks);
+        if (cycles && instructions && stage.counters[COUNTER_CYCLES] > 0)
+            fprintf(out, "  %6.2f", static_cast<double>(stage.counters[COUNTER_INSTRUCTIONS]) / stage.counters[COUNTER_CYCLES]);
+        else
+            fprintf(out, "  %6s", "-");
+        printPerTick(out, hasCounter(COUNTER_CACHE_MISSES), stage.counters[COUNTER_CACHE_MISSES], ticks);
+        printPerTick(out, hasCounter(COUNTER_BRANCH_MISSES), stage.counters[COUNTER_BRANCH_MISSES], ticks);
+        fprintf(out, "\n");
+    }
+
+    if (opened > 0 && timeRunning < timeEnabled)
+        fprintf(out, "  counters shared the PMU and ran %.0f%% of the time; counts are low by that much\n",
+                timeEnabled > 0 ? 100.0 * timeRunning / timeEnabled : 0.0);
+    if (opened > 0 && opened < Config::NUM_PROFILE_COUNTERS)
+        fprintf(out, "  some counters are unavailable (%s)\n", unavailable.c_str());
+    fprintf(out, "  %.1f stage switches per tick; search helper threads are not counted\n", static_cast<double>(switches) / ticks);
+}
@@ -0,0 +1,261 @@
+#include "../include/regions.h"
+#include <algorithm>
+
+RegionMap::RegionMap() : width(0), height(0), seenStamp(0), work(0) {}
+
+void RegionMap::reserve(int w, int h)
+{
+    size_t cells = static_cast<size_t>(w) * h;
+    width = w;
+    height = h;
+    if (labels.size() == cells)
+        return;
+
+    labels.assign(cells, 0);
+    sizes.assign(cells + 1, 0);
+    oddSizes.assign(cells + 1, 0);
+    odd.resize(cells);
+    for (size_t cell = 0; cell < cells; cell++)
+        odd[cell] = static_cast<uint8_t>((cell % w + cell / w) & 1);
+    freeLabels.reserve(cells + 1);
+    seen.assign(cells, 0);
+    seenStamp = 0;
+    owner.assign(cells, 0);
+    for (auto &queue : queues)
+        queue.resize(cells);
+}
+
+int RegionMap::newLabel()
+{
+    int label = freeLabels.back();
+    freeLabels.pop_back();
+    return label;
+}
+
+void RegionMap::rebuild(const Grid &grid)
+{
+    reserve(grid.getWidth(), grid.getHeight());
+
+    // Label 0 marks blocked cells; the rest are handed out from the top of the stack.
+    freeLabels.clear();
+    for (int label = static_cast<int>(sizes.size()) - 1; label > 0; label--)
+        freeLabels.push_back(label);
+    std::fill(labels.begin(), labels.end(), 0);
+
+    const std::vector<uint8_t> &cells = grid.getCells();
+    std::vector<int> &queue = queues[0];
+    for (int start = 0; start < static_cast<int>(cells.size()); start++)
+    {
+        if (cells[start] != Config::CELL_EMPTY || labels[start] != 0)
+            continue;
+
+        int label = newLabel();
+        int head = 0, tail = 0, oddCells = 0;
+        queue[tail++] = start;
+        labels[start] = label;
+        while (head < tail)
+        {
+            int cell = queue[head++];
+            oddCells += odd[cell];
+            const int neighbours[] = {cell - width, cell + width, cell - 1, cell + 1};
+            for (int next : neighbours)
+            {
+                if (cells[next] == Config::CELL_EMPTY && labels[next] == 0)
+                {
+                    labels[next] = label;
+                    queue[tail++] = next;
+                }
+            }
+        }
+        sizes[label] = tail;
+        oddSizes[label] = oddCells;
+        work += tail;
+    }
+}
+
+void RegionMap::fill(int x, int y)
+{
+    int cell = y * width + x;
+    int label = labels[cell];
+    if (label == 0)
+        return;
+
+    labels[cell] = 0;
+    oddSizes[label] -= odd[cell];
+    work++;
+    if (--sizes[label] == 0)
+    {
+        freeLabels.push_back(label);
+        return;
+    }
+    splitAround(cell, label);
+}
+
+void RegionMap::splitAround(int cell, int label)
+{
+    // The eight surrounding cells in ring order; even positions are the orthogonal ones.
+    const int ring[] = {-width, -width + 1, 1, width + 1, width, width - 1, -1, -width - 1};
+    bool open[8];
+    int blocked = -1;
+    for (int k = 0; k < 8; k++)
+    {
+        open[k] = labels[cell + ring[k]] == label;
+        if (!open[k])
+            blocked = k;
+    }
+    if (blocked < 0)
+        return;
+
+    // Free neighbours in one unbroken run of the ring stay connected around the cell.
+    int seeds[MAX_SEARCHES];
+    int seedCount = 0;
+    bool runHasSeed = false;
+    for (int step = 1; step <= 8; step++)
+    {
+        int k = (blocked + step) % 8;
+        if (!open[k])
+        {
+            runHasSeed = false;
+            continue;
+        }
+        if (k % 2 == 0 && !runHasSeed)
+        {
+            seeds[seedCount++] = cell + ring[k];
+            runHasSeed = true;
+        }
+    }
+    if (seedCount < 2)
+        return;
+
+    if (++seenStamp == 0)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        seenStamp = 1;
+    }
+
+    int parent[MAX_SEARCHES], head[MAX_SEARCHES], tail[MAX_SEARCHES];
+    for (int s = 0; s < seedCount; s++)
+    {
+        parent[s] = s;
+        head[s] = 0;
+        tail[s] = 1;
+        queues[s][0] = seeds[s];
+        seen[seeds[s]] = seenStamp;
+        owner[seeds[s]] = static_cast<uint8_t>(s);
+    }
+
+    auto root = [&parent](int s)
+    {
+        while (parent[s] != s)
+            s = parent[s];
+        return s;
+    };
+
+    // Expand every search one cell at a time until at most one group is still growing.
+    while (true)
+    {
+        bool growing[MAX_SEARCHES] = {};
+        int roots = 0, growingRoots = 0;
+        for (int s = 0; s < seedCount; s++)
+        {
+            if (head[s] < tail[s])
+                growing[root(s)] = true;
+        }
+        for (int s = 0; s < seedCount; s++)
+        {
+            if (root(s) == s)
+            {
+                roots++;
+                growingRoots += growing[s];
+            }
+        }
+        if (roots == 1)
+            return;
+        if (growingRoots <= 1)
+            break;
+
+        for (int s = 0; s < seedCount; s++)
+        {
+            if (head[s] >= tail[s])
+                continue;
+
+            int current = queues[s][head[s]++];
+            work++;
+            const int neighbours[] = {current - width, current + width, current - 1, current + 1};
+            for (int next : neighbours)
+            {
+                if (labels[next] != label)
+                    continue;
+                if (seen[next] != seenStamp)
+                {
+                    seen[next] = seenStamp;
+                    owner[next] = static_cast<uint8_t>(s);
+                    queues[s][tail[s]++] = next;
+                }
+                else
+                {
+                    int a = root(s), b = root(owner[next]);
+                    if (a != b)
+                        parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+    }
+
+    // The group still growing keeps the old label; finished groups are separate regions.
+    int keeper = -1;
+    int keeperSize = -1;
+    for (int s = 0; s < seedCount; s++)
+    {
+        if (root(s) != s)
+            continue;
+        bool stillGrowing = false;
+        int groupSize = 0;
+        for (int t = 0; t < seedCount; t++)
+        {
+            if (root(t) == s)
+            {
+                stillGrowing |= head[t] < tail[t];
+                groupSize += tail[t];
+            }
+        }
+        int rank = stillGrowing ? static_cast<int>(labels.size()) + 1 : groupSize;
+        if (rank > keeperSize)
+        {
+            keeper = s;
+            keeperSize = rank;
+        }
+    }
+
+    for (int s = 0; s < seedCount; s++)
+    {
+        if (root(s) != s || s == keeper)
+            continue;
+
+        int split = newLabel();
+        int splitSize = 0, splitOdd = 0;
+        for (int t = 0; t < seedCount; t++)
+        {
+            if (root(t) != s)
+                continue;
+            for (int i = 0; i < tail[t]; i++)
+            {
+                labels[queues[t][i]] = split;
+                splitOdd += odd[queues[t][i]];
+            }
+            splitSize += tail[t];
+        }
+        sizes[split] = splitSize;
+        sizes[label] -= splitSize;
+        oddSizes[split] = splitOdd;
+        oddSizes[label] -= splitOdd;
+        work += splitSize;
+    }
+}
+
+long RegionMap::takeWork()
+{
+    long taken = work;
+    work = 0;
+    return taken;
+}
@@ -0,0 +1,400 @@
+#include "../include/renderer.h"
+#include "../include/config.h"
+#include <ncurses.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace
+{
+    // Typical lengths of a cursor move and a colour change in a terminal's escapes.
+    const int MOVE_BYTES = 8;
+    const int COLOR_BYTES = 10;
+
+    // The eight terminal colours and their bright variants; entry 0 is also the background.
+    const uint8_t GIF_PALETTE[16][3] = {{0, 0, 0}, {205, 49, 49}, {13, 188, 121}, {229, 229, 16}, {36, 114, 200}, {188, 63, 188}, {17, 168, 205}, {229, 229, 229}, {102, 102, 102}, {241, 76, 76}, {35, 209, 139}, {245, 245, 67}, {59, 142, 234}, {214, 112, 214}, {41, 184, 219}, {255, 255, 255}};
+    const int GIF_COLOR_BITS = 4;
+    const int GIF_COLORS = 1 << GIF_COLOR_BITS;
+    const int GIF_MAX_CODES = 4096;
+    const int GIF_MAX_CODE_BITS = 12;
+    const int GIF_BLOCK = 255;
+    const short GIF_DEFAULT_FOREGROUND = 7;
+    // Bright black is left out of the colours and marks pixels a frame leaves as they were.
+    const uint8_t GIF_UNCHANGED = 8;
+    const uint8_t GIF_UNSHOWN = 0xff;
+
+    void put16(std::string &out, int value)
+    {
+        out += static_cast<char>(value & 0xff);
+        out += static_cast<char>((value >> 8) & 0xff);
+    }
+
+    char colorCode(int color)
+    {
+        if (color <= 0)
+            return '.';
+        return color < 10 ? static_cast<char>('0' + color) : static_cast<char>('a' + color - 10);
+    }
+}
+
+CursesRenderer::CursesRenderer() : currentColor(-1), bytes(0) {}
+
+void CursesRenderer::begin(int, int, bool repaint)
+{
+    if (repaint)
+        clearok(stdscr, TRUE);
+    currentColor = -1;
+}
+
+void CursesRenderer::run(int x, int y, const Cell *cells, int count)
+{
+    char text[4 * MAX_RUN];
+    int length = 0;
+    for (int i = 0; i < count && i < MAX_RUN; i++)
+    {
+        memcpy(text + length, cells[i].glyph, cells[i].length);
+        length += cells[i].length;
+    }
+
+    if (cells[0].color != currentColor)
+    {
+        attrset(COLOR_PAIR(cells[0].color));
+        currentColor = cells[0].color;
+        bytes += COLOR_BYTES;
+    }
+    mvaddnstr(y, x, text, length);
+    bytes += MOVE_BYTES + length;
+}
+
+void CursesRenderer::end()
+{
+    attrset(A_NORMAL);
+    refresh();
+}
+
+AnsiRenderer::AnsiRenderer(int fd) : fd(fd), cursorX(-1), cursorY(-1), currentColor(-1), bytes(0) {}
+
+void AnsiRenderer::setPair(int pair, short foreground, short background)
+{
+    if (pair < 0)
+        return;
+    if (pair >= static_cast<int>(pairs.size()))
+        pairs.resize(pair + 1);
+    pairs[pair].foreground = foreground;
+    pairs[pair].background = background;
+}
+
+void AnsiRenderer::moveTo(int x, int y)
+{
+    if (x == cursorX && y == cursorY)
+        return;
+    char sequence[24];
+    int length = snprintf(sequence, sizeof(sequence), "\033[%d;%dH", y + 1, x + 1);
+    out.append(sequence, length);
+    cursorX = x;
+    cursorY = y;
+}
+
+void AnsiRenderer::setColor(int color)
+{
+    if (color == currentColor)
+        return;
+    currentColor = color;
+
+    Pair pair;
+    if (color > 0 && color < static_cast<int>(pairs.size()))
+        pair = pairs[color];
+
+    char sequence[24];
+    int length = snprintf(sequence, sizeof(sequence), "\033[0;%d;%dm", pair.foreground < 0 ? 39 : 30 + pair.foreground,
+                          pair.background < 0 ? 49 : 40 + pair.background);
+    out.append(sequence, length);
+}
+
+void AnsiRenderer::begin(int, int, bool repaint)
+{
+    out.clear();
+    cursorX = -1;
+    cursorY = -1;
+    currentColor = -1;
+    if (repaint)
+        out += "\033[0m\033[2J";
+}
+
+void AnsiRenderer::run(int x, int y, const Cell *cells, int count)
+{
+    moveTo(x, y);
+    setColor(cells[0].color);
+    for (int i = 0; i < count; i++)
+        out.append(cells[i].glyph, cells[i].length);
+    cursorX += count;
+}
+
+void AnsiRenderer::end()
+{
+    if (currentColor > 0)
+        out += "\033[0m";
+    bytes += static_cast<long>(out.size());
+
+    size_t done = 0;
+    while (fd >= 0 && done < out.size())
+    {
+        ssize_t wrote = write(fd, out.data() + done, out.size() - done);
+        if (wrote <= 0)
+            break;
+        done += static_cast<size_t>(wrote);
+    }
+}
+
+GifRenderer::GifRenderer(FILE *file)
+    : file(file), width(0), height(0), left(0), top(0), right(-1), bottom(-1), delay(0), bytes(0), codes(static_cast<size_t>(GIF_MAX_CODES) * GIF_COLORS)
+{
+}
+
+void GifRenderer::setPair(int pair, short foreground)
+{
+    if (pair < 0)
+        return;
+    if (pair >= static_cast<int>(pairs.size()))
+        pairs.resize(pair + 1, -1);
+    pairs[pair] = foreground;
+}
+
+void GifRenderer::writeHeader()
+{
+    out = "GIF89a";
+    put16(out, width * Config::GIF_CELL_WIDTH);
+    put16(out, height * Config::GIF_CELL_HEIGHT);
+    out += static_cast<char>(0xf0 | (GIF_COLOR_BITS - 1));
+    out += '\0';
+    out += '\0';
+    for (const auto &color : GIF_PALETTE)
+        out.append(reinterpret_cast<const char *>(color), 3);
+    // Loop forever.
+    out.append("\x21\xff\x0bNETSCAPE2.0\x03\x01\x00\x00\x00", 19);
+}
+
+void GifRenderer::begin(int w, int h, bool repaint)
+{
+    out.clear();
+    // The first frame fixes the image size.
+    if (width == 0)
+    {
+        width = w;
+        height = h;
+        screen.assign(static_cast<size_t>(width) * height, 0);
+        shown.assign(screen.size(), GIF_UNSHOWN);
+        writeHeader();
+        repaint = true;
+    }
+    if (repaint)
+    {
+        std::fill(screen.begin(), screen.end(), 0);
+        std::fill(shown.begin(), shown.end(), GIF_UNSHOWN);
+    }
+
+    left = repaint ? 0 : width;
+    top = repaint ? 0 : height;
+    right = repaint ? width - 1 : -1;
+    bottom = repaint ? height - 1 : -1;
+}
+
+void GifRenderer::run(int x, int y, const Cell *cells, int count)
+{
+    if (y < 0 || y >= height || x < 0)
+        return;
+    int end = x + count < width ? x + count : width;
+    for (int i = x; i < end; i++)
+    {
+        const Cell &cell = cells[i - x];
+        short color = cell.color > 0 && cell.color < static_cast<int>(pairs.size()) ? pairs[cell.color] : -1;
+        if (color < 0)
+            color = GIF_DEFAULT_FOREGROUND;
+        uint8_t index = cell.color <= 0 ? 0 : static_cast<uint8_t>(color % GIF_COLORS);
+        if (index == GIF_UNCHANGED)
+            index = GIF_DEFAULT_FOREGROUND;
+
+        // A new glyph in the same colour looks the same here and leaves the rectangle alone.
+        size_t at = static_cast<size_t>(y) * width + i;
+        screen[at] = index;
+        if (index == shown[at])
+            continue;
+        left = std::min(left, i);
+        right = std::max(right, i);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y);
+    }
+}
+
+void GifRenderer::encode(int x, int y, int w, int h)
+{
+    const int cellWidth = Config::GIF_CELL_WIDTH;
+    const int cellHeight = Config::GIF_CELL_HEIGHT;
+    out += '\x2c';
+    put16(out, x * cellWidth);
+    put16(out, y * cellHeight);
+    put16(out, w * cellWidth);
+    put16(out, h * cellHeight);
+    out += '\0';
+    out += static_cast<char>(GIF_COLOR_BITS);
+
+    // One index per cell of the rectangle; cells that look as they did stay transparent.
+    pixels.resize(static_cast<size_t>(w) * h);
+    for (int cy = 0; cy < h; cy++)
+    {
+        for (int cx = 0; cx < w; cx++)
+        {
+            size_t cell = static_cast<size_t>(y + cy) * width + x + cx;
+            pixels[static_cast<size_t>(cy) * w + cx] = screen[cell] == shown[cell] ? GIF_UNCHANGED : screen[cell];
+            shown[cell] = screen[cell];
+        }
+    }
+
+    // LZW with the dictionary as a tree of (prefix code, pixel) children; 0 marks no child.
+    const int clear = GIF_COLORS;
+    std::string data;
+    uint32_t bits = 0;
+    int bitCount = 0;
+    int size = GIF_COLOR_BITS + 1;
+    int next = clear + 2;
+    auto emit = [&](int code)
+    {
+        bits |= static_cast<uint32_t>(code) << bitCount;
+        bitCount += size;
+        while (bitCount >= 8)
+        {
+            data += static_cast<char>(bits & 0xff);
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    };
+
+    std::fill(codes.begin(), codes.end(), 0);
+    emit(clear);
+    int prefix = -1;
+    for (int py = 0; py < h * cellHeight; py++)
+    {
+        const uint8_t *row = &pixels[static_cast<size_t>(py / cellHeight) * w];
+        for (int px = 0; px < w * cellWidth; px++)
+        {
+            int pixel = row[px / cellWidth];
+            if (prefix < 0)
+            {
+                prefix = pixel;
+                continue;
+            }
+            uint16_t &child = codes[static_cast<size_t>(prefix) * GIF_COLORS + pixel];
+            if (child != 0)
+            {
+                prefix = child;
+                continue;
+            }
+
+            emit(prefix);
+            prefix = pixel;
+            child = static_cast<uint16_t>(next);
+            if (next >= (1 << size) && size < GIF_MAX_CODE_BITS)
+                size++;
+            if (++next == GIF_MAX_CODES)
+            {
+                emit(clear);
+                std::fill(codes.begin(), codes.end(), 0);
+                size = GIF_COLOR_BITS + 1;
+                next = clear + 2;
+            }
+        }
+    }
+    emit(prefix);
+    // The decoder adds an entry for the last code too, and may widen before the end code.
+    if (next >= (1 << size) && size < GIF_MAX_CODE_BITS)
+        size++;
+    emit(clear + 1);
+    if (bitCount > 0)
+        data += static_cast<char>(bits & 0xff);
+
+    for (size_t done = 0; done < data.size(); done += GIF_BLOCK)
+    {
+        size_t length = std::min(data.size() - done, static_cast<size_t>(GIF_BLOCK));
+        out += static_cast<char>(length);
+        out.append(data, done, length);
+    }
+    out += '\0';
+}
+
+void GifRenderer::end()
+{
+    // A frame with nothing new still holds the delay, as one unchanged pixel.
+    if (right < left)
+    {
+        left = right = 0;
+        top = bottom = 0;
+    }
+
+    out.append("\x21\xf9\x04\x05", 4);
+    put16(out, delay);
+    out += static_cast<char>(GIF_UNCHANGED);
+    out += '\0';
+    encode(left, top, right - left + 1, bottom - top + 1);
+
+    if (file && fwrite(out.data(), 1, out.size(), file) == out.size())
+        bytes += static_cast<long>(out.size());
+}
+
+bool GifRenderer::finish()
+{
+    if (!file || width == 0)
+        return false;
+    bytes++;
+    return fputc('\x3b', file) != EOF;
+}
+
+TextRenderer::TextRenderer() : width(0), height(0) {}
+
+void TextRenderer::begin(int w, int h, bool repaint)
+{
+    if (w != width || h != height)
+    {
+        width = w;
+        height = h;
+        repaint = true;
+    }
+    // A repaint starts from a cleared screen, like the terminal backends.
+    if (repaint)
+        cells.assign(static_cast<size_t>(width) * height, BLANK_CELL);
+}
+
+void TextRenderer::run(int x, int y, const Cell *run, int count)
+{
+    if (y < 0 || y >= height || x < 0)
+        return;
+    int end = x + count < width ? x + count : width;
+    for (int i = x; i < end; i++)
+        cells[y * width + i] = run[i - x];
+}
+
+std::string TextRenderer::snapshot() const
+{
+    std::string text;
+    for (int y = 0; y < height; y++)
+    {
+        int last = width;
+        while (last > 0 && at(last - 1, y) == BLANK_CELL)
+            last--;
+        for (int x = 0; x < last; x++)
+            text.append(at(x, y).glyph, at(x, y).length);
+        text += '\n';
+    }
+
+    text += '\n';
+    for (int y = 0; y < height; y++)
+    {
+        int last = width;
+        while (last > 0 && at(last - 1, y).color == 0)
+            last--;
+        for (int x = 0; x < last; x++)
+            text += colorCode(at(x, y).color);
+        text += '\n';
+    }
+    return text;
+}
@@ -0,0 +1,329 @@
+#include "../include/replay.h"
+#include "../include/checksum.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+    const char REPLAY_MAGIC[8] = {'T', 'R', 'O', 'N', 'R', 'P', 'L', 'Y'};
+    const uint32_t REPLAY_VERSION = 1;
+
+    struct ReplayHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    // Followed by the wall bits (when walls is set) and then one move byte per tick.
+    struct RoundRecord
+    {
+        uint32_t ticks;
+        uint32_t tickMicros;
+        uint16_t width;
+        uint16_t height;
+        uint16_t trailLength;
+        uint8_t mode;
+        uint8_t players;
+        uint8_t winner;
+        uint8_t walls;
+        uint16_t spawnX[Config::REPLAY_MAX_PLAYERS];
+        uint16_t spawnY[Config::REPLAY_MAX_PLAYERS];
+        uint8_t spawnDir[Config::REPLAY_MAX_PLAYERS];
+        uint8_t reserved[2];
+        uint32_t check;
+    };
+
+    static_assert(sizeof(RoundRecord) == 44, "replay rounds have a fixed on-disk header");
+
+    size_t wallBytes(int width, int height)
+    {
+        return (static_cast<size_t>(width) * height + 7) / 8;
+    }
+
+    // FNV-1a over the header, walls and moves, so a torn append never parses.
+    uint32_t checksum(const RoundRecord &record, const std::vector<uint8_t> &walls, const std::vector<uint8_t> &moves)
+    {
+        uint32_t hash = hashBytes(&record, offsetof(RoundRecord, check));
+        hash = hashBytes(walls.data(), walls.size(), hash);
+        return hashBytes(moves.data(), moves.size(), hash);
+    }
+
+    bool readHeader(FILE *file)
+    {
+        ReplayHeader header;
+        return fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0 &&
+               header.version == REPLAY_VERSION;
+    }
+}
+
+ReplayWriter::ReplayWriter() : file(nullptr), recording(false) {}
+
+ReplayWriter::~ReplayWriter()
+{
+    close();
+}
+
+bool ReplayWriter::open(const std::string &path, std::string &error)
+{
+    close();
+    file = fopen(path.c_str(), "ab+");
+    if (!file)
+    {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+    {
+        ReplayHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+        header.version = REPLAY_VERSION;
+        if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0)
+        {
+            error = "cannot write " + path;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    rewind(file);
+    if (!readHeader(file))
+    {
+        error = path + " is not a replay file";
+        close();
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    return true;
+}
+
+void ReplayWriter::close()
+{
+    if (file)
+        fclose(file);
+    file = nullptr;
+    recording = false;
+}
+
+void ReplayWriter::begin(GameMode mode, int width, int height, int tickMicros, int trailLength, const ArenaMap &map, int players,
+                         const Player *const *riders)
+{
+    if (!file || players > Config::REPLAY_MAX_PLAYERS)
+        return;
+
+    round.mode = mode;
+    round.width = width;
+    round.height = height;
+    round.tickMicros = tickMicros;
+    round.trailLength = trailLength;
+    round.players = players;
+    round.winner = Config::WINNER_TIE;
+    round.map = map;
+    for (int i = 0; i < players; i++)
+        round.spawns[i] = {riders[i]->getX(), riders[i]->getY(), riders[i]->getDirection()};
+    round.moves.clear();
+    round.moves.reserve(static_cast<size_t>(width) * height);
+    recording = true;
+}
+
+void ReplayWriter::tick(const Player *const *riders)
+{
+    if (!recording)
+        return;
+    uint8_t move = 0;
+    for (int i = 0; i < round.players; i++)
+        move |= static_cast<uint8_t>(riders[i]->getDirection() << (2 * i));
+    round.moves.push_back(move);
+}
+
+bool ReplayWriter::end(int winner)
+{
+    if (!recording)
+        return false;
+    recording = false;
+
+    RoundRecord record;
+    memset(&record, 0, sizeof(record));
+    record.ticks = static_cast<uint32_t>(round.moves.size());
+    record.tickMicros = static_cast<uint32_t>(round.tickMicros);
+    record.width = static_cast<uint16_t>(round.width);
+    record.height = static_cast<uint16_t>(round.height);
+    record.trailLength = static_cast<uint16_t>(round.trailLength);
+    record.mode = static_cast<uint8_t>(round.mode);
+    record.players = static_cast<uint8_t>(round.players);
+    record.winner = static_cast<uint8_t>(winner);
+    record.walls = !round.map.empty();
+    for (int i = 0; i < round.players; i++)
+    {
+        record.spawnX[i] = static_cast<uint16_t>(round.spawns[i].x);
+        record.spawnY[i] = static_cast<uint16_t>(round.spawns[i].y);
+        record.spawnDir[i] = static_cast<uint8_t>(round.spawns[i].dir);
+    }
+
+    std::vector<uint8_t> walls;
+    if (record.walls)
+    {
+        walls.assign(wallBytes(round.width, round.height), 0);
+        for (int y = 0; y < round.height; y++)
+        {
+            for (int x = 0; x < round.width; x++)
+            {
+                size_t bit = static_cast<size_t>(y) * round.width + x;
+                if (round.map.isWall(x, y))
+                    walls[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+            }
+        }
+    }
+    record.check = checksum(record, walls, round.moves);
+
+    bool written = fwrite(&record, sizeof(record), 1, file) == 1 &&
+                   fwrite(walls.data(), 1, walls.size(), file) == walls.size() &&
+                   fwrite(round.moves.data(), 1, round.moves.size(), file) == round.moves.size();
+    return fflush(file) == 0 && written;
+}
+
+ReplayReader::ReplayReader() : file(nullptr), size(0), rounds(0) {}
+
+ReplayReader::~ReplayReader()
+{
+    close();
+}
+
+bool ReplayReader::open(const std::string &path, std::string &error)
+{
+    close();
+    file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    if (!readHeader(file))
+    {
+        error = path + " is not a replay file";
+        close();
+        return false;
+    }
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, start, SEEK_SET);
+    rounds = 0;
+    damage.clear();
+    return true;
+}
+
+void ReplayReader::close()
+{
+    if (file)
+        fclose(file);
+    file = nullptr;
+}
+
+bool ReplayReader::refuse(const char *reason)
+{
+    damage = "round " + std::to_string(rounds + 1) + " " + reason;
+    close();
+    return false;
+}
+
+bool ReplayReader::next(ReplayRound &round)
+{
+    RoundRecord record;
+    if (!file)
+        return false;
+    size_t got = fread(&record, 1, sizeof(record), file);
+    if (got == 0 && feof(file))
+        return false;
+    if (got != sizeof(record))
+        return refuse("is torn");
+    if (record.players < 1 || record.players > Config::REPLAY_MAX_PLAYERS || record.mode > BOT_BATTLE ||
+        record.width < 3 || record.height < 3 || record.tickMicros == 0)
+        return refuse("has a bad header");
+    // Riders respawn at these cells when the round is re-simulated; like map spawns they
+    // must lie inside the wall ring.
+    for (int i = 0; i < record.players; i++)
+    {
+        if (record.spawnX[i] < 1 || record.spawnY[i] < 1 || record.spawnX[i] > record.width - 2 || record.spawnY[i] > record.height - 2)
+            return refuse("has a spawn outside the arena");
+    }
+
+    // Sized against what is left of the file before anything is allocated.
+    size_t wallSize = record.walls ? wallBytes(record.width, record.height) : 0;
+    long left = size - ftell(file);
+    if (left < 0 || wallSize + record.ticks > static_cast<size_t>(left))
+        return refuse("is torn");
+    std::vector<uint8_t> walls(wallSize);
+    round.moves.resize(record.ticks);
+    if (fread(walls.data(), 1, walls.size(), file) != walls.size() ||
+        fread(round.moves.data(), 1, round.moves.size(), file) != round.moves.size())
+        return refuse("is torn");
+    if (checksum(record, walls, round.moves) != record.check)
+        return refuse("fails its checksum");
+
+    round.mode = static_cast<GameMode>(record.mode);
+    round.width = record.width;
+    round.height = record.height;
+    round.tickMicros = static_cast<int>(record.tickMicros);
+    round.trailLength = record.trailLength;
+    round.players = record.players;
+    round.winner = record.winner;
+    for (int i = 0; i < round.players; i++)
+        round.spawns[i] = {record.spawnX[i], record.spawnY[i], static_cast<Direction>(record.spawnDir[i] & 3)};
+
+    round.map = ArenaMap();
+    if (record.walls)
+    {
+        round.map.reset(round.width, round.height);
+        for (int y = 1; y < round.height - 1; y++)
+        {
+            for (int x = 1; x < round.width - 1; x++)
+            {
+                size_t bit = static_cast<size_t>(y) * round.width + x;
+                if ((walls[bit >> 3] >> (bit & 7)) & 1)
+                    round.map.setWall(x, y);
+            }
+        }
+    }
+    rounds++;
+    return true;
+}
+
+bool ReplayReader::readRound(const std::string &path, long index, ReplayRound &round, std::string &error)
+{
+    ReplayReader reader;
+    if (!reader.open(path, error))
+        return false;
+    while (reader.next(round))
+    {
+        if (reader.getRounds() == index + 1)
+            return true;
+    }
+    if (reader.isDamaged())
+        error = path + ": " + reader.getDamage();
+    else
+        error = path + " has " + std::to_string(reader.getRounds()) + " rounds";
+    return false;
+}
+
+void ReplayController::think(const Grid &)
+{
+    if (tick >= round->getTicks())
+        return;
+    Direction next = round->move(tick++, index);
+    // Two keys inside one tick can turn a rider around; replay that as the same two turns.
+    if ((next ^ 1) == rider->getDirection())
+        rider->setDirection(next == LEFT || next == RIGHT ? UP : LEFT);
+    rider->setDirection(next);
+}
+
+void ReplayController::respawn(int x, int y, Direction dir)
+{
+    rider->respawn(x, y, dir);
+    tick = 0;
+}
@@ -0,0 +1,18 @@
+#include "../include/rng.h"
+
+Rng::Rng(uint64_t seed) : state(seed) {}
+
+uint64_t Rng::next()
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int Rng::range(int low, int high)
+{
+    if (high <= low)
+        return low;
+    return low + static_cast<int>(next() % static_cast<uint64_t>(high - low + 1));
+}
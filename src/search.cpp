@@ -0,0 +1,410 @@
+#include "../include/search.h"
+#include <algorithm>
+
+namespace
+{
+    const Direction kDirections[] = {UP, DOWN, LEFT, RIGHT};
+    const uint8_t OWNER_NONE = 0;
+    const uint8_t OWNER_SELF = 1;
+    const uint8_t OWNER_OPPONENT = 2;
+    const uint8_t OWNER_CONTESTED = 3;
+    const int SCORE_BITS = 32;
+    const int DEPTH_BITS = 8;
+    const int BOUND_BITS = 2;
+
+    // Position keys are built from these per-cell values, so a move updates the key with one XOR.
+    uint64_t mix(uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    uint64_t cellKey(int cell)
+    {
+        return mix(static_cast<uint64_t>(cell) * 4 + 1);
+    }
+
+    uint64_t headKey(int selfPos, int oppPos)
+    {
+        return mix(static_cast<uint64_t>(selfPos) * 4 + 2) ^ mix(static_cast<uint64_t>(oppPos) * 4 + 3);
+    }
+}
+
+TranspositionTable::TranspositionTable() : mask(0) {}
+
+void TranspositionTable::resize(size_t entries)
+{
+    size_t count = 1;
+    while (count < entries)
+        count <<= 1;
+    slots.reset(new Slot[count]);
+    mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    if (!slots)
+        return;
+    for (size_t i = 0; i <= mask; i++)
+    {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TableEntry &entry) const
+{
+    const Slot &slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || data == 0)
+        return false;
+
+    entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.depth = static_cast<int>((data >> SCORE_BITS) & ((1 << DEPTH_BITS) - 1));
+    entry.bound = static_cast<SearchBound>((data >> (SCORE_BITS + DEPTH_BITS)) & ((1 << BOUND_BITS) - 1));
+    entry.move = static_cast<int>(data >> (SCORE_BITS + DEPTH_BITS + BOUND_BITS)) - 1;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, SearchBound bound, int move)
+{
+    uint64_t data = static_cast<uint32_t>(score) | static_cast<uint64_t>(depth) << SCORE_BITS |
+                    static_cast<uint64_t>(bound) << (SCORE_BITS + DEPTH_BITS) |
+                    static_cast<uint64_t>(move + 1) << (SCORE_BITS + DEPTH_BITS + BOUND_BITS);
+    Slot &slot = slots[key & mask];
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+Search::Search()
+    : width(0), height(0), nodes(0), key(0), rootSelf(0), rootOpp(0), variation(0), table(nullptr), stop(nullptr), maxNodes(0),
+      limited(false), aborted(false), tableHits(0)
+{
+}
+
+int Search::offset(Direction dir) const
+{
+    switch (dir)
+    {
+    case UP:
+        return -width;
+    case DOWN:
+        return width;
+    case LEFT:
+        return -1;
+    case RIGHT:
+        return 1;
+    }
+    return 0;
+}
+
+Direction Search::bestMove(const Grid &grid, int selfX, int selfY, Direction selfDir, int oppX, int oppY, int depth)
+{
+    width = grid.getWidth();
+    height = grid.getHeight();
+    board = grid.getCells();
+    dist.resize(board.size());
+    owner.resize(board.size());
+    queue.resize(board.size());
+    nodes = 0;
+
+    int selfPos = selfY * width + selfX;
+    int oppPos = oppY * width + oppX;
+    board[selfPos] = Config::CELL_SELF;
+    board[oppPos] = Config::CELL_OPPONENT;
+
+    Direction bestDir = selfDir;
+    int bestScore = -Config::SEARCH_WIN_SCORE * 2;
+
+    // Try the current heading first so it wins ties.
+    Direction order[] = {selfDir, UP, DOWN, LEFT, RIGHT};
+    for (int i = 0; i < 5; i++)
+    {
+        Direction dir = order[i];
+        if (i > 0 && dir == selfDir)
+            continue;
+
+        int next = selfPos + offset(dir);
+        if (board[next] != Config::CELL_EMPTY)
+            continue;
+
+        board[next] = Config::CELL_SELF;
+        int score = replyValue(next, oppPos, depth, bestScore, Config::SEARCH_WIN_SCORE * 2);
+        board[next] = Config::CELL_EMPTY;
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestDir = dir;
+        }
+    }
+
+    return bestDir;
+}
+
+void Search::occupy(int cell, uint8_t value)
+{
+    board[cell] = value;
+    key ^= cellKey(cell);
+}
+
+void Search::vacate(int cell)
+{
+    board[cell] = Config::CELL_EMPTY;
+    key ^= cellKey(cell);
+}
+
+// The preferred move first, then the four directions rotated by the thread's variation.
+void Search::order(int first, Direction *dirs) const
+{
+    int count = 0;
+    if (first >= 0)
+        dirs[count++] = static_cast<Direction>(first);
+    for (int i = 0; i < 4; i++)
+    {
+        Direction dir = kDirections[(i + variation) % 4];
+        if (dir != first)
+            dirs[count++] = dir;
+    }
+}
+
+bool Search::outOfBudget()
+{
+    return (stop && stop->load(std::memory_order_relaxed)) || (maxNodes > 0 && nodes >= maxNodes) ||
+           std::chrono::steady_clock::now() >= deadline;
+}
+
+void Search::setRoot(const Grid &grid, int selfX, int selfY, int oppX, int oppY)
+{
+    width = grid.getWidth();
+    height = grid.getHeight();
+    board = grid.getCells();
+    dist.resize(board.size());
+    owner.resize(board.size());
+    queue.resize(board.size());
+
+    rootSelf = selfY * width + selfX;
+    rootOpp = oppY * width + oppX;
+    board[rootSelf] = Config::CELL_SELF;
+    board[rootOpp] = Config::CELL_OPPONENT;
+    key = 0;
+    for (size_t cell = 0; cell < board.size(); cell++)
+    {
+        if (board[cell] != Config::CELL_EMPTY)
+            key ^= cellKey(static_cast<int>(cell));
+    }
+}
+
+void Search::setLimits(TranspositionTable *shared, const std::atomic<bool> *stopFlag, long nodeLimit,
+                       std::chrono::steady_clock::time_point until, int rotation)
+{
+    table = shared;
+    stop = stopFlag;
+    maxNodes = nodeLimit;
+    deadline = until;
+    variation = rotation;
+    limited = true;
+    aborted = false;
+    nodes = 0;
+    tableHits = 0;
+}
+
+bool Search::searchRoot(int depth, Direction preferred, Direction &move, int &score)
+{
+    uint64_t rootKey = key ^ headKey(rootSelf, rootOpp);
+    int first = preferred;
+    TableEntry entry;
+    if (table && table->probe(rootKey, entry) && entry.move >= 0)
+        first = entry.move;
+
+    Direction dirs[4];
+    order(first, dirs);
+    int bestScore = -Config::SEARCH_WIN_SCORE * 2;
+    Direction bestDir = preferred;
+    for (Direction dir : dirs)
+    {
+        int next = rootSelf + offset(dir);
+        if (board[next] != Config::CELL_EMPTY)
+            continue;
+
+        occupy(next, Config::CELL_SELF);
+        int value = replyValue(next, rootOpp, depth, bestScore, Config::SEARCH_WIN_SCORE * 2);
+        vacate(next);
+        if (aborted)
+            return false;
+
+        if (value > bestScore)
+        {
+            bestScore = value;
+            bestDir = dir;
+        }
+    }
+
+    if (table)
+        table->store(rootKey, depth, bestScore, BOUND_EXACT, bestDir);
+    move = bestDir;
+    score = bestScore;
+    return true;
+}
+
+int Search::territory(const Grid &grid, int selfX, int selfY, int oppX, int oppY)
+{
+    width = grid.getWidth();
+    height = grid.getHeight();
+    board = grid.getCells();
+    dist.resize(board.size());
+    owner.resize(board.size());
+    queue.resize(board.size());
+
+    int selfPos = selfY * width + selfX;
+    int oppPos = oppY * width + oppX;
+    board[selfPos] = Config::CELL_SELF;
+    board[oppPos] = Config::CELL_OPPONENT;
+    return evaluate(selfPos, oppPos);
+}
+
+int Search::alphaBeta(int selfPos, int oppPos, int depth, int alpha, int beta)
+{
+    nodes++;
+    if (limited && (aborted || (nodes % Config::SEARCH_CHECK_INTERVAL == 0 && outOfBudget())))
+    {
+        aborted = true;
+        return 0;
+    }
+
+    if (depth == 0)
+        return evaluate(selfPos, oppPos);
+
+    uint64_t nodeKey = key ^ headKey(selfPos, oppPos);
+    int first = -1;
+    TableEntry entry;
+    if (table && table->probe(nodeKey, entry))
+    {
+        tableHits++;
+        first = entry.move;
+        if (entry.depth >= depth && (entry.bound == BOUND_EXACT || (entry.bound == BOUND_LOWER && entry.score >= beta) ||
+                                     (entry.bound == BOUND_UPPER && entry.score <= alpha)))
+            return entry.score;
+    }
+
+    bool selfMoved = false;
+    int best = -Config::SEARCH_WIN_SCORE * 2;
+    int bestDir = -1;
+
+    Direction dirs[4];
+    order(first, dirs);
+    for (Direction dir : dirs)
+    {
+        int next = selfPos + offset(dir);
+        if (board[next] != Config::CELL_EMPTY)
+            continue;
+
+        selfMoved = true;
+        occupy(next, Config::CELL_SELF);
+        int score = replyValue(next, oppPos, depth, std::max(alpha, best), beta);
+        vacate(next);
+
+        if (score > best)
+        {
+            best = score;
+            bestDir = dir;
+        }
+        if (best >= beta)
+            break;
+    }
+
+    if (!selfMoved)
+    {
+        for (Direction dir : kDirections)
+        {
+            if (board[oppPos + offset(dir)] == Config::CELL_EMPTY)
+                return -Config::SEARCH_WIN_SCORE - depth;
+        }
+        return 0;
+    }
+
+    if (table && !aborted)
+        table->store(nodeKey, depth, best, best >= beta ? BOUND_LOWER : (best <= alpha ? BOUND_UPPER : BOUND_EXACT), bestDir);
+    return best;
+}
+
+int Search::replyValue(int selfPos, int oppPos, int depth, int alpha, int beta)
+{
+    bool oppMoved = false;
+    int worst = Config::SEARCH_WIN_SCORE * 2;
+
+    for (Direction dir : kDirections)
+    {
+        int next = oppPos + offset(dir);
+        if (next == selfPos)
+        {
+            oppMoved = true;
+            worst = std::min(worst, 0);
+            continue;
+        }
+        if (board[next] != Config::CELL_EMPTY)
+            continue;
+
+        oppMoved = true;
+        occupy(next, Config::CELL_OPPONENT);
+        int score = alphaBeta(selfPos, next, depth - 1, alpha, std::min(beta, worst));
+        vacate(next);
+
+        worst = std::min(worst, score);
+        if (worst <= alpha)
+            break;
+    }
+
+    if (!oppMoved)
+        return Config::SEARCH_WIN_SCORE + depth;
+
+    return worst;
+}
+
+int Search::evaluate(int selfPos, int oppPos)
+{
+    std::fill(dist.begin(), dist.end(), -1);
+    std::fill(owner.begin(), owner.end(), OWNER_NONE);
+
+    int head = 0, tail = 0;
+    queue[tail++] = selfPos;
+    queue[tail++] = oppPos;
+    dist[selfPos] = 0;
+    dist[oppPos] = 0;
+    owner[selfPos] = OWNER_SELF;
+    owner[oppPos] = OWNER_OPPONENT;
+
+    int score = 0;
+    while (head < tail)
+    {
+        int cell = queue[head++];
+        if (owner[cell] == OWNER_CONTESTED)
+            continue;
+
+        for (Direction dir : kDirections)
+        {
+            int next = cell + offset(dir);
+            if (board[next] != Config::CELL_EMPTY)
+                continue;
+
+            if (dist[next] == -1)
+            {
+                dist[next] = dist[cell] + 1;
+                owner[next] = owner[cell];
+                score += (owner[cell] == OWNER_SELF) ? 1 : -1;
+                queue[tail++] = next;
+            }
+            else if (dist[next] == dist[cell] + 1 && owner[next] != owner[cell] && owner[next] != OWNER_CONTESTED)
+            {
+                score -= (owner[next] == OWNER_SELF) ? 1 : -1;
+                owner[next] = OWNER_CONTESTED;
+            }
+        }
+    }
+
+    return score;
+}
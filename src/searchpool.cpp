@@ -0,0 +1,148 @@
+#include "../include/searchpool.h"
+#include <algorithm>
+#include <cstdlib>
+
+long SearchReport::totalNodes() const
+{
+    long total = 0;
+    for (long count : nodes)
+        total += count;
+    return total;
+}
+
+SearchPool::SearchPool(int threads)
+    : job(0), busy(0), quitting(false), stop(false), grid(nullptr), selfX(0), selfY(0), oppX(0), oppY(0), selfDir(UP),
+      maxNodes(0), maxDepth(0)
+{
+    table.resize(Config::SEARCH_TABLE_ENTRIES);
+    setThreads(threads);
+}
+
+SearchPool::~SearchPool()
+{
+    stopHelpers();
+}
+
+int SearchPool::resolveThreads(int requested)
+{
+    if (requested <= 0)
+        requested = static_cast<int>(std::thread::hardware_concurrency());
+    return std::min(std::max(requested, 1), Config::SEARCH_MAX_THREADS);
+}
+
+void SearchPool::stopHelpers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (std::thread &helper : helpers)
+        helper.join();
+    helpers.clear();
+    quitting = false;
+}
+
+void SearchPool::setThreads(int threads)
+{
+    size_t count = static_cast<size_t>(resolveThreads(threads));
+    if (count == workers.size())
+        return;
+
+    stopHelpers();
+    workers.clear();
+    for (size_t i = 0; i < count; i++)
+        workers.emplace_back(new Worker());
+    for (size_t i = 1; i < count; i++)
+        helpers.emplace_back(&SearchPool::serve, this, static_cast<int>(i), job);
+}
+
+void SearchPool::serve(int index, uint64_t seen)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return quitting || job != seen; });
+            if (quitting)
+                return;
+            seen = job;
+        }
+
+        deepen(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            finished.notify_all();
+    }
+}
+
+void SearchPool::deepen(int index)
+{
+    Worker &worker = *workers[index];
+    worker.depth = 0;
+    worker.move = selfDir;
+    worker.search.setRoot(*grid, selfX, selfY, oppX, oppY);
+    worker.search.setLimits(&table, &stop, maxNodes, deadline, index);
+
+    Direction move;
+    int score;
+    for (int depth = 1 + index % 2; depth <= maxDepth; depth++)
+    {
+        if (!worker.search.searchRoot(depth, worker.move, move, score))
+            break;
+        worker.depth = depth;
+        worker.move = move;
+        // A forced win or loss will not change with more depth.
+        if (std::abs(score) >= Config::SEARCH_WIN_SCORE)
+            break;
+    }
+}
+
+bool SearchPool::bestMove(const Grid &occupied, int fromX, int fromY, Direction fromDir, int opponentX, int opponentY, long nodeLimit,
+                          std::chrono::steady_clock::time_point until, int depthLimit, Direction &move)
+{
+    grid = &occupied;
+    selfX = fromX;
+    selfY = fromY;
+    selfDir = fromDir;
+    oppX = opponentX;
+    oppY = opponentY;
+    maxNodes = nodeLimit;
+    deadline = until;
+    maxDepth = depthLimit;
+    stop.store(false);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = static_cast<int>(helpers.size());
+        job++;
+    }
+    wake.notify_all();
+
+    deepen(0);
+    stop.store(true);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return busy == 0; });
+    }
+
+    // The deepest finished iteration wins; the main thread breaks ties.
+    size_t count = workers.size();
+    report.threads = static_cast<int>(count);
+    report.depths.resize(count);
+    report.nodes.resize(count);
+    report.tableHits.resize(count);
+    size_t chosen = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        report.depths[i] = workers[i]->depth;
+        report.nodes[i] = workers[i]->search.getNodes();
+        report.tableHits[i] = workers[i]->search.getTableHits();
+        if (workers[i]->depth > workers[chosen]->depth)
+            chosen = i;
+    }
+    report.depth = workers[chosen]->depth;
+    move = workers[chosen]->move;
+    return report.depth > 0;
+}
@@ -0,0 +1,464 @@
+#include "../include/snapshot.h"
+#include "../include/checksum.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char SNAPSHOT_MAGIC[8] = {'T', 'R', 'O', 'N', 'S', 'N', 'A', 'P'};
+    const uint32_t SNAPSHOT_VERSION = 1;
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t check;
+        uint64_t size;
+    };
+
+    // Followed by one RiderRecord per rider, the map spawns, the wall bits (when walls
+    // is set), the board one byte per cell and then every rider's trail cells in turn.
+    struct MatchRecord
+    {
+        uint16_t width;
+        uint16_t height;
+        uint8_t mode;
+        uint8_t riders;
+        uint8_t walls;
+        uint8_t reserved;
+        uint32_t tickMicros;
+        int32_t trailLength;
+        int32_t battleSpeed;
+        int32_t score;
+        uint32_t spawns;
+        uint32_t reserved2;
+        int64_t ticks;
+        int64_t elapsedMicros;
+        uint64_t spawner;
+    };
+
+    struct RiderRecord
+    {
+        int16_t x, y;
+        int16_t retiredX, retiredY;
+        uint8_t direction;
+        uint8_t lastDirection;
+        uint8_t alive;
+        uint8_t tailRetired;
+        uint8_t bot;
+        uint8_t difficulty;
+        uint8_t endgame;
+        uint8_t search;
+        uint32_t cells;
+        uint32_t limit;
+        int64_t retired;
+        int64_t maxNodes;
+        int64_t maxMicros;
+        int32_t noise;
+        int32_t weights[BotWeights::COUNT];
+        uint32_t reserved;
+        uint64_t rng;
+    };
+
+    struct SpawnRecord
+    {
+        int16_t x, y;
+        uint8_t dir;
+        uint8_t reserved[3];
+    };
+
+    struct SegmentRecord
+    {
+        int16_t x, y;
+        uint8_t from, to;
+        uint8_t head;
+        uint8_t reserved;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 24, "snapshots have a fixed on-disk header");
+    static_assert(sizeof(MatchRecord) == 56, "snapshots have a fixed on-disk match record");
+    static_assert(sizeof(RiderRecord) == 96, "snapshots have a fixed on-disk rider record");
+    static_assert(sizeof(SegmentRecord) == 8, "trail cells are 8 bytes on disk");
+
+    size_t wallBytes(int width, int height)
+    {
+        return (static_cast<size_t>(width) * height + 7) / 8;
+    }
+
+    template <typename Record>
+    void append(std::vector<uint8_t> &out, const Record &record)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&record);
+        out.insert(out.end(), bytes, bytes + sizeof(record));
+    }
+
+    // Reads records out of the mapped file; a short read fails every later take() too.
+    class Cursor
+    {
+    private:
+        const uint8_t *at;
+        const uint8_t *end;
+
+    public:
+        Cursor(const uint8_t *data, size_t size) : at(data), end(data + size) {}
+
+        bool take(void *out, size_t size)
+        {
+            if (static_cast<size_t>(end - at) < size)
+            {
+                at = end + 1;
+                return false;
+            }
+            memcpy(out, at, size);
+            at += size;
+            return true;
+        }
+
+        const uint8_t *skip(size_t size)
+        {
+            if (at > end || static_cast<size_t>(end - at) < size)
+            {
+                at = end + 1;
+                return nullptr;
+            }
+            const uint8_t *start = at;
+            at += size;
+            return start;
+        }
+
+        bool finished() const { return at == end; }
+    };
+
+    // Bots and the engine index the board without bounds checks, trusting riders to stay
+    // inside the wall ring; the checksum cannot vouch for that in a crafted file.
+    bool interior(const MatchRecord &match, int x, int y)
+    {
+        return x >= 1 && y >= 1 && x <= match.width - 2 && y <= match.height - 2;
+    }
+
+    bool validTrailLength(int cells)
+    {
+        return cells == Config::TRAIL_LENGTH_FULL || cells >= Config::TRAIL_MIN_LENGTH;
+    }
+
+    bool parse(const uint8_t *data, size_t size, MatchSnapshot &snapshot)
+    {
+        Cursor cursor(data, size);
+        MatchRecord match;
+        if (!cursor.take(&match, sizeof(match)) || match.mode > BOT_BATTLE || match.riders < 1 || match.width < 3 || match.height < 3)
+            return false;
+        if ((match.tickMicros != SLOW && match.tickMicros != NORMAL && match.tickMicros != FAST) || !validTrailLength(match.trailLength))
+            return false;
+
+        snapshot.mode = static_cast<GameMode>(match.mode);
+        snapshot.width = match.width;
+        snapshot.height = match.height;
+        snapshot.tickMicros = static_cast<int>(match.tickMicros);
+        snapshot.trailLength = match.trailLength;
+        snapshot.battleSpeed = match.battleSpeed;
+        snapshot.score = match.score;
+        snapshot.ticks = match.ticks;
+        snapshot.elapsedMicros = match.elapsedMicros;
+        snapshot.spawner = match.spawner;
+
+        std::vector<RiderRecord> records(match.riders);
+        snapshot.riders.resize(match.riders);
+        for (int i = 0; i < match.riders; i++)
+        {
+            RiderRecord &record = records[i];
+            if (!cursor.take(&record, sizeof(record)) || (record.limit > 0 && record.cells > record.limit) || record.cells == 0 ||
+                record.difficulty >= Config::NUM_BOT_DIFFICULTIES || !interior(match, record.x, record.y) ||
+                !validTrailLength(static_cast<int>(record.limit)))
+                return false;
+            if (record.retired > 0 ? !interior(match, record.retiredX, record.retiredY) : record.retiredX != -1 || record.retiredY != -1)
+                return false;
+
+            SnapshotRider &rider = snapshot.riders[i];
+            rider.state.x = record.x;
+            rider.state.y = record.y;
+            rider.state.direction = static_cast<Direction>(record.direction & 3);
+            rider.state.lastDirection = static_cast<Direction>(record.lastDirection & 3);
+            rider.state.tailRetired = record.tailRetired != 0;
+            rider.state.limit = record.limit;
+            rider.state.retired = record.retired;
+            rider.state.retiredX = record.retiredX;
+            rider.state.retiredY = record.retiredY;
+            rider.alive = record.alive != 0;
+            rider.bot = record.bot != 0;
+            rider.difficulty = static_cast<BotDifficulty>(record.difficulty);
+            rider.budget = {record.maxNodes, record.maxMicros, record.noise, record.endgame != 0, record.search != 0};
+            for (int w = 0; w < BotWeights::COUNT; w++)
+                rider.weights.set(w, record.weights[w]);
+            rider.noise = record.rng;
+        }
+
+        snapshot.map = ArenaMap();
+        // Skipped rather than allocated up front, so a bogus count fails on the bytes left.
+        const uint8_t *spawns = cursor.skip(static_cast<size_t>(match.spawns) * sizeof(SpawnRecord));
+        if (!spawns)
+            return false;
+        if (match.walls)
+        {
+            const uint8_t *walls = cursor.skip(wallBytes(match.width, match.height));
+            if (!walls)
+                return false;
+            snapshot.map.reset(match.width, match.height);
+            for (int y = 1; y < match.height - 1; y++)
+            {
+                for (int x = 1; x < match.width - 1; x++)
+                {
+                    size_t bit = static_cast<size_t>(y) * match.width + x;
+                    if ((walls[bit >> 3] >> (bit & 7)) & 1)
+                        snapshot.map.setWall(x, y);
+                }
+            }
+            for (uint32_t s = 0; s < match.spawns; s++)
+            {
+                SpawnRecord spawn;
+                memcpy(&spawn, spawns + s * sizeof(SpawnRecord), sizeof(spawn));
+                if (!interior(match, spawn.x, spawn.y))
+                    return false;
+                snapshot.map.addSpawn(spawn.x, spawn.y, static_cast<Direction>(spawn.dir & 3));
+            }
+        }
+
+        const uint8_t *grid = cursor.skip(static_cast<size_t>(match.width) * match.height);
+        if (!grid)
+            return false;
+        snapshot.grid.assign(grid, grid + static_cast<size_t>(match.width) * match.height);
+        for (int y = 0; y < match.height; y++)
+        {
+            for (int x = 0; x < match.width; x++)
+            {
+                if (!interior(match, x, y) && snapshot.grid[static_cast<size_t>(y) * match.width + x] != Config::CELL_WALL)
+                    return false;
+            }
+        }
+
+        for (int i = 0; i < match.riders; i++)
+        {
+            const uint8_t *cells = cursor.skip(static_cast<size_t>(records[i].cells) * sizeof(SegmentRecord));
+            if (!cells)
+                return false;
+            std::vector<TrailSegment> &trail = snapshot.riders[i].trail;
+            trail.clear();
+            trail.reserve(records[i].cells);
+            for (uint32_t c = 0; c < records[i].cells; c++)
+            {
+                SegmentRecord segment;
+                memcpy(&segment, cells + c * sizeof(SegmentRecord), sizeof(segment));
+                if (!interior(match, segment.x, segment.y))
+                    return false;
+                trail.emplace_back(segment.x, segment.y, static_cast<Direction>(segment.from & 3), static_cast<Direction>(segment.to & 3),
+                                   segment.head != 0);
+            }
+            // The head is the newest trail cell.
+            if (trail.back().x != records[i].x || trail.back().y != records[i].y)
+                return false;
+        }
+        return cursor.finished();
+    }
+}
+
+void captureController(const HumanController &, SnapshotRider &rider)
+{
+    rider.bot = false;
+}
+
+void captureController(const BotController &controller, SnapshotRider &rider)
+{
+    const Bot &bot = *controller.getBot();
+    rider.bot = true;
+    rider.difficulty = bot.getDifficulty();
+    rider.budget = bot.getBudget();
+    rider.weights = bot.getWeights();
+    rider.noise = bot.getNoiseState();
+}
+
+void restoreController(HumanController &, const SnapshotRider &)
+{
+}
+
+void restoreController(BotController &controller, const SnapshotRider &rider)
+{
+    Bot &bot = *controller.getBot();
+    bot.setDifficulty(rider.difficulty);
+    bot.setBudget(rider.budget);
+    bot.setWeights(rider.weights);
+    bot.seedNoise(rider.noise);
+}
+
+bool MatchSnapshot::save(const std::string &path, std::string &error) const
+{
+    MatchRecord match;
+    memset(&match, 0, sizeof(match));
+    match.width = static_cast<uint16_t>(width);
+    match.height = static_cast<uint16_t>(height);
+    match.mode = static_cast<uint8_t>(mode);
+    match.riders = static_cast<uint8_t>(riders.size());
+    match.walls = !map.empty();
+    match.tickMicros = static_cast<uint32_t>(tickMicros);
+    match.trailLength = trailLength;
+    match.battleSpeed = battleSpeed;
+    match.score = score;
+    match.spawns = map.empty() ? 0 : static_cast<uint32_t>(map.getSpawns().size());
+    match.ticks = ticks;
+    match.elapsedMicros = elapsedMicros;
+    match.spawner = spawner;
+
+    std::vector<uint8_t> body;
+    size_t cells = 0;
+    for (const SnapshotRider &rider : riders)
+        cells += rider.trail.size();
+    body.reserve(sizeof(match) + riders.size() * sizeof(RiderRecord) + wallBytes(width, height) + grid.size() + cells * sizeof(SegmentRecord));
+    append(body, match);
+
+    for (const SnapshotRider &rider : riders)
+    {
+        RiderRecord record;
+        memset(&record, 0, sizeof(record));
+        record.x = static_cast<int16_t>(rider.state.x);
+        record.y = static_cast<int16_t>(rider.state.y);
+        record.retiredX = static_cast<int16_t>(rider.state.retiredX);
+        record.retiredY = static_cast<int16_t>(rider.state.retiredY);
+        record.direction = static_cast<uint8_t>(rider.state.direction);
+        record.lastDirection = static_cast<uint8_t>(rider.state.lastDirection);
+        record.alive = rider.alive;
+        record.tailRetired = rider.state.tailRetired;
+        record.bot = rider.bot;
+        record.difficulty = static_cast<uint8_t>(rider.difficulty);
+        record.endgame = rider.budget.endgame;
+        record.search = rider.budget.search;
+        record.cells = static_cast<uint32_t>(rider.trail.size());
+        record.limit = static_cast<uint32_t>(rider.state.limit);
+        record.retired = rider.state.retired;
+        record.maxNodes = rider.budget.maxNodes;
+        record.maxMicros = rider.budget.maxMicros;
+        record.noise = rider.budget.noise;
+        for (int w = 0; w < BotWeights::COUNT; w++)
+            record.weights[w] = rider.weights.get(w);
+        record.rng = rider.noise;
+        append(body, record);
+    }
+
+    if (!map.empty())
+    {
+        for (const MapSpawn &spawn : map.getSpawns())
+        {
+            SpawnRecord record;
+            memset(&record, 0, sizeof(record));
+            record.x = static_cast<int16_t>(spawn.x);
+            record.y = static_cast<int16_t>(spawn.y);
+            record.dir = static_cast<uint8_t>(spawn.dir);
+            append(body, record);
+        }
+        size_t at = body.size();
+        body.resize(at + wallBytes(width, height), 0);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                size_t bit = static_cast<size_t>(y) * width + x;
+                if (map.isWall(x, y))
+                    body[at + (bit >> 3)] |= static_cast<uint8_t>(1 << (bit & 7));
+            }
+        }
+    }
+
+    body.insert(body.end(), grid.begin(), grid.end());
+    for (const SnapshotRider &rider : riders)
+    {
+        for (const TrailSegment &segment : rider.trail)
+        {
+            SegmentRecord record = {static_cast<int16_t>(segment.x), static_cast<int16_t>(segment.y), static_cast<uint8_t>(segment.from),
+                                    static_cast<uint8_t>(segment.to), static_cast<uint8_t>(segment.isHead), 0};
+            append(body, record);
+        }
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.size = body.size();
+    header.check = hashBytes(body.data(), body.size());
+
+    std::string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        error = "cannot write " + temporary + ": " + strerror(errno);
+        return false;
+    }
+    bool written = write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+    size_t done = 0;
+    while (written && done < body.size())
+    {
+        ssize_t wrote = write(fd, body.data() + done, body.size() - done);
+        written = wrote > 0;
+        done += written ? static_cast<size_t>(wrote) : 0;
+    }
+    written = fsync(fd) == 0 && written;
+    written = close(fd) == 0 && written;
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        error = "cannot write " + path + ": " + strerror(errno);
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MatchSnapshot::load(const std::string &path, std::string &error)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotHeader)))
+    {
+        close(fd);
+        error = path + " is not a snapshot";
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        error = "cannot map " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    const uint8_t *data = static_cast<const uint8_t *>(mapped);
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    const uint8_t *body = data + sizeof(header);
+    bool ok = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 && header.version == SNAPSHOT_VERSION &&
+              header.size == size - sizeof(header) && hashBytes(body, header.size) == header.check &&
+              parse(body, header.size, *this);
+    munmap(mapped, size);
+    if (!ok)
+        error = path + " is not a snapshot or is damaged";
+    return ok;
+}
+
+std::string MatchSnapshot::defaultPath()
+{
+    const char *path = getenv(Config::SNAPSHOT_ENV);
+    if (path && *path)
+        return path;
+    const char *home = getenv("HOME");
+    if (home && *home)
+        return std::string(home) + "/" + Config::SNAPSHOT_FILE;
+    return Config::SNAPSHOT_FILE;
+}
@@ -0,0 +1,388 @@
+#include "../include/stats.h"
+#include "../include/checksum.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char STATS_MAGIC[8] = {'T', 'R', 'O', 'N', 'S', 'T', 'A', 'T'};
+    const uint32_t STATS_VERSION = 1;
+    const int READ_BATCH = 256;
+
+    // Matches count toward the totals and the recent list; compaction replaces them with
+    // one totals record per mode and bot level plus copies of the recent matches.
+    const uint8_t RECORD_MATCH = 1;
+    const uint8_t RECORD_TOTALS = 2;
+    const uint8_t RECORD_RECENT = 3;
+
+    struct StatsHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    struct StatsRecord
+    {
+        uint8_t type;
+        uint8_t mode;
+        uint8_t difficulty;
+        uint8_t winner;
+        uint32_t seconds;
+        int64_t time;
+        uint32_t matches;
+        uint32_t wins;
+        uint32_t losses;
+        uint32_t ties;
+        uint32_t reserved;
+        uint32_t check;
+    };
+
+    static_assert(sizeof(StatsRecord) == 40, "stats records have a fixed on-disk size");
+
+    uint32_t checksum(const StatsRecord &record)
+    {
+        // Everything before the checksum itself.
+        return hashBytes(&record, offsetof(StatsRecord, check));
+    }
+
+    bool isValid(const StatsRecord &record)
+    {
+        return record.check == checksum(record) && record.type >= RECORD_MATCH && record.type <= RECORD_RECENT &&
+               record.mode < Config::NUM_GAME_MODES && record.difficulty < Config::NUM_BOT_DIFFICULTIES;
+    }
+
+    StatsRecord makeRecord(uint8_t type, int mode, int difficulty, int winner, int seconds, int64_t when)
+    {
+        StatsRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = type;
+        record.mode = static_cast<uint8_t>(mode);
+        record.difficulty = static_cast<uint8_t>(difficulty);
+        record.winner = static_cast<uint8_t>(winner);
+        record.seconds = static_cast<uint32_t>(std::max(0, seconds));
+        record.time = when;
+        return record;
+    }
+
+    void addTo(ModeTotals &totals, const StatsRecord &record)
+    {
+        totals.matches += record.matches;
+        totals.wins += record.wins;
+        totals.losses += record.losses;
+        totals.ties += record.ties;
+        totals.bestSeconds = std::max(totals.bestSeconds, static_cast<int>(record.seconds));
+    }
+
+    void fold(StatsIndex &index, const StatsRecord &record)
+    {
+        if (record.type != RECORD_RECENT)
+        {
+            addTo(index.modes[record.mode], record);
+            if (record.mode == VS_BOT)
+                addTo(index.bots[record.difficulty], record);
+        }
+        if (record.type != RECORD_TOTALS)
+        {
+            index.recent.push_back({record.time, static_cast<GameMode>(record.mode), static_cast<BotDifficulty>(record.difficulty),
+                                    record.winner, static_cast<int>(record.seconds)});
+            if (index.recent.size() > static_cast<size_t>(Config::STATS_RECENT_MATCHES))
+                index.recent.erase(index.recent.begin());
+        }
+    }
+
+    bool hasHeader(int fd)
+    {
+        StatsHeader header;
+        return pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+               memcmp(header.magic, STATS_MAGIC, sizeof(STATS_MAGIC)) == 0 && header.version == STATS_VERSION;
+    }
+
+    bool writeHeader(int fd)
+    {
+        StatsHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, STATS_MAGIC, sizeof(STATS_MAGIC));
+        header.version = STATS_VERSION;
+        return write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+    }
+
+    // Folds whole records from offset on and returns the offset after the last good one.
+    off_t readRecords(int fd, off_t offset, StatsIndex &index)
+    {
+        StatsRecord batch[READ_BATCH];
+        while (true)
+        {
+            ssize_t got = pread(fd, batch, sizeof(batch), offset);
+            if (got <= 0)
+                return offset;
+            int count = static_cast<int>(got / static_cast<ssize_t>(sizeof(StatsRecord)));
+            for (int i = 0; i < count; i++)
+            {
+                if (!isValid(batch[i]))
+                    return offset;
+                fold(index, batch[i]);
+                offset += sizeof(StatsRecord);
+            }
+            if (count < READ_BATCH)
+                return offset;
+        }
+    }
+
+    // Appends the whole records from offset on to out, stopping at the first bad one.
+    bool copyRecords(int fd, off_t offset, int out)
+    {
+        StatsRecord batch[READ_BATCH];
+        while (true)
+        {
+            ssize_t got = pread(fd, batch, sizeof(batch), offset);
+            if (got <= 0)
+                return got == 0;
+            int count = static_cast<int>(got / static_cast<ssize_t>(sizeof(StatsRecord)));
+            int good = 0;
+            while (good < count && isValid(batch[good]))
+                good++;
+            ssize_t bytes = static_cast<ssize_t>(good * sizeof(StatsRecord));
+            if (bytes > 0 && write(out, batch, bytes) != bytes)
+                return false;
+            if (good < READ_BATCH)
+                return true;
+            offset += bytes;
+        }
+    }
+
+    // Opens and exclusively locks the log, retrying if compaction swapped the file meanwhile.
+    int openLocked(const std::string &path, int flags)
+    {
+        while (true)
+        {
+            int fd = open(path.c_str(), flags, 0644);
+            if (fd < 0)
+                return -1;
+            struct stat held, current;
+            if (flock(fd, LOCK_EX) != 0 || fstat(fd, &held) != 0)
+            {
+                close(fd);
+                return -1;
+            }
+            if (stat(path.c_str(), &current) == 0 && current.st_ino == held.st_ino && current.st_dev == held.st_dev)
+                return fd;
+            close(fd);
+        }
+    }
+
+    std::string defaultPath()
+    {
+        const char *path = getenv(Config::STATS_ENV);
+        if (path && *path)
+            return path;
+        const char *home = getenv("HOME");
+        if (home && *home)
+            return std::string(home) + "/" + Config::STATS_FILE;
+        return Config::STATS_FILE;
+    }
+}
+
+StatsStore::StatsStore() : path(defaultPath()), indexed(false), indexedInode(0), indexedSize(0), compacting(false), autoCompact(true) {}
+
+StatsStore::~StatsStore()
+{
+    if (compactor.joinable())
+        compactor.join();
+}
+
+StatsStore &StatsStore::instance()
+{
+    static StatsStore store;
+    return store;
+}
+
+void StatsStore::setPath(const std::string &newPath)
+{
+    if (compactor.joinable())
+        compactor.join();
+    std::lock_guard<std::mutex> lock(mutex);
+    path = newPath;
+    resetIndex();
+}
+
+void StatsStore::setAutoCompact(bool enabled)
+{
+    if (!enabled && compactor.joinable())
+        compactor.join();
+    autoCompact = enabled;
+}
+
+void StatsStore::resetIndex()
+{
+    index = StatsIndex();
+    indexed = false;
+    indexedInode = 0;
+    indexedSize = 0;
+}
+
+bool StatsStore::record(GameMode mode, BotDifficulty difficulty, int winner, int seconds)
+{
+    StatsRecord record = makeRecord(RECORD_MATCH, mode, mode == VS_BOT ? difficulty : 0, winner, seconds, static_cast<int64_t>(time(nullptr)));
+    record.matches = 1;
+    record.wins = winner == Config::WINNER_PLAYER1;
+    record.losses = winner == Config::WINNER_PLAYER2;
+    record.ties = winner == Config::WINNER_TIE;
+    record.check = checksum(record);
+
+    bool written = false;
+    long records = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int fd = openLocked(path, O_RDWR | O_CREAT | O_APPEND);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0)
+        {
+            off_t size = st.st_size;
+            bool ready = size == 0 ? writeHeader(fd) : hasHeader(fd);
+            if (ready && size > 0)
+            {
+                // Drop the tail of an append that was cut off, so later records stay readable.
+                off_t whole = static_cast<off_t>(sizeof(StatsHeader)) +
+                              (size - static_cast<off_t>(sizeof(StatsHeader))) / sizeof(StatsRecord) * sizeof(StatsRecord);
+                if (whole != size)
+                    ready = ftruncate(fd, whole) == 0;
+            }
+            written = ready && write(fd, &record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+            if (written && fstat(fd, &st) == 0)
+                records = static_cast<long>((st.st_size - static_cast<off_t>(sizeof(StatsHeader))) / sizeof(StatsRecord));
+        }
+        close(fd);
+    }
+
+    if (written && autoCompact && records > Config::STATS_COMPACT_RECORDS)
+        compactInBackground();
+    return written;
+}
+
+StatsIndex StatsStore::snapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        resetIndex();
+        return index;
+    }
+
+    struct stat st;
+    bool readable = fstat(fd, &st) == 0;
+    if (readable && (!indexed || st.st_ino != indexedInode || st.st_size < indexedSize))
+    {
+        resetIndex();
+        readable = hasHeader(fd);
+        indexed = readable;
+        indexedInode = st.st_ino;
+        indexedSize = sizeof(StatsHeader);
+    }
+    if (readable)
+        indexedSize = readRecords(fd, indexedSize, index);
+
+    close(fd);
+    return index;
+}
+
+bool StatsStore::compact()
+{
+    // The flock keeps other writers off the file; the mutex is only needed for the path
+    // and the index, so record() and snapshot() never wait on the rewrite.
+    std::string source;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source = path;
+    }
+    int fd = openLocked(source, O_RDONLY);
+    if (fd < 0)
+        return false;
+    if (!hasHeader(fd))
+    {
+        close(fd);
+        return false;
+    }
+
+    StatsIndex folded;
+    off_t end = readRecords(fd, sizeof(StatsHeader), folded);
+    flock(fd, LOCK_UN);
+
+    std::string temporary = source + ".tmp";
+    int out = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool written = out >= 0 && writeHeader(out);
+
+    int64_t now = static_cast<int64_t>(time(nullptr));
+    auto writeTotals = [&](int mode, int difficulty, const ModeTotals &totals)
+    {
+        if (!written || totals.matches == 0)
+            return;
+        StatsRecord record = makeRecord(RECORD_TOTALS, mode, difficulty, Config::WINNER_TIE, totals.bestSeconds, now);
+        record.matches = static_cast<uint32_t>(totals.matches);
+        record.wins = static_cast<uint32_t>(totals.wins);
+        record.losses = static_cast<uint32_t>(totals.losses);
+        record.ties = static_cast<uint32_t>(totals.ties);
+        record.check = checksum(record);
+        written = write(out, &record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+    };
+
+    for (int mode = 0; mode < Config::NUM_GAME_MODES; mode++)
+    {
+        if (mode != VS_BOT)
+            writeTotals(mode, 0, folded.modes[mode]);
+    }
+    for (int level = 0; level < Config::NUM_BOT_DIFFICULTIES; level++)
+        writeTotals(VS_BOT, level, folded.bots[level]);
+
+    for (const MatchSummary &match : folded.recent)
+    {
+        if (!written)
+            break;
+        StatsRecord record = makeRecord(RECORD_RECENT, match.mode, match.difficulty, match.winner, match.seconds, match.time);
+        record.check = checksum(record);
+        written = write(out, &record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+    }
+    written = written && fsync(out) == 0;
+
+    // Matches appended while the rewrite was built are carried over as they are; the
+    // lock is held again only for them and the swap. Another process may have swapped
+    // the file in the meantime, and then its compaction stands.
+    struct stat held, current;
+    written = written && flock(fd, LOCK_EX) == 0 && fstat(fd, &held) == 0 && stat(source.c_str(), &current) == 0 &&
+              current.st_ino == held.st_ino && current.st_dev == held.st_dev;
+    written = written && copyRecords(fd, end, out) && fsync(out) == 0;
+    if (out >= 0)
+        close(out);
+    written = written && rename(temporary.c_str(), source.c_str()) == 0;
+    if (!written)
+        unlink(temporary.c_str());
+    close(fd);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    resetIndex();
+    return written;
+}
+
+void StatsStore::compactInBackground()
+{
+    bool idle = false;
+    if (!compacting.compare_exchange_strong(idle, true))
+        return;
+    if (compactor.joinable())
+        compactor.join();
+    compactor = std::thread([this]()
+                            {
+                                compact();
+                                compacting = false; });
+}
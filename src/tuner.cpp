@@ -0,0 +1,378 @@
+#include "../include/tuner.h"
+#include "../include/bot.h"
+#include "../include/book.h"
+#include "../include/game.h"
+#include "../include/engine.h"
+#include "../include/rng.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const long TUNER_MICROS_PER_TICK = 3600L * 1000 * 1000;
+    const double SPSA_ALPHA = 0.602;
+    const double SPSA_GAMMA = 0.101;
+
+    struct TunerState
+    {
+        long iteration = 0;
+        long gamesPlayed = 0;
+        uint64_t rngState = 0;
+        double theta[BotWeights::COUNT];
+    };
+
+    bool loadConfig(const std::string &path, TunerSettings &settings, BotWeights &weights)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            fprintf(stderr, "Cannot open tuning config %s\n", path.c_str());
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = BotWeights::trimField(line.substr(0, line.find('#')));
+            size_t eq = line.find('=');
+            if (eq == std::string::npos)
+                continue;
+
+            std::string key = BotWeights::trimField(line.substr(0, eq));
+            std::string value = BotWeights::trimField(line.substr(eq + 1));
+
+            if (weights.parse(key, value))
+                continue;
+            else if (key == "width")
+                settings.width = atoi(value.c_str());
+            else if (key == "height")
+                settings.height = atoi(value.c_str());
+            else if (key == "games")
+                settings.games = atol(value.c_str());
+            else if (key == "games_per_iteration")
+                settings.gamesPerIteration = std::max(2, atoi(value.c_str()));
+            else if (key == "games_per_batch")
+                settings.gamesPerBatch = std::max(1, atoi(value.c_str()));
+            else if (key == "threads")
+                settings.threads = atoi(value.c_str());
+            else if (key == "nodes")
+                settings.nodes = atol(value.c_str());
+            else if (key == "step_size")
+                settings.stepSize = atof(value.c_str());
+            else if (key == "perturbation")
+                settings.perturbation = atof(value.c_str());
+            else if (key == "seed")
+                settings.seed = strtoull(value.c_str(), nullptr, 10);
+            else if (key == "checkpoint_every")
+                settings.checkpointEvery = std::max(1, atoi(value.c_str()));
+            else if (key == "checkpoint")
+                settings.checkpointPath = value;
+            else if (key == "output")
+                settings.outputPath = value;
+            else
+                fprintf(stderr, "Ignoring unknown tuning key: %s\n", key.c_str());
+        }
+
+        if (settings.width <= 2 * Config::SPAWN_MARGIN || settings.height <= 2 * Config::SPAWN_MARGIN)
+        {
+            fprintf(stderr, "Arena %dx%d is too small for spawning\n", settings.width, settings.height);
+            return false;
+        }
+        return true;
+    }
+
+    bool loadCheckpoint(const std::string &path, TunerState &state)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t eq = line.find('=');
+            if (eq == std::string::npos)
+                continue;
+
+            std::string key = BotWeights::trimField(line.substr(0, eq));
+            std::string value = BotWeights::trimField(line.substr(eq + 1));
+            if (key == "iteration")
+                state.iteration = atol(value.c_str());
+            else if (key == "games")
+                state.gamesPlayed = atol(value.c_str());
+            else if (key == "rng")
+                state.rngState = strtoull(value.c_str(), nullptr, 10);
+            else
+            {
+                for (int i = 0; i < BotWeights::COUNT; i++)
+                {
+                    if (key == BotWeights::name(i))
+                        state.theta[i] = atof(value.c_str());
+                }
+            }
+        }
+        return true;
+    }
+
+    bool saveCheckpoint(const std::string &path, const TunerState &state)
+    {
+        std::string temp = path + ".tmp";
+        FILE *file = fopen(temp.c_str(), "w");
+        if (!file)
+            return false;
+
+        fprintf(file, "iteration = %ld\n", state.iteration);
+        fprintf(file, "games = %ld\n", state.gamesPlayed);
+        fprintf(file, "rng = %llu\n", static_cast<unsigned long long>(state.rngState));
+        for (int i = 0; i < BotWeights::COUNT; i++)
+            fprintf(file, "%s = %.6f\n", BotWeights::name(i), state.theta[i]);
+
+        if (fclose(file) != 0)
+            return false;
+        return rename(temp.c_str(), path.c_str()) == 0;
+    }
+
+    BotWeights roundWeights(const double *values)
+    {
+        BotWeights weights;
+        for (int i = 0; i < BotWeights::COUNT; i++)
+            weights.set(i, std::max(0, static_cast<int>(std::lround(values[i]))));
+        return weights;
+    }
+
+    uint64_t gameSeed(uint64_t seed, long iteration, int game)
+    {
+        Rng mixer(seed ^ (static_cast<uint64_t>(iteration) << 20) ^ static_cast<uint64_t>(game));
+        return mixer.next();
+    }
+}
+
+SelfPlayTable::SelfPlayTable(const TunerSettings &tunerSettings) : settings(tunerSettings), arena(0, 2)
+{
+    arena.reserve(settings.width, settings.height);
+    Bot &bot1 = *arena.acquireBot(0, 0, RIGHT);
+    Bot &bot2 = *arena.acquireBot(0, 0, LEFT);
+    engine.reset(new TickEngine<BotController, BotController>(settings.width, settings.height,
+                                                               BotController(bot1, *bot2.getPlayer(), settings.width, settings.height),
+                                                               BotController(bot2, *bot1.getPlayer(), settings.width, settings.height)));
+}
+
+int SelfPlayTable::play(const BotWeights &first, const BotWeights &second, uint64_t seed)
+{
+    Rng rng(seed);
+    int width = settings.width;
+    int height = settings.height;
+
+    int side1 = rng.range(0, Config::NUM_SIDES - 1);
+    int side2 = (side1 + 2) % Config::NUM_SIDES;
+    auto pos1 = Game::getPositionOnSide(side1, rng.range(0, Game::getSideSpan(side1, width, height) - 1), width, height);
+    auto pos2 = Game::getPositionOnSide(side2, rng.range(0, Game::getSideSpan(side2, width, height) - 1), width, height);
+
+    // Same slots every game: the engine stays bound to them.
+    arena.reset();
+    Bot &bot1 = *arena.acquireBot(pos1.first, pos1.second, Game::getSafeDirection(side1));
+    Bot &bot2 = *arena.acquireBot(pos2.first, pos2.second, Game::getSafeDirection(side2));
+
+    // The deep search does not read the weights being tuned, however large the budget.
+    BotBudget budget = {settings.nodes, TUNER_MICROS_PER_TICK, 0};
+    budget.search = false;
+    bot1.setBudget(budget);
+    bot2.setBudget(budget);
+    bot1.setWeights(first);
+    bot2.setWeights(second);
+    engine->reset();
+
+    for (int tick = 0; tick < width * height; tick++)
+    {
+        TickResult result = engine->tick();
+        if (!result.finished)
+            continue;
+        if (result.winner == Config::WINNER_PLAYER1)
+            return 1;
+        if (result.winner == Config::WINNER_PLAYER2)
+            return -1;
+        return 0;
+    }
+    return 0;
+}
+
+SelfPlayPool::SelfPlayPool(const TunerSettings &tunerSettings, int threads)
+    : settings(tunerSettings), job(0), busy(0), quitting(false), plus(nullptr), minus(nullptr), iteration(0), nextGame(0), score(0)
+{
+    for (int i = 0; i < threads; i++)
+        tables.emplace_back(new SelfPlayTable(settings));
+    for (int i = 1; i < threads; i++)
+        helpers.emplace_back(&SelfPlayPool::serve, this, i, job);
+}
+
+SelfPlayPool::~SelfPlayPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (std::thread &helper : helpers)
+        helper.join();
+}
+
+void SelfPlayPool::serve(int index, uint64_t seen)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return quitting || job != seen; });
+            if (quitting)
+                return;
+            seen = job;
+        }
+
+        playShare(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            finished.notify_all();
+    }
+}
+
+void SelfPlayPool::playShare(int index)
+{
+    SelfPlayTable &table = *tables[index];
+    int local = 0;
+    while (true)
+    {
+        int begin = nextGame.fetch_add(settings.gamesPerBatch);
+        if (begin >= settings.gamesPerIteration)
+            break;
+
+        int end = std::min(begin + settings.gamesPerBatch, settings.gamesPerIteration);
+        for (int game = begin; game < end; game++)
+        {
+            uint64_t seed = gameSeed(settings.seed, iteration, game / 2);
+            if (game % 2 == 0)
+                local += table.play(*plus, *minus, seed);
+            else
+                local -= table.play(*minus, *plus, seed);
+        }
+    }
+    score += local;
+}
+
+int SelfPlayPool::playIteration(const BotWeights &plusWeights, const BotWeights &minusWeights, long iterationIndex)
+{
+    plus = &plusWeights;
+    minus = &minusWeights;
+    iteration = iterationIndex;
+    nextGame.store(0);
+    score.store(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = static_cast<int>(helpers.size());
+        job++;
+    }
+    wake.notify_all();
+
+    playShare(0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return busy == 0; });
+    }
+    return score.load();
+}
+
+int runTuner(const std::string &configPath)
+{
+    TunerSettings settings;
+    BotWeights initial;
+    if (!loadConfig(configPath, settings, initial))
+        return 1;
+
+    int threadCount = settings.threads > 0 ? settings.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+    // Workers share the opening book; map it here rather than racing to on the first move.
+    OpeningBook::instance().isAvailable();
+
+    double scale[BotWeights::COUNT];
+    TunerState state;
+    for (int i = 0; i < BotWeights::COUNT; i++)
+    {
+        state.theta[i] = initial.get(i);
+        scale[i] = std::max(1.0, std::fabs(state.theta[i]));
+    }
+    state.rngState = settings.seed;
+
+    if (loadCheckpoint(settings.checkpointPath, state))
+    {
+        printf("Resuming from %s at iteration %ld (%ld games)\n", settings.checkpointPath.c_str(), state.iteration, state.gamesPlayed);
+    }
+
+    long totalIterations = (settings.games + settings.gamesPerIteration - 1) / settings.gamesPerIteration;
+    double stability = 0.1 * totalIterations;
+    Rng rng(state.rngState);
+
+    printf("Tuning on %dx%d with %d threads, %d games per iteration\n", settings.width, settings.height, threadCount, settings.gamesPerIteration);
+    SelfPlayPool pool(settings, threadCount);
+    auto start = std::chrono::steady_clock::now();
+    long gamesAtStart = state.gamesPlayed;
+
+    while (state.gamesPlayed < settings.games)
+    {
+        double k = static_cast<double>(state.iteration);
+        double ak = settings.stepSize / std::pow(k + 1 + stability, SPSA_ALPHA);
+        double ck = settings.perturbation / std::pow(k + 1, SPSA_GAMMA);
+
+        double plusValues[BotWeights::COUNT], minusValues[BotWeights::COUNT];
+        int delta[BotWeights::COUNT] = {};
+        std::copy(state.theta, state.theta + BotWeights::COUNT, plusValues);
+        std::copy(state.theta, state.theta + BotWeights::COUNT, minusValues);
+        for (int i = 0; i < BotWeights::TUNED_COUNT; i++)
+        {
+            delta[i] = (rng.next() & 1) ? 1 : -1;
+            plusValues[i] = state.theta[i] + ck * scale[i] * delta[i];
+            minusValues[i] = state.theta[i] - ck * scale[i] * delta[i];
+        }
+
+        int score = pool.playIteration(roundWeights(plusValues), roundWeights(minusValues), state.iteration);
+        double result = static_cast<double>(score) / settings.gamesPerIteration;
+
+        for (int i = 0; i < BotWeights::TUNED_COUNT; i++)
+            state.theta[i] = std::max(0.0, state.theta[i] + ak * scale[i] * result * delta[i]);
+
+        state.iteration++;
+        state.gamesPlayed += settings.gamesPerIteration;
+        state.rngState = rng.getState();
+
+        bool last = state.gamesPlayed >= settings.games;
+        if (state.iteration % settings.checkpointEvery == 0 || last)
+        {
+            if (!saveCheckpoint(settings.checkpointPath, state))
+                fprintf(stderr, "Failed to write checkpoint %s\n", settings.checkpointPath.c_str());
+
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("iter %ld  games %ld  %.0f games/s ", state.iteration, state.gamesPlayed,
+                   (state.gamesPlayed - gamesAtStart) / std::max(elapsed, 1e-9));
+            for (int i = 0; i < BotWeights::TUNED_COUNT; i++)
+                printf(" %s=%.1f", BotWeights::name(i), state.theta[i]);
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    BotWeights tuned = roundWeights(state.theta);
+    if (!tuned.save(settings.outputPath))
+    {
+        fprintf(stderr, "Failed to write %s\n", settings.outputPath.c_str());
+        return 1;
+    }
+    printf("Wrote tuned weights to %s\n", settings.outputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "../include/weights.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace
+{
+    const char *const WEIGHT_NAMES[BotWeights::COUNT] = {
+        "space",
+        "wall_distance",
+        "keep_straight",
+        "keep_near",
+        "look_ahead",
+        "exits",
+        "opponent_distance",
+        "network"};
+}
+
+std::string BotWeights::trimField(const std::string &text)
+{
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+const char *BotWeights::name(int index)
+{
+    return (index >= 0 && index < COUNT) ? WEIGHT_NAMES[index] : "";
+}
+
+int BotWeights::get(int index) const
+{
+    switch (index)
+    {
+    case 0:
+        return space;
+    case 1:
+        return wallDistance;
+    case 2:
+        return keepStraight;
+    case 3:
+        return keepNear;
+    case 4:
+        return lookAhead;
+    case 5:
+        return exits;
+    case 6:
+        return opponentDistance;
+    case 7:
+        return network;
+    }
+    return 0;
+}
+
+void BotWeights::set(int index, int value)
+{
+    switch (index)
+    {
+    case 0:
+        space = value;
+        break;
+    case 1:
+        wallDistance = value;
+        break;
+    case 2:
+        keepStraight = value;
+        break;
+    case 3:
+        keepNear = value;
+        break;
+    case 4:
+        lookAhead = value;
+        break;
+    case 5:
+        exits = value;
+        break;
+    case 6:
+        opponentDistance = value;
+        break;
+    case 7:
+        network = value;
+        break;
+    }
+}
+
+bool BotWeights::parse(const std::string &key, const std::string &value)
+{
+    for (int i = 0; i < COUNT; i++)
+    {
+        if (key == WEIGHT_NAMES[i])
+        {
+            set(i, atoi(value.c_str()));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BotWeights::load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trimField(line.substr(0, line.find('#')));
+        size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            continue;
+        parse(trimField(line.substr(0, eq)), trimField(line.substr(eq + 1)));
+    }
+    return true;
+}
+
+bool BotWeights::save(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    for (int i = 0; i < COUNT; i++)
+        fprintf(file, "%s = %d\n", WEIGHT_NAMES[i], get(i));
+    return fclose(file) == 0;
+}